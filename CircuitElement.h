@@ -1,145 +1,201 @@
-﻿#ifndef CircuitElementH
-#define CircuitElementH
-
-#include "TernaryTypes.h"
-#include <Vcl.Graphics.hpp>
-#include <System.Types.hpp>
-#include <vector>
-#include <System.Classes.hpp>
-#include <System.IniFiles.hpp>
-
-class TCircuitElement {
-protected:
-    int FId;
-    String FName;
-    TRect FBounds;
-    std::vector<TConnectionPoint> FInputs;
-    std::vector<TConnectionPoint> FOutputs;
-    TTernary FCurrentState;
-
-    void DrawMagneticAmplifier(TCanvas* Canvas, bool IsPowerful);
-    void DrawTernaryElement(TCanvas* Canvas);
-    void DrawControlLine(TCanvas* Canvas, const TConnectionPoint& Point);
-    void DrawCrossingLine(TCanvas* Canvas, int X1, int Y1, int X2, int Y2);
-	void DrawConnectionPoints(TCanvas* Canvas);
-
-public:
-    TCircuitElement(int AId, const String& AName, int X, int Y);
-    virtual ~TCircuitElement() {}
-
-    virtual void Calculate() { /* Базовая реализация - ничего не делает */ }
-    virtual void Draw(TCanvas* Canvas);
-    virtual TConnectionPoint* GetConnectionAt(int X, int Y);
-
-void SetBounds(const TRect& NewBounds) {
-    FBounds = NewBounds;
-
-    // Обновляем абсолютные координаты на основе относительных с привязкой к сетке
-    int gridSize = 20;
-
-    for (auto& input : FInputs) {
-        input.X = NewBounds.Left + (int)(input.RelX * NewBounds.Width());
-        input.Y = NewBounds.Top + (int)(input.RelY * NewBounds.Height());
-        // Привязываем к сетке
-        input.X = ((input.X + gridSize/2) / gridSize) * gridSize;
-        input.Y = ((input.Y + gridSize/2) / gridSize) * gridSize;
-    }
-    for (auto& output : FOutputs) {
-        output.X = NewBounds.Left + (int)(output.RelX * NewBounds.Width());
-        output.Y = NewBounds.Top + (int)(output.RelY * NewBounds.Height());
-        // Привязываем к сетке
-        output.X = ((output.X + gridSize/2) / gridSize) * gridSize;
-        output.Y = ((output.Y + gridSize/2) / gridSize) * gridSize;
-	}
-	}
-
-
-	void CalculateRelativePositions() {
-		int gridSize = 20; // Размер сетки
-
-		for (auto& input : FInputs) {
-			// Привязываем абсолютные координаты к сетке
-			input.X = ((input.X + gridSize/2) / gridSize) * gridSize;
-			input.Y = ((input.Y + gridSize/2) / gridSize) * gridSize;
-
-			if (FBounds.Width() > 0 && FBounds.Height() > 0) {
-				input.RelX = (double)(input.X - FBounds.Left) / FBounds.Width();
-				input.RelY = (double)(input.Y - FBounds.Top) / FBounds.Height();
-			} else {
-				input.RelX = 0.0;
-				input.RelY = 0.5;
-			}
-		}
-
-		for (auto& output : FOutputs) {
-			// Привязываем абсолютные координаты к сетке
-			output.X = ((output.X + gridSize/2) / gridSize) * gridSize;
-			output.Y = ((output.Y + gridSize/2) / gridSize) * gridSize;
-
-			if (FBounds.Width() > 0 && FBounds.Height() > 0) {
-				output.RelX = (double)(output.X - FBounds.Left) / FBounds.Width();
-				output.RelY = (double)(output.Y - FBounds.Top) / FBounds.Height();
-			} else {
-				output.RelX = 1.0;
-				output.RelY = 0.5;
-			}
-		}
-	}
-
-    void SetId(int AId) { FId = AId; }
-    void SetName(const String& AName) { FName = AName; }
-    void SetCurrentState(TTernary State) { FCurrentState = State; }
-
-    TConnectionPoint* FindConnectionPointByRelPos(double relX, double relY, bool IsInput) {
-        auto& points = IsInput ? FInputs : FOutputs;
-        for (auto& point : points) {
-            if (fabs(point.RelX - relX) < 0.01 && fabs(point.RelY - relY) < 0.01) {
-                return &point;
-            }
-        }
-        return nullptr;
-    }
-
-    virtual String GetClassName() const { return "TCircuitElement"; }
-    virtual void SaveToIni(TIniFile* IniFile, const String& Section) const;
-    virtual void LoadFromIni(TIniFile* IniFile, const String& Section);
-
-    __property int Id = { read = FId };
-    __property String Name = { read = FName };
-    __property TRect Bounds = { read = FBounds };
-    __property TTernary CurrentState = { read = FCurrentState };
-    __property std::vector<TConnectionPoint> Inputs = { read = FInputs };
-    __property std::vector<TConnectionPoint> Outputs = { read = FOutputs };
-};
-
-class TMagneticAmplifier : public TCircuitElement {
-private:
-    bool FIsPowered;
-
-public:
-    TMagneticAmplifier(int AId, int X, int Y, bool IsPowerful = false);
-    void Calculate() override;
-    virtual String GetClassName() const override { return "TMagneticAmplifier"; }
-};
-
-class TTernaryElement : public TCircuitElement {
-public:
-    TTernaryElement(int AId, int X, int Y);
-    void Calculate() override;
-    virtual String GetClassName() const override { return "TTernaryElement"; }
-};
-
-class TShiftRegister : public TCircuitElement {
-private:
-    int FBitCount;
-
-public:
-    TShiftRegister(int AId, int X, int Y, int BitCount = 4);
-    void Calculate() override;
-    void Draw(TCanvas* Canvas) override;
-    virtual String GetClassName() const override { return "TShiftRegister"; }
-    virtual void SaveToIni(TIniFile* IniFile, const String& Section) const override;
-    virtual void LoadFromIni(TIniFile* IniFile, const String& Section) override;
-};
-
-#endif
+﻿#ifndef CircuitElementH
+#define CircuitElementH
+
+#include "TernaryTypes.h"
+#include "Modules/RenderTarget.h"
+#include <Vcl.Graphics.hpp>
+#include <System.Types.hpp>
+#include <vector>
+#include <System.Classes.hpp>
+#include <System.IniFiles.hpp>
+
+// Преобразование вида: экранные = логические * Zoom - Offset
+struct TViewTransform {
+    double Zoom;
+    int OffsetX;
+    int OffsetY;
+
+    TViewTransform() : Zoom(1.0), OffsetX(0), OffsetY(0) {}
+    TViewTransform(double AZoom, int AOffsetX, int AOffsetY)
+        : Zoom(AZoom), OffsetX(AOffsetX), OffsetY(AOffsetY) {}
+
+    TPoint ToScreen(const TPoint& P) const {
+        return TPoint(static_cast<int>(P.X * Zoom) - OffsetX, static_cast<int>(P.Y * Zoom) - OffsetY);
+    }
+    TRect ToScreen(const TRect& R) const {
+        return TRect(ToScreen(R.TopLeft()), ToScreen(R.BottomRight()));
+    }
+    TPoint ToLogical(const TPoint& P) const {
+        return TPoint(static_cast<int>((P.X + OffsetX) / Zoom), static_cast<int>((P.Y + OffsetY) / Zoom));
+    }
+};
+
+// Целочисленные параметры конкретного типа элемента для двоичного формата
+// схемы. Ключи - строковые литералы, которые сравниваются без выделения памяти
+class TElementParams {
+public:
+    virtual ~TElementParams() {}
+    virtual void WriteInteger(const char* Key, int Value) = 0;
+    virtual int ReadInteger(const char* Key, int Default) const = 0;
+};
+
+class TCircuitElement {
+protected:
+    int FId;
+    String FName;
+    TRect FBounds;
+    std::vector<TConnectionPoint> FInputs;
+    std::vector<TConnectionPoint> FOutputs;
+    TTernary FCurrentState;
+
+    void DrawMagneticAmplifier(TRenderTarget* Target, bool IsPowerful);
+    void DrawTernaryElement(TRenderTarget* Target);
+    void DrawControlLine(TRenderTarget* Target, const TConnectionPoint& Point);
+    void DrawCrossingLine(TRenderTarget* Target, int X1, int Y1, int X2, int Y2);
+	void DrawConnectionPoints(TRenderTarget* Target);
+    // Для элементов из библиотек, рисующих напрямую на TCanvas
+	void DrawConnectionPoints(TCanvas* Canvas);
+    static void RenderText(TRenderTarget* Target, int X, int Y, const String& Text);
+
+public:
+    TCircuitElement(int AId, const String& AName, int X, int Y);
+    virtual ~TCircuitElement() {}
+
+    virtual void Calculate() { /* Базовая реализация - ничего не делает */ }
+    // Отрисовка на экран; по умолчанию выполняется через Render поверх TCanvas
+    virtual void Draw(TCanvas* Canvas);
+    // Отрисовка в масштабе через мировое преобразование GDI, модель не изменяется
+    void DrawInView(TCanvas* Canvas, const TViewTransform& View);
+    virtual TConnectionPoint* GetConnectionAt(int X, int Y);
+
+void SetBounds(const TRect& NewBounds) {
+    FBounds = NewBounds;
+
+    // Обновляем абсолютные координаты на основе относительных с привязкой к сетке
+    int gridSize = 20;
+
+    for (auto& input : FInputs) {
+        input.X = NewBounds.Left + (int)(input.RelX * NewBounds.Width());
+        input.Y = NewBounds.Top + (int)(input.RelY * NewBounds.Height());
+        // Привязываем к сетке
+        input.X = ((input.X + gridSize/2) / gridSize) * gridSize;
+        input.Y = ((input.Y + gridSize/2) / gridSize) * gridSize;
+    }
+    for (auto& output : FOutputs) {
+        output.X = NewBounds.Left + (int)(output.RelX * NewBounds.Width());
+        output.Y = NewBounds.Top + (int)(output.RelY * NewBounds.Height());
+        // Привязываем к сетке
+        output.X = ((output.X + gridSize/2) / gridSize) * gridSize;
+        output.Y = ((output.Y + gridSize/2) / gridSize) * gridSize;
+	}
+	}
+
+
+	void CalculateRelativePositions() {
+		int gridSize = 20; // Размер сетки
+
+		for (auto& input : FInputs) {
+			// Привязываем абсолютные координаты к сетке
+			input.X = ((input.X + gridSize/2) / gridSize) * gridSize;
+			input.Y = ((input.Y + gridSize/2) / gridSize) * gridSize;
+
+			if (FBounds.Width() > 0 && FBounds.Height() > 0) {
+				input.RelX = (double)(input.X - FBounds.Left) / FBounds.Width();
+				input.RelY = (double)(input.Y - FBounds.Top) / FBounds.Height();
+			} else {
+				input.RelX = 0.0;
+				input.RelY = 0.5;
+			}
+		}
+
+		for (auto& output : FOutputs) {
+			// Привязываем абсолютные координаты к сетке
+			output.X = ((output.X + gridSize/2) / gridSize) * gridSize;
+			output.Y = ((output.Y + gridSize/2) / gridSize) * gridSize;
+
+			if (FBounds.Width() > 0 && FBounds.Height() > 0) {
+				output.RelX = (double)(output.X - FBounds.Left) / FBounds.Width();
+				output.RelY = (double)(output.Y - FBounds.Top) / FBounds.Height();
+			} else {
+				output.RelX = 1.0;
+				output.RelY = 0.5;
+			}
+		}
+	}
+
+    void SetId(int AId) { FId = AId; }
+    void SetName(const String& AName) { FName = AName; }
+    void SetCurrentState(TTernary State) { FCurrentState = State; }
+
+    TConnectionPoint* FindConnectionPointByRelPos(double relX, double relY, bool IsInput) {
+        auto& points = IsInput ? FInputs : FOutputs;
+        for (auto& point : points) {
+            if (fabs(point.RelX - relX) < 0.01 && fabs(point.RelY - relY) < 0.01) {
+                return &point;
+            }
+        }
+        return nullptr;
+    }
+
+    virtual String GetClassName() const { return "TCircuitElement"; }
+    virtual void SaveToIni(TCustomIniFile* IniFile, const String& Section) const;
+    virtual void LoadFromIni(TCustomIniFile* IniFile, const String& Section);
+
+    // Двоичный формат: общие поля и выводы восстанавливает загрузчик через
+    // RestoreState/RestorePort, элемент сохраняет только свои параметры
+    virtual void SaveParams(TElementParams& Params) const {}
+    virtual void LoadParams(const TElementParams& Params) {}
+
+    // Отрисовка через абстрактный бэкенд - экран, растр в памяти или SVG.
+    // Изменение списка виртуальных методов меняет ElementAbiVersion
+    // (ComponentLibrary.h): библиотеки, собранные раньше, нужно пересобрать
+    virtual void Render(TRenderTarget* Target);
+
+    // Состояние моделирования сверх CurrentState (счетчики, запомненные
+    // значения). В отличие от SaveParams не входит в структуру схемы: не
+    // попадает в определения подсхем и не сравнивается по умолчанию.
+    // Ключи не пересекаются с ключами SaveParams, по умолчанию значение 0
+    virtual void SaveState(TElementParams& Params) const {}
+    virtual void LoadState(const TElementParams& Params) {}
+    void RestoreState(int AId, const String& AName, const TRect& ABounds, TTernary State);
+    void RestorePort(bool IsInput, double RelX, double RelY, TLineStyle LineStyle);
+
+    __property int Id = { read = FId };
+    __property String Name = { read = FName };
+    __property TRect Bounds = { read = FBounds };
+    __property TTernary CurrentState = { read = FCurrentState };
+    __property std::vector<TConnectionPoint> Inputs = { read = FInputs };
+    __property std::vector<TConnectionPoint> Outputs = { read = FOutputs };
+};
+
+class TMagneticAmplifier : public TCircuitElement {
+private:
+    bool FIsPowered;
+
+public:
+    TMagneticAmplifier(int AId, int X, int Y, bool IsPowerful = false);
+    void Calculate() override;
+    virtual String GetClassName() const override { return "TMagneticAmplifier"; }
+};
+
+class TTernaryElement : public TCircuitElement {
+public:
+    TTernaryElement(int AId, int X, int Y);
+    void Calculate() override;
+    virtual String GetClassName() const override { return "TTernaryElement"; }
+};
+
+class TShiftRegister : public TCircuitElement {
+private:
+    int FBitCount;
+
+public:
+    TShiftRegister(int AId, int X, int Y, int BitCount = 4);
+    void Calculate() override;
+    void Render(TRenderTarget* Target) override;
+    virtual String GetClassName() const override { return "TShiftRegister"; }
+    virtual void SaveParams(TElementParams& Params) const override;
+    virtual void LoadParams(const TElementParams& Params) override;
+};
+
+#endif
@@ -1,122 +1,129 @@
-﻿#ifndef ComponentLibraryH
-#define ComponentLibraryH
-
-#include "CircuitElement.h"
-#include "CircuitElements.h"
-#include <vector>
-#include <memory>
-#include <functional>
-#include <System.Classes.hpp>
-
-// Базовый класс для всех элементов библиотеки
-class TLibraryElement {
-public:
-    virtual ~TLibraryElement() = default;
-    virtual String GetName() const = 0;
-    virtual String GetDescription() const = 0;
-    virtual String GetCategory() const = 0;
-    virtual std::unique_ptr<TCircuitElement> CreateElement(int Id, int X, int Y) const = 0;
-    virtual void GetDefaultSize(int& Width, int& Height) const = 0;
-};
-
-// Конкретная реализация элемента библиотеки
-template<typename T>
-class TConcreteLibraryElement : public TLibraryElement {
-private:
-    String FName;
-    String FDescription;
-    String FCategory;
-    int FDefaultWidth;
-    int FDefaultHeight;
-
-public:
-    TConcreteLibraryElement(const String& Name, const String& Description,
-                          const String& Category, int DefaultWidth = 80, int DefaultHeight = 60)
-        : FName(Name), FDescription(Description), FCategory(Category),
-          FDefaultWidth(DefaultWidth), FDefaultHeight(DefaultHeight) {}
-
-    String GetName() const override { return FName; }
-    String GetDescription() const override { return FDescription; }
-    String GetCategory() const override { return FCategory; }
-
-    std::unique_ptr<TCircuitElement> CreateElement(int Id, int X, int Y) const override {
-        return std::unique_ptr<TCircuitElement>(new T(Id, X, Y));
-    }
-
-    void GetDefaultSize(int& Width, int& Height) const override {
-        Width = FDefaultWidth;
-        Height = FDefaultHeight;
-    }
-};
-
-// Компонентная библиотека
-class TComponentLibrary {
-private:
-    String FName;
-    String FDescription;
-    String FVersion;
-    std::vector<std::unique_ptr<TLibraryElement>> FElements;
-    std::map<String, TLibraryElement*> FElementMap;
-
-    // Метод для получения количества элементов
-    int GetElementCount() const { return static_cast<int>(FElements.size()); }
-
-public:
-    TComponentLibrary(const String& Name, const String& Description, const String& Version = "1.0");
-
-    // Регистрация элемента
-    template<typename T>
-    void RegisterElement(const String& Name, const String& Description,
-                        const String& Category = "General", int DefaultWidth = 80, int DefaultHeight = 60) {
-        auto element = std::make_unique<TConcreteLibraryElement<T>>(Name, Description, Category, DefaultWidth, DefaultHeight);
-        FElementMap[Name] = element.get();
-        FElements.push_back(std::move(element));
-    }
-
-    // Создание элемента
-    std::unique_ptr<TCircuitElement> CreateElement(const String& Name, int Id, int X, int Y) const;
-
-    // Поиск элемента
-    bool HasElement(const String& Name) const;
-    const TLibraryElement* GetElementInfo(const String& Name) const;
-
-    // Получение списков
-    std::vector<String> GetElementNames() const;
-    std::vector<String> GetElementNamesByCategory(const String& Category) const;
-    std::vector<String> GetCategories() const;
-
-    __property String Name = { read = FName };
-    __property String Description = { read = FDescription };
-    __property String Version = { read = FVersion };
-    __property int ElementCount = { read = GetElementCount };
-};
-
-// Менеджер библиотек
-class TLibraryManager {
-private:
-    std::vector<std::unique_ptr<TComponentLibrary>> FLibraries;
-    TComponentLibrary* FCurrentLibrary;
-    std::map<String, TComponentLibrary*> FLibraryMap;
-
-public:
-    TLibraryManager();
-    ~TLibraryManager();
-
-    void RegisterLibrary(std::unique_ptr<TComponentLibrary> Library);
-    void UnregisterLibrary(const String& Name);
-    void SetCurrentLibrary(const String& Name);
-
-    TComponentLibrary* GetCurrentLibrary() const;
-    TComponentLibrary* GetLibrary(const String& Name) const;
-    std::vector<String> GetLibraryNames() const;
-
-    // Создание элементов
-    std::unique_ptr<TCircuitElement> CreateElement(const String& LibraryName, const String& ElementName, int Id, int X, int Y) const;
-    std::unique_ptr<TCircuitElement> CreateElementFromCurrent(const String& ElementName, int Id, int X, int Y) const;
-
-    // Поиск элементов
-    bool HasElement(const String& LibraryName, const String& ElementName) const;
-    const TLibraryElement* GetElementInfo(const String& LibraryName, const String& ElementName) const;
-};
-
-#endif
+﻿#ifndef ComponentLibraryH
+#define ComponentLibraryH
+
+#include "CircuitElement.h"
+#include "CircuitElements.h"
+#include <vector>
+#include <memory>
+#include <functional>
+#include <System.Classes.hpp>
+
+// Базовый класс для всех элементов библиотеки
+class TLibraryElement {
+public:
+    virtual ~TLibraryElement() = default;
+    virtual String GetName() const = 0;
+    virtual String GetDescription() const = 0;
+    virtual String GetCategory() const = 0;
+    virtual std::unique_ptr<TCircuitElement> CreateElement(int Id, int X, int Y) const = 0;
+    virtual void GetDefaultSize(int& Width, int& Height) const = 0;
+};
+
+// Конкретная реализация элемента библиотеки
+template<typename T>
+class TConcreteLibraryElement : public TLibraryElement {
+private:
+    String FName;
+    String FDescription;
+    String FCategory;
+    int FDefaultWidth;
+    int FDefaultHeight;
+
+public:
+    TConcreteLibraryElement(const String& Name, const String& Description,
+                          const String& Category, int DefaultWidth = 80, int DefaultHeight = 60)
+        : FName(Name), FDescription(Description), FCategory(Category),
+          FDefaultWidth(DefaultWidth), FDefaultHeight(DefaultHeight) {}
+
+    String GetName() const override { return FName; }
+    String GetDescription() const override { return FDescription; }
+    String GetCategory() const override { return FCategory; }
+
+    std::unique_ptr<TCircuitElement> CreateElement(int Id, int X, int Y) const override {
+        return std::unique_ptr<TCircuitElement>(new T(Id, X, Y));
+    }
+
+    void GetDefaultSize(int& Width, int& Height) const override {
+        Width = FDefaultWidth;
+        Height = FDefaultHeight;
+    }
+};
+
+// Компонентная библиотека
+class TComponentLibrary {
+private:
+    String FName;
+    String FDescription;
+    String FVersion;
+    std::vector<std::unique_ptr<TLibraryElement>> FElements;
+    std::map<String, TLibraryElement*> FElementMap;
+
+    // Метод для получения количества элементов
+    int GetElementCount() const { return static_cast<int>(FElements.size()); }
+
+public:
+    TComponentLibrary(const String& Name, const String& Description, const String& Version = "1.0");
+
+    // Регистрация элемента
+    template<typename T>
+    void RegisterElement(const String& Name, const String& Description,
+                        const String& Category = "General", int DefaultWidth = 80, int DefaultHeight = 60) {
+        auto element = std::make_unique<TConcreteLibraryElement<T>>(Name, Description, Category, DefaultWidth, DefaultHeight);
+        FElementMap[Name] = element.get();
+        FElements.push_back(std::move(element));
+    }
+
+    // Создание элемента
+    std::unique_ptr<TCircuitElement> CreateElement(const String& Name, int Id, int X, int Y) const;
+
+    // Поиск элемента
+    bool HasElement(const String& Name) const;
+    const TLibraryElement* GetElementInfo(const String& Name) const;
+
+    // Получение списков
+    std::vector<String> GetElementNames() const;
+    std::vector<String> GetElementNamesByCategory(const String& Category) const;
+    std::vector<String> GetCategories() const;
+
+    __property String Name = { read = FName };
+    __property String Description = { read = FDescription };
+    __property String Version = { read = FVersion };
+    __property int ElementCount = { read = GetElementCount };
+};
+
+// Версия двоичного интерфейса элементов для библиотек в DLL: таблицы
+// виртуальных методов TCircuitElement и раскладки классов этого заголовка.
+// Увеличивается при каждом их изменении. Библиотека возвращает значение,
+// с которым собрана, из GetLibraryAbiVersion; библиотека без этой функции
+// или с другой версией не загружается
+const int ElementAbiVersion = 3;
+
+// Менеджер библиотек
+class TLibraryManager {
+private:
+    std::vector<std::unique_ptr<TComponentLibrary>> FLibraries;
+    TComponentLibrary* FCurrentLibrary;
+    std::map<String, TComponentLibrary*> FLibraryMap;
+
+public:
+    TLibraryManager();
+    ~TLibraryManager();
+
+    void RegisterLibrary(std::unique_ptr<TComponentLibrary> Library);
+    void UnregisterLibrary(const String& Name);
+    void SetCurrentLibrary(const String& Name);
+
+    TComponentLibrary* GetCurrentLibrary() const;
+    TComponentLibrary* GetLibrary(const String& Name) const;
+    std::vector<String> GetLibraryNames() const;
+
+    // Создание элементов
+    std::unique_ptr<TCircuitElement> CreateElement(const String& LibraryName, const String& ElementName, int Id, int X, int Y) const;
+    std::unique_ptr<TCircuitElement> CreateElementFromCurrent(const String& ElementName, int Id, int X, int Y) const;
+
+    // Поиск элементов
+    bool HasElement(const String& LibraryName, const String& ElementName) const;
+    const TLibraryElement* GetElementInfo(const String& LibraryName, const String& ElementName) const;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "DisplayList.h"
+
+#pragma package(smart_init)
+
+// Точки группы передаются бэкенду без копирования
+static_assert(sizeof(TRenderPoint) == sizeof(TPoint), "TRenderPoint must match TPoint layout");
+
+TDisplayList::TDisplayList() : FEmpty(true) {
+}
+
+void TDisplayList::AddPolyline(const TPenState& Pen, const TPoint* Points, int Count) {
+    if (Count < 2) return;
+
+    TPolylineBatch& batch = FPolylines[Pen];
+    batch.Points.insert(batch.Points.end(), Points, Points + Count);
+    batch.Counts.push_back(static_cast<unsigned>(Count));
+    FEmpty = false;
+}
+
+void TDisplayList::AddLine(const TPenState& Pen, const TPoint& From, const TPoint& To) {
+    TPoint points[2] = { From, To };
+    AddPolyline(Pen, points, 2);
+}
+
+void TDisplayList::AddFillRect(TColor Color, const TRect& Rect) {
+    FFills[Color].push_back(Rect);
+    FEmpty = false;
+}
+
+void TDisplayList::Submit(TRenderTarget* Target) {
+    if (FEmpty) return;
+
+    for (auto& fill : FFills) {
+        if (fill.second.empty()) continue;
+
+        Target->SetBrushColor(ColorToRGB(fill.first));
+        for (const TRect& rect : fill.second) {
+            Target->FillRect(rect.Left, rect.Top, rect.Right, rect.Bottom);
+        }
+    }
+
+    for (auto& polyline : FPolylines) {
+        const TPenState& state = polyline.first;
+        TPolylineBatch& batch = polyline.second;
+        if (batch.Counts.empty()) continue;
+
+        Target->SetPenColor(ColorToRGB(state.Color));
+        Target->SetPenWidth(state.Width);
+        if (state.Style == psDash) Target->SetPenStyle(rpsDash);
+        else if (state.Style == psDot) Target->SetPenStyle(rpsDot);
+        else Target->SetPenStyle(rpsSolid);
+
+        Target->PolyPolyline(reinterpret_cast<const TRenderPoint*>(batch.Points.data()), batch.Counts.data(),
+                             static_cast<int>(batch.Counts.size()));
+    }
+    Target->SetPenStyle(rpsSolid);
+}
+
+void TDisplayList::Clear() {
+    for (auto& polyline : FPolylines) {
+        polyline.second.Points.clear();
+        polyline.second.Counts.clear();
+    }
+    for (auto& fill : FFills) {
+        fill.second.clear();
+    }
+    FEmpty = true;
+}
@@ -0,0 +1,54 @@
+#ifndef DisplayListH
+#define DisplayListH
+
+#include "RenderTarget.h"
+#include <Vcl.Graphics.hpp>
+#include <System.Types.hpp>
+#include <vector>
+#include <map>
+
+// Состояние пера, по которому группируются линии
+struct TPenState {
+    TColor Color;
+    int Width;
+    TPenStyle Style;
+
+    TPenState(TColor AColor = clBlack, int AWidth = 1, TPenStyle AStyle = psSolid)
+        : Color(AColor), Width(AWidth), Style(AStyle) {}
+
+    bool operator<(const TPenState& Other) const {
+        if (Color != Other.Color) return Color < Other.Color;
+        if (Width != Other.Width) return Width < Other.Width;
+        return Style < Other.Style;
+    }
+};
+
+// Список отрисовки: примитивы накапливаются по состоянию пера/кисти
+// и выводятся пакетами - одна смена состояния и один PolyPolyline на группу.
+// Вывод идет через TRenderTarget - на экран или в бэкенд экспорта
+class TDisplayList {
+private:
+    struct TPolylineBatch {
+        std::vector<TPoint> Points;
+        std::vector<unsigned> Counts;
+    };
+
+    std::map<TPenState, TPolylineBatch> FPolylines;
+    std::map<TColor, std::vector<TRect>> FFills;
+    bool FEmpty;
+
+public:
+    TDisplayList();
+
+    void AddPolyline(const TPenState& Pen, const TPoint* Points, int Count);
+    void AddLine(const TPenState& Pen, const TPoint& From, const TPoint& To);
+    void AddFillRect(TColor Color, const TRect& Rect);
+
+    // Заливки выводятся раньше линий
+    void Submit(TRenderTarget* Target);
+    // Память групп сохраняется для следующего кадра
+    void Clear();
+    bool IsEmpty() const { return FEmpty; }
+};
+
+#endif
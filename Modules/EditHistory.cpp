@@ -0,0 +1,282 @@
+﻿#include "MainForm.h"
+#include "EditHistory.h"
+#include <set>
+#include <unordered_set>
+
+#pragma package(smart_init)
+
+namespace {
+    // Возврат объектов на запомненные позиции одним проходом по списку вкладки
+    template <typename T>
+    void InsertAtPositions(std::vector<T>& Items, const std::vector<size_t>& Positions, std::vector<T>& Inserted) {
+        std::vector<T> merged;
+        merged.reserve(Items.size() + Inserted.size());
+
+        size_t next = 0;
+        for (size_t k = 0; k < Inserted.size(); k++) {
+            while (merged.size() < Positions[k] && next < Items.size()) {
+                merged.push_back(std::move(Items[next++]));
+            }
+            merged.push_back(std::move(Inserted[k]));
+        }
+        while (next < Items.size()) {
+            merged.push_back(std::move(Items[next++]));
+        }
+
+        Items.swap(merged);
+        Inserted.clear();
+    }
+}
+
+TElementSet::TElementSet(const std::vector<TCircuitElement*>& Elements, const std::vector<TConnection>& Connections,
+                         bool WithAttached)
+    : FElements(Elements), FConnections(Connections), FWithAttached(WithAttached), FInTab(true) {
+}
+
+void TElementSet::Remove(TTabData* TabData, TSerializationManager* Serialization) {
+    if (!FInTab) return;
+
+    std::unordered_set<const TCircuitElement*> members(FElements.begin(), FElements.end());
+    std::set<TConnection> listed(FConnections.begin(), FConnections.end());
+    auto isMember = [&](const TConnectionPoint* Point) {
+        return Point && Point->Owner && members.count(Point->Owner) > 0;
+    };
+
+    // Оставшиеся соединения и элементы сдвигаются одним проходом, для
+    // удаленных запоминаются позиции
+    auto& connections = TabData->Connections;
+    FConnectionPositions.clear();
+    FStoredConnections.clear();
+    size_t kept = 0;
+    for (size_t i = 0; i < connections.size(); i++) {
+        const TConnection& connection = connections[i];
+        if (listed.count(connection) ||
+            (FWithAttached && (isMember(connection.first) || isMember(connection.second)))) {
+            FConnectionPositions.push_back(i);
+            FStoredConnections.push_back(connection);
+        } else {
+            connections[kept++] = connection;
+        }
+    }
+    connections.resize(kept);
+
+    auto& elements = TabData->Elements;
+    FElementPositions.clear();
+    FStoredElements.clear();
+    kept = 0;
+    for (size_t i = 0; i < elements.size(); i++) {
+        if (members.count(elements[i].get())) {
+            FElementPositions.push_back(i);
+            TabData->Occupancy.Remove(elements[i]->Bounds);
+            TabData->Minimap.RemoveElement(elements[i]->Bounds);
+            TabData->RouteCache.InvalidateElement(elements[i].get());
+            FStoredElements.push_back(std::move(elements[i]));
+        } else {
+            if (kept != i) elements[kept] = std::move(elements[i]);
+            kept++;
+        }
+    }
+    elements.resize(kept);
+
+    TabData->RouteCache.Prune(connections);
+    FInTab = false;
+
+    if (Serialization) {
+        std::vector<int> ids;
+        for (const auto& element : FStoredElements) {
+            ids.push_back(element->Id);
+        }
+        Serialization->JournalRemove(TabData, ids);
+
+        // Соединения удаленных элементов исчезают вместе с ними
+        for (const auto& connection : FStoredConnections) {
+            if (!isMember(connection.first) && !isMember(connection.second)) {
+                Serialization->JournalDisconnect(TabData, connection);
+            }
+        }
+    }
+}
+
+void TElementSet::Restore(TTabData* TabData, TSerializationManager* Serialization) {
+    if (FInTab) return;
+
+    std::vector<TCircuitElement*> restored;
+    for (const auto& element : FStoredElements) {
+        TabData->Occupancy.Add(element->Bounds);
+        TabData->Minimap.AddElement(element->Bounds);
+        restored.push_back(element.get());
+    }
+    std::vector<TConnection> connections = FStoredConnections;
+
+    InsertAtPositions(TabData->Elements, FElementPositions, FStoredElements);
+    InsertAtPositions(TabData->Connections, FConnectionPositions, FStoredConnections);
+    FElementPositions.clear();
+    FConnectionPositions.clear();
+    FInTab = true;
+
+    if (Serialization) {
+        Serialization->JournalPut(TabData, restored);
+        for (const auto& connection : connections) {
+            Serialization->JournalConnect(TabData, connection);
+        }
+    }
+}
+
+void TElementSet::Release(std::vector<std::unique_ptr<TCircuitElement>>& Elements) {
+    Elements = std::move(FStoredElements);
+    FStoredElements.clear();
+}
+
+void TElementSet::Adopt(std::vector<std::unique_ptr<TCircuitElement>>&& Elements) {
+    FStoredElements = std::move(Elements);
+}
+
+TElementPlacement TElementPlacement::Capture(TCircuitElement* Element) {
+    TElementPlacement placement;
+    placement.Bounds = Element->Bounds;
+    for (const auto& point : Element->Inputs) {
+        placement.Ports.push_back(std::make_pair(point.RelX, point.RelY));
+    }
+    for (const auto& point : Element->Outputs) {
+        placement.Ports.push_back(std::make_pair(point.RelX, point.RelY));
+    }
+    return placement;
+}
+
+void TElementPlacement::Apply(TCircuitElement* Element) const {
+    // Положения выводов задаются до границ: по ним SetBounds расставляет выводы
+    size_t inputs = Element->Inputs.size();
+    for (size_t i = 0; i < Ports.size(); i++) {
+        TConnectionPoint* point = i < inputs ? &Element->Inputs[i] :
+            i - inputs < Element->Outputs.size() ? &Element->Outputs[i - inputs] : nullptr;
+        if (point) {
+            point->RelX = Ports[i].first;
+            point->RelY = Ports[i].second;
+        }
+    }
+    Element->SetBounds(Bounds);
+}
+
+void TInsertCommand::Undo(TTabData* TabData, TSerializationManager* Serialization) {
+    FSet.Remove(TabData, Serialization);
+}
+
+void TInsertCommand::Redo(TTabData* TabData, TSerializationManager* Serialization) {
+    FSet.Restore(TabData, Serialization);
+}
+
+void TRemoveCommand::Undo(TTabData* TabData, TSerializationManager* Serialization) {
+    FSet.Restore(TabData, Serialization);
+    if (FClear) {
+        TabData->NextElementId = FNextElementId;
+    }
+}
+
+void TRemoveCommand::Redo(TTabData* TabData, TSerializationManager* Serialization) {
+    if (FClear) {
+        // Очистка попадает в журнал одной записью
+        FNextElementId = TabData->NextElementId;
+        FSet.Remove(TabData, nullptr);
+        TabData->NextElementId = 1;
+        if (Serialization) Serialization->JournalClear(TabData);
+    } else {
+        FSet.Remove(TabData, Serialization);
+    }
+}
+
+void TMoveCommand::Place(TTabData* TabData, TSerializationManager* Serialization,
+                         const TElementPlacement& Placement) {
+    TabData->Occupancy.Move(FElement->Bounds, Placement.Bounds);
+    TabData->Minimap.MoveElement(FElement->Bounds, Placement.Bounds);
+    Placement.Apply(FElement);
+    TabData->RouteCache.InvalidateElement(FElement);
+    if (Serialization) Serialization->JournalMove(TabData, FElement);
+}
+
+void TMoveCommand::Undo(TTabData* TabData, TSerializationManager* Serialization) {
+    Place(TabData, Serialization, FBefore);
+}
+
+void TMoveCommand::Redo(TTabData* TabData, TSerializationManager* Serialization) {
+    Place(TabData, Serialization, FAfter);
+}
+
+TGroupCommand::TGroupCommand(TElementSet&& Grouped, TSubCircuit* SubCircuit)
+    : FGrouped(std::move(Grouped)),
+      FSubCircuitSet(std::vector<TCircuitElement*>(1, SubCircuit), std::vector<TElementSet::TConnection>(), true),
+      FSubCircuit(SubCircuit) {
+}
+
+void TGroupCommand::Undo(TTabData* TabData, TSerializationManager* Serialization) {
+    FSubCircuitSet.Remove(TabData, Serialization);
+
+    std::vector<std::unique_ptr<TCircuitElement>> elements;
+    std::vector<TElementSet::TConnection> connections;
+    FSubCircuit->ReleaseInternals(elements, connections);
+    FGrouped.Adopt(std::move(elements));
+    FGrouped.Restore(TabData, Serialization);
+}
+
+void TGroupCommand::Redo(TTabData* TabData, TSerializationManager* Serialization) {
+    FGrouped.Remove(TabData, Serialization);
+
+    std::vector<std::unique_ptr<TCircuitElement>> elements;
+    FGrouped.Release(elements);
+    FSubCircuit->AdoptInternals(std::move(elements), FGrouped.GetStoredConnections());
+    FSubCircuitSet.Restore(TabData, Serialization);
+}
+
+String TGroupCommand::GetDescription() const {
+    return "группировка";
+}
+
+void TReplaceCommand::Undo(TTabData* TabData, TSerializationManager* Serialization) {
+    FRemoved.Restore(TabData, Serialization);
+    FAdded.Remove(TabData, Serialization);
+}
+
+void TReplaceCommand::Redo(TTabData* TabData, TSerializationManager* Serialization) {
+    FAdded.Restore(TabData, Serialization);
+    FRemoved.Remove(TabData, Serialization);
+}
+
+void TEditHistory::Push(std::unique_ptr<TEditCommand> Command) {
+    FRedo.clear();
+    FUndo.push_back(std::move(Command));
+
+    // Старые команды забываются вместе с удаленными ими объектами
+    if (FUndo.size() > FLimit) {
+        FUndo.erase(FUndo.begin());
+    }
+}
+
+void TEditHistory::Execute(std::unique_ptr<TEditCommand> Command, TTabData* TabData,
+                           TSerializationManager* Serialization) {
+    Command->Redo(TabData, Serialization);
+    Push(std::move(Command));
+}
+
+TEditCommand* TEditHistory::Undo(TTabData* TabData, TSerializationManager* Serialization) {
+    if (FUndo.empty()) return nullptr;
+
+    std::unique_ptr<TEditCommand> command = std::move(FUndo.back());
+    FUndo.pop_back();
+    command->Undo(TabData, Serialization);
+    FRedo.push_back(std::move(command));
+    return FRedo.back().get();
+}
+
+TEditCommand* TEditHistory::Redo(TTabData* TabData, TSerializationManager* Serialization) {
+    if (FRedo.empty()) return nullptr;
+
+    std::unique_ptr<TEditCommand> command = std::move(FRedo.back());
+    FRedo.pop_back();
+    command->Redo(TabData, Serialization);
+    FUndo.push_back(std::move(command));
+    return FUndo.back().get();
+}
+
+void TEditHistory::Clear() {
+    FUndo.clear();
+    FRedo.clear();
+}
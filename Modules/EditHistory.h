@@ -0,0 +1,176 @@
+#ifndef EditHistoryH
+#define EditHistoryH
+
+#include "CircuitElement.h"
+#include <memory>
+#include <vector>
+
+class TTabData;
+class TSubCircuit;
+class TSerializationManager;
+
+// Элементы и соединения, которые переходят между схемой вкладки и хранилищем
+// изменения. Объекты не копируются и не уничтожаются: отмена удаления
+// возвращает те же элементы на прежние места, указатели на выводы остаются верными
+class TElementSet {
+public:
+    typedef std::pair<TConnectionPoint*, TConnectionPoint*> TConnection;
+
+private:
+    std::vector<TCircuitElement*> FElements;
+    std::vector<TConnection> FConnections;
+    // При удалении забрать и все соединения элементов, а не только FConnections
+    bool FWithAttached;
+    bool FInTab;
+
+    // Вне вкладки: объекты и их позиции в списках вкладки на момент удаления
+    std::vector<size_t> FElementPositions;
+    std::vector<std::unique_ptr<TCircuitElement>> FStoredElements;
+    std::vector<size_t> FConnectionPositions;
+    std::vector<TConnection> FStoredConnections;
+
+public:
+    // Набор уже находится во вкладке
+    TElementSet(const std::vector<TCircuitElement*>& Elements, const std::vector<TConnection>& Connections,
+                bool WithAttached);
+
+    bool IsInTab() const { return FInTab; }
+    const std::vector<TCircuitElement*>& GetElements() const { return FElements; }
+
+    // Serialization - журнал автосохранения вкладки или nullptr
+    void Remove(TTabData* TabData, TSerializationManager* Serialization);
+    void Restore(TTabData* TabData, TSerializationManager* Serialization);
+
+    // Удаленные элементы передаются в подсхему и обратно без копирования,
+    // позиции во вкладке при этом сохраняются
+    void Release(std::vector<std::unique_ptr<TCircuitElement>>& Elements);
+    void Adopt(std::vector<std::unique_ptr<TCircuitElement>>&& Elements);
+    const std::vector<TConnection>& GetStoredConnections() const { return FStoredConnections; }
+};
+
+// Границы элемента и положения его выводов
+struct TElementPlacement {
+    TRect Bounds;
+    std::vector<std::pair<double, double>> Ports;   // сначала входы, за ними выходы
+
+    static TElementPlacement Capture(TCircuitElement* Element);
+    void Apply(TCircuitElement* Element) const;
+};
+
+// Изменение схемы вкладки. Команда хранит только разницу: удаленные объекты,
+// позиции, границы - но не копию схемы
+class TEditCommand {
+public:
+    virtual ~TEditCommand() {}
+    virtual void Undo(TTabData* TabData, TSerializationManager* Serialization) = 0;
+    virtual void Redo(TTabData* TabData, TSerializationManager* Serialization) = 0;
+    // Для строки состояния
+    virtual String GetDescription() const = 0;
+};
+
+// Добавленные элементы и соединения
+class TInsertCommand : public TEditCommand {
+private:
+    TElementSet FSet;
+    String FDescription;
+
+public:
+    TInsertCommand(TElementSet&& Set, const String& Description) : FSet(std::move(Set)), FDescription(Description) {}
+    void Undo(TTabData* TabData, TSerializationManager* Serialization) override;
+    void Redo(TTabData* TabData, TSerializationManager* Serialization) override;
+    String GetDescription() const override { return FDescription; }
+};
+
+// Удаление; Redo выполняет его в первый раз. Очистка вкладки заодно сбрасывает
+// счетчик Id, отмена возвращает прежний
+class TRemoveCommand : public TEditCommand {
+private:
+    TElementSet FSet;
+    String FDescription;
+    bool FClear;
+    int FNextElementId;
+
+public:
+    TRemoveCommand(TElementSet&& Set, const String& Description, bool Clear = false)
+        : FSet(std::move(Set)), FDescription(Description), FClear(Clear), FNextElementId(0) {}
+    void Undo(TTabData* TabData, TSerializationManager* Serialization) override;
+    void Redo(TTabData* TabData, TSerializationManager* Serialization) override;
+    String GetDescription() const override { return FDescription; }
+};
+
+// Перемещение или поворот уже выполнены, команда помнит положение до и после
+class TMoveCommand : public TEditCommand {
+private:
+    TCircuitElement* FElement;
+    TElementPlacement FBefore;
+    TElementPlacement FAfter;
+    String FDescription;
+
+    void Place(TTabData* TabData, TSerializationManager* Serialization, const TElementPlacement& Placement);
+
+public:
+    TMoveCommand(TCircuitElement* Element, const TElementPlacement& Before, const String& Description)
+        : FElement(Element), FBefore(Before), FAfter(TElementPlacement::Capture(Element)),
+          FDescription(Description) {}
+    void Undo(TTabData* TabData, TSerializationManager* Serialization) override;
+    void Redo(TTabData* TabData, TSerializationManager* Serialization) override;
+    String GetDescription() const override { return FDescription; }
+};
+
+// Группировка: выделенные элементы и их внутренние соединения переходят в
+// подсхему, подсхема - во вкладку. Grouped уже удален из вкладки и передан подсхеме
+class TGroupCommand : public TEditCommand {
+private:
+    TElementSet FGrouped;
+    TElementSet FSubCircuitSet;
+    TSubCircuit* FSubCircuit;
+
+public:
+    TGroupCommand(TElementSet&& Grouped, TSubCircuit* SubCircuit);
+    void Undo(TTabData* TabData, TSerializationManager* Serialization) override;
+    void Redo(TTabData* TabData, TSerializationManager* Serialization) override;
+    String GetDescription() const override;
+};
+
+// Добавление одного набора и удаление другого, например разгруппировка:
+// копии внутренних элементов во вкладке, подсхема - в хранилище.
+// Оба шага уже выполнены, отмена идет в обратном порядке
+class TReplaceCommand : public TEditCommand {
+private:
+    TElementSet FAdded;
+    TElementSet FRemoved;
+    String FDescription;
+
+public:
+    TReplaceCommand(TElementSet&& Added, TElementSet&& Removed, const String& Description)
+        : FAdded(std::move(Added)), FRemoved(std::move(Removed)), FDescription(Description) {}
+    void Undo(TTabData* TabData, TSerializationManager* Serialization) override;
+    void Redo(TTabData* TabData, TSerializationManager* Serialization) override;
+    String GetDescription() const override { return FDescription; }
+};
+
+// Стеки отмены и повтора вкладки
+class TEditHistory {
+private:
+    std::vector<std::unique_ptr<TEditCommand>> FUndo;
+    std::vector<std::unique_ptr<TEditCommand>> FRedo;
+    size_t FLimit;
+
+public:
+    explicit TEditHistory(size_t Limit = 200) : FLimit(Limit) {}
+
+    // Команда уже выполнена; повторять отмененное после нового изменения нельзя
+    void Push(std::unique_ptr<TEditCommand> Command);
+    // Выполнить команду через Redo и запомнить
+    void Execute(std::unique_ptr<TEditCommand> Command, TTabData* TabData, TSerializationManager* Serialization);
+
+    bool CanUndo() const { return !FUndo.empty(); }
+    bool CanRedo() const { return !FRedo.empty(); }
+    // Отмененная или повторенная команда, nullptr - стек пуст
+    TEditCommand* Undo(TTabData* TabData, TSerializationManager* Serialization);
+    TEditCommand* Redo(TTabData* TabData, TSerializationManager* Serialization);
+
+    void Clear();
+};
+
+#endif
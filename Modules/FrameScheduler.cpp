@@ -0,0 +1,45 @@
+#include "FrameScheduler.h"
+
+#pragma package(smart_init)
+
+TFrameScheduler::TFrameScheduler(unsigned MaxFrameRate)
+    : FFramePending(false), FMinFrameInterval(16), FLastFrameTime(0), FOnRender(nullptr) {
+
+    FFrameTimer = new TTimer(nullptr);
+    FFrameTimer->Enabled = false;
+    FFrameTimer->OnTimer = &FrameTimerTimer;
+    SetMaxFrameRate(MaxFrameRate);
+}
+
+TFrameScheduler::~TFrameScheduler() {
+    FFrameTimer->Enabled = false;
+    delete FFrameTimer;
+}
+
+void TFrameScheduler::SetMaxFrameRate(unsigned MaxFrameRate) {
+    FMinFrameInterval = MaxFrameRate > 0 ? 1000 / MaxFrameRate : 16;
+    if (FMinFrameInterval == 0) FMinFrameInterval = 1;
+}
+
+void TFrameScheduler::RequestFrame() {
+    // Кадр уже запланирован - новый запрос в него войдет
+    if (FFramePending) return;
+    FFramePending = true;
+
+    // Выдерживаем минимальный интервал с момента предыдущего кадра
+    DWORD elapsed = GetTickCount() - FLastFrameTime;
+    unsigned delay = elapsed >= FMinFrameInterval ? 1 : FMinFrameInterval - elapsed;
+
+    FFrameTimer->Interval = delay;
+    FFrameTimer->Enabled = true;
+}
+
+void __fastcall TFrameScheduler::FrameTimerTimer(TObject* Sender) {
+    FFrameTimer->Enabled = false;
+    FFramePending = false;
+    FLastFrameTime = GetTickCount();
+
+    if (FOnRender) {
+        FOnRender();
+    }
+}
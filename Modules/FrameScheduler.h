@@ -0,0 +1,33 @@
+#ifndef FrameSchedulerH
+#define FrameSchedulerH
+
+#include <System.Classes.hpp>
+#include <Vcl.ExtCtrls.hpp>
+
+// Отрисовка кадра, накопившего все запросы с момента предыдущего
+typedef void __fastcall (__closure *TFrameRenderEvent)();
+
+// Планировщик кадров: запросы перерисовки только помечают вид грязным,
+// сама отрисовка выполняется не чаще одного раза за кадр
+class TFrameScheduler {
+private:
+    TTimer* FFrameTimer;
+    bool FFramePending;
+    unsigned FMinFrameInterval;
+    DWORD FLastFrameTime;
+    TFrameRenderEvent FOnRender;
+
+public:
+    TFrameScheduler(unsigned MaxFrameRate = 60);
+    ~TFrameScheduler();
+
+    void RequestFrame();
+    bool IsFramePending() const { return FFramePending; }
+
+    void SetMaxFrameRate(unsigned MaxFrameRate);
+    void SetOnRender(TFrameRenderEvent Handler) { FOnRender = Handler; }
+
+    void __fastcall FrameTimerTimer(TObject* Sender);
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "GdiRenderTarget.h"
+
+#pragma package(smart_init)
+
+// TRenderPoint передается в GDI без копирования
+static_assert(sizeof(TRenderPoint) == sizeof(POINT), "TRenderPoint must match POINT layout");
+static_assert(sizeof(unsigned) == sizeof(DWORD), "Polyline counts must match DWORD");
+
+TLabelAtlas* TGdiRenderTarget::FActiveLabelAtlas = nullptr;
+
+TGdiRenderTarget::TGdiRenderTarget(TCanvas* Canvas)
+    : FCanvas(Canvas), FTransformed(false), FOldGraphicsMode(GM_COMPATIBLE) {
+}
+
+TGdiRenderTarget::~TGdiRenderTarget() {
+    RestoreTransform();
+}
+
+void TGdiRenderTarget::SetPenColor(TRenderColor Color) {
+    TRenderTarget::SetPenColor(Color);
+    FCanvas->Pen->Color = static_cast<TColor>(Color);
+}
+
+void TGdiRenderTarget::SetPenWidth(int Width) {
+    TRenderTarget::SetPenWidth(Width);
+    FCanvas->Pen->Width = Width;
+}
+
+void TGdiRenderTarget::SetPenStyle(TRenderPenStyle Style) {
+    TRenderTarget::SetPenStyle(Style);
+    switch (Style) {
+        case rpsDash: FCanvas->Pen->Style = psDash; break;
+        case rpsDot: FCanvas->Pen->Style = psDot; break;
+        default: FCanvas->Pen->Style = psSolid; break;
+    }
+}
+
+void TGdiRenderTarget::SetBrushColor(TRenderColor Color) {
+    TRenderTarget::SetBrushColor(Color);
+    FCanvas->Brush->Color = static_cast<TColor>(Color);
+}
+
+void TGdiRenderTarget::SetBrushClear(bool Clear) {
+    TRenderTarget::SetBrushClear(Clear);
+    FCanvas->Brush->Style = Clear ? bsClear : bsSolid;
+}
+
+void TGdiRenderTarget::SetFontSize(int Size) {
+    TRenderTarget::SetFontSize(Size);
+    FCanvas->Font->Size = Size;
+}
+
+void TGdiRenderTarget::SetFontColor(TRenderColor Color) {
+    TRenderTarget::SetFontColor(Color);
+    FCanvas->Font->Color = static_cast<TColor>(Color);
+}
+
+void TGdiRenderTarget::SetTransform(double Zoom, int OffsetX, int OffsetY) {
+    TRenderTarget::SetTransform(Zoom, OffsetX, OffsetY);
+
+    HDC dc = FCanvas->Handle;
+    if (Zoom == 1.0 && OffsetX == 0 && OffsetY == 0) {
+        RestoreTransform();
+        return;
+    }
+
+    if (!FTransformed) {
+        FOldGraphicsMode = SetGraphicsMode(dc, GM_ADVANCED);
+        GetWorldTransform(dc, &FOldTransform);
+        FTransformed = true;
+    }
+
+    XFORM transform;
+    transform.eM11 = static_cast<FLOAT>(Zoom);
+    transform.eM12 = 0.0f;
+    transform.eM21 = 0.0f;
+    transform.eM22 = static_cast<FLOAT>(Zoom);
+    transform.eDx = static_cast<FLOAT>(-OffsetX);
+    transform.eDy = static_cast<FLOAT>(-OffsetY);
+    SetWorldTransform(dc, &transform);
+}
+
+void TGdiRenderTarget::RestoreTransform() {
+    if (!FTransformed) return;
+
+    // Вернуть GM_COMPATIBLE можно только при единичном преобразовании
+    HDC dc = FCanvas->Handle;
+    SetWorldTransform(dc, &FOldTransform);
+    SetGraphicsMode(dc, FOldGraphicsMode);
+    FTransformed = false;
+}
+
+void TGdiRenderTarget::MoveTo(int X, int Y) {
+    FCanvas->MoveTo(X, Y);
+}
+
+void TGdiRenderTarget::LineTo(int X, int Y) {
+    FCanvas->LineTo(X, Y);
+}
+
+void TGdiRenderTarget::Polyline(const TRenderPoint* Points, int Count) {
+    if (Count < 2) return;
+    FCanvas->Polyline(reinterpret_cast<const TPoint*>(Points), Count - 1);
+}
+
+void TGdiRenderTarget::PolyPolyline(const TRenderPoint* Points, const unsigned* Counts, int PolyCount) {
+    if (PolyCount <= 0) return;
+
+    // Перо создается один раз на весь пакет ломаных
+    int style = PS_SOLID;
+    if (FPenStyle == rpsDash) style = PS_DASH;
+    else if (FPenStyle == rpsDot) style = PS_DOT;
+
+    HDC dc = FCanvas->Handle;
+    HPEN pen = CreatePen(style, FPenWidth, ColorToRGB(static_cast<TColor>(FPenColor)));
+    HGDIOBJ oldPen = SelectObject(dc, pen);
+    ::PolyPolyline(dc, reinterpret_cast<const POINT*>(Points), reinterpret_cast<const DWORD*>(Counts),
+                   static_cast<DWORD>(PolyCount));
+    SelectObject(dc, oldPen);
+    DeleteObject(pen);
+}
+
+void TGdiRenderTarget::Rectangle(int Left, int Top, int Right, int Bottom) {
+    FCanvas->Rectangle(Left, Top, Right, Bottom);
+}
+
+void TGdiRenderTarget::Ellipse(int Left, int Top, int Right, int Bottom) {
+    FCanvas->Ellipse(Left, Top, Right, Bottom);
+}
+
+void TGdiRenderTarget::FillRect(int Left, int Top, int Right, int Bottom) {
+    FCanvas->FillRect(TRect(Left, Top, Right, Bottom));
+}
+
+void TGdiRenderTarget::TextOut(int X, int Y, const wchar_t* Text) {
+    // Из атласа подпись копируется готовым растром, без построения текста
+    if (FActiveLabelAtlas && FActiveLabelAtlas->Draw(FCanvas, X, Y, Text)) return;
+    FCanvas->TextOut(X, Y, Text);
+}
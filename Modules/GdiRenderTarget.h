@@ -0,0 +1,51 @@
+#ifndef GdiRenderTargetH
+#define GdiRenderTargetH
+
+#include "RenderTarget.h"
+#include "LabelAtlas.h"
+#include <Vcl.Graphics.hpp>
+#include <windows.h>
+
+// Бэкенд отрисовки поверх VCL TCanvas (экран и буферы TBitmap)
+class TGdiRenderTarget : public TRenderTarget {
+private:
+    TCanvas* FCanvas;
+    bool FTransformed;
+    int FOldGraphicsMode;
+    XFORM FOldTransform;
+
+    void RestoreTransform();
+
+    static TLabelAtlas* FActiveLabelAtlas;
+
+public:
+    explicit TGdiRenderTarget(TCanvas* Canvas);
+    ~TGdiRenderTarget();
+
+    TCanvas* GetCanvas() const { return FCanvas; }
+
+    // Атлас подписей для всех GDI-целей на время отрисовки кадра (только главный поток).
+    // Без атласа подписи выводятся через TextOut
+    static void SetActiveLabelAtlas(TLabelAtlas* Atlas) { FActiveLabelAtlas = Atlas; }
+
+    void SetPenColor(TRenderColor Color) override;
+    void SetPenWidth(int Width) override;
+    void SetPenStyle(TRenderPenStyle Style) override;
+    void SetBrushColor(TRenderColor Color) override;
+    void SetBrushClear(bool Clear) override;
+    void SetFontSize(int Size) override;
+    void SetFontColor(TRenderColor Color) override;
+    // Масштаб и смещение выполняет GDI через мировое преобразование
+    void SetTransform(double Zoom, int OffsetX, int OffsetY) override;
+
+    void MoveTo(int X, int Y) override;
+    void LineTo(int X, int Y) override;
+    void Polyline(const TRenderPoint* Points, int Count) override;
+    void PolyPolyline(const TRenderPoint* Points, const unsigned* Counts, int PolyCount) override;
+    void Rectangle(int Left, int Top, int Right, int Bottom) override;
+    void Ellipse(int Left, int Top, int Right, int Bottom) override;
+    void FillRect(int Left, int Top, int Right, int Bottom) override;
+    void TextOut(int X, int Y, const wchar_t* Text) override;
+};
+
+#endif
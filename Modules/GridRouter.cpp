@@ -0,0 +1,278 @@
+#include "GridRouter.h"
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <queue>
+
+#pragma package(smart_init)
+
+namespace {
+    const int StepCost = 10;
+    const int BendCost = 40;
+    const int CrossCost = 20;
+    const int OverlapCost = 60;
+
+    // Вес эвристики больше единицы: маршрут дороже оптимального не более чем
+    // в HeuristicWeight раз, зато поиск не растекается по всему окну
+    const int HeuristicWeightNum = 3;
+    const int HeuristicWeightDen = 2;
+
+    // Запас окна поиска вокруг концов провода и пределы работы одного поиска
+    const int WindowMargin = 12;
+    const int MaxWindowCells = 512 * 512;
+    const int MaxExpanded = 100000;
+
+    // Направления: 0 - вправо, 1 - влево, 2 - вниз, 3 - вверх; d ^ 1 - обратное
+    const int DirX[4] = { 1, -1, 0, 0 };
+    const int DirY[4] = { 0, 0, 1, -1 };
+
+    int FloorDiv(int Value, int Divisor) {
+        return Value >= 0 ? Value / Divisor : -((-Value + Divisor - 1) / Divisor);
+    }
+
+    int RoundDiv(int Value, int Divisor) {
+        return FloorDiv(Value + Divisor / 2, Divisor);
+    }
+
+    void AppendPoint(std::vector<TPoint>& Path, const TPoint& Point) {
+        if (!Path.empty() && Path.back() == Point) return;
+
+        // Точка на продолжении последнего сегмента заменяет его конец
+        size_t count = Path.size();
+        if (count >= 2) {
+            const TPoint& a = Path[count - 2];
+            const TPoint& b = Path[count - 1];
+            if ((a.X == b.X && b.X == Point.X) || (a.Y == b.Y && b.Y == Point.Y)) {
+                Path[count - 1] = Point;
+                return;
+            }
+        }
+        Path.push_back(Point);
+    }
+}
+
+void TGridRouter::SetObstacles(const std::vector<TRect>& Bodies) {
+    FObstacles.clear();
+    FBuckets.clear();
+    FObstacles.reserve(Bodies.size());
+
+    // Клетка занята, если узел сетки ближе половины шага к корпусу
+    int half = GridSize / 2;
+    for (const TRect& body : Bodies) {
+        TRect cells;
+        cells.Left = FloorDiv(body.Left - half, GridSize) + 1;
+        cells.Top = FloorDiv(body.Top - half, GridSize) + 1;
+        cells.Right = FloorDiv(body.Right + half - 1, GridSize);
+        cells.Bottom = FloorDiv(body.Bottom + half - 1, GridSize);
+        if (cells.Left > cells.Right || cells.Top > cells.Bottom) continue;
+
+        int index = (int)FObstacles.size();
+        FObstacles.push_back(cells);
+
+        for (int by = FloorDiv(cells.Top, BucketCells); by <= FloorDiv(cells.Bottom, BucketCells); by++) {
+            for (int bx = FloorDiv(cells.Left, BucketCells); bx <= FloorDiv(cells.Right, BucketCells); bx++) {
+                FBuckets[CellKey(bx, by)].push_back(index);
+            }
+        }
+    }
+}
+
+void TGridRouter::UpdateUsage(const std::vector<TPoint>& Path, int Delta) {
+    for (size_t i = 0; i + 1 < Path.size(); i++) {
+        const TPoint& a = Path[i];
+        const TPoint& b = Path[i + 1];
+        bool horizontal = (a.Y == b.Y);
+        if (!horizontal && a.X != b.X) continue;
+
+        int from = RoundDiv(horizontal ? std::min(a.X, b.X) : std::min(a.Y, b.Y), GridSize);
+        int to = RoundDiv(horizontal ? std::max(a.X, b.X) : std::max(a.Y, b.Y), GridSize);
+        int fixed = RoundDiv(horizontal ? a.Y : a.X, GridSize);
+
+        for (int c = from; c <= to; c++) {
+            long long key = horizontal ? CellKey(c, fixed) : CellKey(fixed, c);
+            if (Delta > 0) {
+                TCellUsage& usage = FUsage[key];
+                if (horizontal) usage.Horizontal++; else usage.Vertical++;
+                continue;
+            }
+
+            auto it = FUsage.find(key);
+            if (it == FUsage.end()) continue;
+            unsigned short& count = horizontal ? it->second.Horizontal : it->second.Vertical;
+            if (count > 0) count--;
+            if (it->second.Horizontal == 0 && it->second.Vertical == 0) FUsage.erase(it);
+        }
+    }
+}
+
+void TGridRouter::GetPortExit(const TPoint& Port, const TRect& Body, const TPoint& Other,
+                              int& CellX, int& CellY, int& Dir) const {
+    int half = GridSize / 2;
+    CellY = RoundDiv(Port.Y, GridSize);
+
+    if (Body.Width() <= 0 || Body.Height() <= 0) {
+        Dir = Other.X >= Port.X ? 0 : 1;
+        CellX = RoundDiv(Port.X, GridSize);
+        return;
+    }
+
+    // Вывод на правой половине корпуса уходит вправо, на левой - влево
+    if (Port.X * 2 >= Body.Left + Body.Right) {
+        Dir = 0;
+        CellX = std::max(FloorDiv(Body.Right + half - 1, GridSize) + 1, FloorDiv(Port.X + GridSize - 1, GridSize));
+    } else {
+        Dir = 1;
+        CellX = std::min(FloorDiv(Body.Left - half, GridSize), FloorDiv(Port.X, GridSize));
+    }
+}
+
+bool TGridRouter::FindPath(const TPoint& Start, const TRect& StartBody, const TPoint& End, const TRect& EndBody,
+                           std::vector<TPoint>& Path) const {
+    int startX, startY, startDir;
+    int endX, endY, endDir;
+    GetPortExit(Start, StartBody, End, startX, startY, startDir);
+    GetPortExit(End, EndBody, Start, endX, endY, endDir);
+
+    int minX = std::min(startX, endX) - WindowMargin;
+    int minY = std::min(startY, endY) - WindowMargin;
+    int width = std::abs(startX - endX) + 2 * WindowMargin + 1;
+    int height = std::abs(startY - endY) + 2 * WindowMargin + 1;
+    if ((long long)width * height > MaxWindowCells) return false;
+
+    // Карта препятствий окна: только корпуса из корзин, задевающих окно
+    std::vector<unsigned char> blocked((size_t)width * height, 0);
+    int maxX = minX + width - 1;
+    int maxY = minY + height - 1;
+    for (int by = FloorDiv(minY, BucketCells); by <= FloorDiv(maxY, BucketCells); by++) {
+        for (int bx = FloorDiv(minX, BucketCells); bx <= FloorDiv(maxX, BucketCells); bx++) {
+            auto bucket = FBuckets.find(CellKey(bx, by));
+            if (bucket == FBuckets.end()) continue;
+
+            // Корпус, лежащий в нескольких корзинах, размечается по частям без повторов
+            int left = std::max(minX, bx * BucketCells);
+            int top = std::max(minY, by * BucketCells);
+            int right = std::min(maxX, bx * BucketCells + BucketCells - 1);
+            int bottom = std::min(maxY, by * BucketCells + BucketCells - 1);
+
+            for (int index : bucket->second) {
+                const TRect& cells = FObstacles[index];
+                for (int y = std::max(top, (int)cells.Top); y <= std::min(bottom, (int)cells.Bottom); y++) {
+                    unsigned char* row = &blocked[(size_t)(y - minY) * width];
+                    for (int x = std::max(left, (int)cells.Left); x <= std::min(right, (int)cells.Right); x++) {
+                        row[x - minX] = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    int startCell = (startY - minY) * width + (startX - minX);
+    int goalCell = (endY - minY) * width + (endX - minX);
+    blocked[startCell] = 0;
+    blocked[goalCell] = 0;
+
+    // Провод входит в конечный вывод навстречу направлению выхода из него
+    int goalDir = endDir ^ 1;
+
+    // Манхэттенское расстояние плюс неизбежный изгиб, если клетка не на одной линии с целью
+    auto heuristic = [&](int Cell) {
+        int dx = std::abs(Cell % width - (endX - minX));
+        int dy = std::abs(Cell / width - (endY - minY));
+        return ((dx + dy) * StepCost + (dx && dy ? BendCost : 0)) * HeuristicWeightNum / HeuristicWeightDen;
+    };
+
+    // Состояние - клетка и направление прихода в нее, чтобы считать изгибы
+    std::vector<int> cost((size_t)width * height * 4, INT_MAX);
+    std::vector<int> parent((size_t)width * height * 4, -1);
+    std::vector<unsigned char> closed((size_t)width * height * 4, 0);
+
+    // При равной оценке первым раскрывается состояние, ближе подошедшее к цели
+    struct TOpenItem {
+        int F;
+        int G;
+        int State;
+        bool operator>(const TOpenItem& Other) const {
+            return F != Other.F ? F > Other.F : G < Other.G;
+        }
+    };
+    std::priority_queue<TOpenItem, std::vector<TOpenItem>, std::greater<TOpenItem>> open;
+
+    int startState = startCell * 4 + startDir;
+    cost[startState] = 0;
+    open.push(TOpenItem{ heuristic(startCell), 0, startState });
+
+    int found = startCell == goalCell ? startState : -1;
+    int expanded = 0;
+
+    while (found < 0 && !open.empty()) {
+        TOpenItem item = open.top();
+        open.pop();
+
+        int state = item.State;
+        int cell = state >> 2;
+        int dir = state & 3;
+        int g = cost[state];
+        if (item.G != g || closed[state]) continue; // устаревшая запись
+        closed[state] = 1;
+
+        if (cell == goalCell) {
+            found = state;
+            break;
+        }
+        if (++expanded > MaxExpanded) return false;
+
+        int x = cell % width;
+        int y = cell / width;
+        for (int next = 0; next < 4; next++) {
+            if (next == (dir ^ 1)) continue;
+
+            int nx = x + DirX[next];
+            int ny = y + DirY[next];
+            if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+
+            int nextCell = ny * width + nx;
+            if (blocked[nextCell]) continue;
+
+            int step = StepCost;
+            if (next != dir) step += BendCost;
+            if (nextCell == goalCell && next != goalDir) step += BendCost;
+
+            // Отвод к конечному выводу общий для всех проводов, подходящих к нему
+            auto usage = nextCell == goalCell ? FUsage.end() : FUsage.find(CellKey(nx + minX, ny + minY));
+            if (usage != FUsage.end()) {
+                bool horizontal = next < 2;
+                unsigned along = horizontal ? usage->second.Horizontal : usage->second.Vertical;
+                unsigned across = horizontal ? usage->second.Vertical : usage->second.Horizontal;
+                if (along) step += OverlapCost;
+                if (across) step += CrossCost;
+            }
+
+            int nextState = nextCell * 4 + next;
+            if (!closed[nextState] && g + step < cost[nextState]) {
+                cost[nextState] = g + step;
+                parent[nextState] = state;
+                open.push(TOpenItem{ g + step + heuristic(nextCell), g + step, nextState });
+            }
+        }
+    }
+
+    if (found < 0) return false;
+
+    std::vector<int> cells;
+    for (int state = found; state >= 0; state = parent[state]) {
+        cells.push_back(state >> 2);
+    }
+    std::reverse(cells.begin(), cells.end());
+
+    // Короткие отводы соединяют вывод с узлом сетки, промежуточные узлы прямых участков опускаются
+    Path.clear();
+    AppendPoint(Path, Start);
+    AppendPoint(Path, TPoint(startX * GridSize, Start.Y));
+    for (int cell : cells) {
+        AppendPoint(Path, TPoint((cell % width + minX) * GridSize, (cell / width + minY) * GridSize));
+    }
+    AppendPoint(Path, TPoint(endX * GridSize, End.Y));
+    AppendPoint(Path, End);
+
+    return Path.size() >= 2;
+}
@@ -0,0 +1,50 @@
+#ifndef GridRouterH
+#define GridRouterH
+
+#include <System.Types.hpp>
+#include <vector>
+#include <unordered_map>
+
+// Трассировка A* по сетке привязки в обход корпусов элементов. Стоимость
+// маршрута складывается из длины, числа изгибов и пересечений с уже
+// проложенными проводами
+class TGridRouter {
+public:
+    static const int GridSize = 20;
+
+private:
+    // Корпуса хранятся как диапазоны занятых клеток и раскладываются по корзинам
+    static const int BucketCells = 8;
+    std::vector<TRect> FObstacles;
+    std::unordered_map<long long, std::vector<int>> FBuckets;
+
+    // Сколько проводов проходит через клетку вдоль и поперек
+    struct TCellUsage {
+        unsigned short Horizontal;
+        unsigned short Vertical;
+    };
+    std::unordered_map<long long, TCellUsage> FUsage;
+
+    static long long CellKey(int X, int Y) {
+        return ((long long)X << 32) | (unsigned)Y;
+    }
+
+    void UpdateUsage(const std::vector<TPoint>& Path, int Delta);
+    void GetPortExit(const TPoint& Port, const TRect& Body, const TPoint& Other,
+                     int& CellX, int& CellY, int& Dir) const;
+
+public:
+    void SetObstacles(const std::vector<TRect>& Bodies);
+
+    // Занятость учитывается только для горизонтальных и вертикальных сегментов
+    void AddWire(const std::vector<TPoint>& Path) { UpdateUsage(Path, 1); }
+    void RemoveWire(const std::vector<TPoint>& Path) { UpdateUsage(Path, -1); }
+    void ClearWires() { FUsage.clear(); }
+
+    // Провод выходит из вывода горизонтально наружу корпуса. false - путь не найден
+    // в окне поиска, тогда маршрут строится упрощенно
+    bool FindPath(const TPoint& Start, const TRect& StartBody, const TPoint& End, const TRect& EndBody,
+                  std::vector<TPoint>& Path) const;
+};
+
+#endif
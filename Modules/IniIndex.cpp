@@ -0,0 +1,302 @@
+#include "IniIndex.h"
+#include <cstdio>
+#include <cstring>
+#include <climits>
+
+#ifndef _WIN32
+#include "NarrowPath.h"
+#endif
+
+#pragma package(smart_init)
+
+namespace {
+    char FoldCase(char C) {
+        return C >= 'A' && C <= 'Z' ? (char)(C - 'A' + 'a') : C;
+    }
+
+    bool IsBlank(char C) {
+        return C == ' ' || C == '\t' || C == '\r';
+    }
+
+    TIniIndex::TSpan MakeSpan(const char* Begin, const char* End) {
+        while (Begin < End && IsBlank(*Begin)) Begin++;
+        while (End > Begin && IsBlank(End[-1])) End--;
+        TIniIndex::TSpan span = { Begin, (size_t)(End - Begin) };
+        return span;
+    }
+
+    TIniIndex::TSpan MakeSpan(const char* Text) {
+        TIniIndex::TSpan span = { Text, strlen(Text) };
+        return span;
+    }
+
+    void AppendUtf8(std::string& Text, unsigned Code) {
+        if (Code < 0x80) {
+            Text += (char)Code;
+        } else if (Code < 0x800) {
+            Text += (char)(0xC0 | (Code >> 6));
+            Text += (char)(0x80 | (Code & 0x3F));
+        } else if (Code < 0x10000) {
+            Text += (char)(0xE0 | (Code >> 12));
+            Text += (char)(0x80 | ((Code >> 6) & 0x3F));
+            Text += (char)(0x80 | (Code & 0x3F));
+        } else {
+            Text += (char)(0xF0 | (Code >> 18));
+            Text += (char)(0x80 | ((Code >> 12) & 0x3F));
+            Text += (char)(0x80 | ((Code >> 6) & 0x3F));
+            Text += (char)(0x80 | (Code & 0x3F));
+        }
+    }
+
+    // UTF-16LE без BOM в UTF-8; непарные суррогаты заменяются на U+FFFD
+    std::string Utf16ToUtf8(const std::string& Data, size_t Offset) {
+        std::string text;
+        text.reserve(Data.size() / 2);
+
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(Data.data());
+        size_t count = (Data.size() - Offset) / 2;
+        for (size_t i = 0; i < count; i++) {
+            unsigned code = bytes[Offset + i * 2] | (bytes[Offset + i * 2 + 1] << 8);
+            if (code >= 0xD800 && code < 0xDC00 && i + 1 < count) {
+                unsigned low = bytes[Offset + i * 2 + 2] | (bytes[Offset + i * 2 + 3] << 8);
+                if (low >= 0xDC00 && low < 0xE000) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    i++;
+                } else {
+                    code = 0xFFFD;
+                }
+            } else if (code >= 0xD800 && code < 0xE000) {
+                code = 0xFFFD;
+            }
+            AppendUtf8(text, code);
+        }
+        return text;
+    }
+}
+
+size_t TIniIndex::TSpanHash::operator()(const TSpan& Span) const {
+    // FNV-1a по символам, приведенным к нижнему регистру
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < Span.Length; i++) {
+        hash = (hash ^ (unsigned char)FoldCase(Span.Data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+bool TIniIndex::TSpanEqual::operator()(const TSpan& A, const TSpan& B) const {
+    if (A.Length != B.Length) return false;
+    for (size_t i = 0; i < A.Length; i++) {
+        if (FoldCase(A.Data[i]) != FoldCase(B.Data[i])) return false;
+    }
+    return true;
+}
+
+TIniIndex::TIniIndex() : FUtf8(false) {
+}
+
+void TIniIndex::Clear() {
+    FBuffer.clear();
+    FUtf8 = false;
+    FEntries.clear();
+    FSections.clear();
+    FSectionIndex.clear();
+}
+
+void TIniIndex::Assign(std::string&& Data) {
+    Clear();
+
+    if (Data.size() >= 2 && (unsigned char)Data[0] == 0xFF && (unsigned char)Data[1] == 0xFE) {
+        FBuffer = Utf16ToUtf8(Data, 2);
+        FUtf8 = true;
+    } else if (Data.size() >= 3 && (unsigned char)Data[0] == 0xEF &&
+               (unsigned char)Data[1] == 0xBB && (unsigned char)Data[2] == 0xBF) {
+        FBuffer = Data.substr(3);
+        FUtf8 = true;
+    } else {
+        FBuffer = std::move(Data);
+    }
+
+    Parse();
+}
+
+bool TIniIndex::LoadFromFile(const wchar_t* FileName) {
+    Clear();
+
+#ifdef _WIN32
+    FILE* file = _wfopen(FileName, L"rb");
+#else
+    std::string path;
+    if (!NarrowPath(FileName, path)) return false;
+    FILE* file = fopen(path.c_str(), "rb");
+#endif
+    if (!file) return false;
+
+    std::string data;
+    char block[65536];
+    size_t read;
+    while ((read = fread(block, 1, sizeof(block), file)) > 0) {
+        data.append(block, read);
+    }
+    bool ok = !ferror(file);
+    fclose(file);
+
+    if (ok) Assign(std::move(data));
+    return ok;
+}
+
+void TIniIndex::Parse() {
+    // Строки до первой секции и повторные секции пропускаются, поэтому ключи
+    // каждой секции лежат в FEntries подряд
+    bool inSection = false;
+    const char* text = FBuffer.data();
+    const char* end = text + FBuffer.size();
+
+    while (text < end) {
+        const char* lineEnd = static_cast<const char*>(memchr(text, '\n', end - text));
+        if (!lineEnd) lineEnd = end;
+
+        TSpan line = MakeSpan(text, lineEnd);
+        text = lineEnd + 1;
+        if (line.Length == 0 || line.Data[0] == ';') continue;
+
+        if (line.Data[0] == '[') {
+            const char* close = static_cast<const char*>(memchr(line.Data, ']', line.Length));
+            TSpan name = MakeSpan(line.Data + 1, close ? close : line.Data + line.Length);
+
+            inSection = FSectionIndex.find(name) == FSectionIndex.end();
+            if (inSection) {
+                TSection section = { name, FEntries.size(), 0 };
+                FSectionIndex[name] = FSections.size();
+                FSections.push_back(section);
+            }
+            continue;
+        }
+
+        if (!inSection) continue;
+
+        const char* equals = static_cast<const char*>(memchr(line.Data, '=', line.Length));
+        if (!equals) continue;
+
+        TEntry entry;
+        entry.Key = MakeSpan(line.Data, equals);
+        entry.Value = MakeSpan(equals + 1, line.Data + line.Length);
+
+        // Значение в парных кавычках отдается без них
+        if (entry.Value.Length >= 2 && (entry.Value.Data[0] == '"' || entry.Value.Data[0] == '\'') &&
+            entry.Value.Data[entry.Value.Length - 1] == entry.Value.Data[0]) {
+            entry.Value.Data++;
+            entry.Value.Length -= 2;
+        }
+
+        FEntries.push_back(entry);
+        FSections.back().EntryCount++;
+    }
+}
+
+int TIniIndex::FindSection(const char* Section) const {
+    auto it = FSectionIndex.find(MakeSpan(Section));
+    return it == FSectionIndex.end() ? -1 : (int)it->second;
+}
+
+const TIniIndex::TEntry* TIniIndex::FindEntry(const char* Section, const char* Key) const {
+    int section = FindSection(Section);
+    if (section < 0) return nullptr;
+
+    // Ключей в секции немного, первый из повторяющихся ключей главный
+    TSpan key = MakeSpan(Key);
+    TSpanEqual equal;
+    const TSection& s = FSections[section];
+    for (size_t i = s.FirstEntry; i < s.FirstEntry + s.EntryCount; i++) {
+        if (equal(FEntries[i].Key, key)) return &FEntries[i];
+    }
+    return nullptr;
+}
+
+bool TIniIndex::Find(const char* Section, const char* Key, TSpan& Value) const {
+    const TEntry* entry = FindEntry(Section, Key);
+    if (!entry) return false;
+    Value = entry->Value;
+    return true;
+}
+
+std::string TIniIndex::ReadString(const char* Section, const char* Key, const std::string& Default) const {
+    TSpan value;
+    return Find(Section, Key, value) ? std::string(value.Data, value.Length) : Default;
+}
+
+int TIniIndex::ReadInteger(const char* Section, const char* Key, int Default) const {
+    TSpan value;
+    int result;
+    return Find(Section, Key, value) && ParseInteger(value, result) ? result : Default;
+}
+
+double TIniIndex::ReadFloat(const char* Section, const char* Key, double Default) const {
+    TSpan value;
+    double result;
+    return Find(Section, Key, value) && ParseFloat(value, result) ? result : Default;
+}
+
+bool TIniIndex::ReadBool(const char* Section, const char* Key, bool Default) const {
+    TSpan value;
+    if (!Find(Section, Key, value)) return Default;
+
+    TSpanEqual equal;
+    if (equal(value, MakeSpan("true"))) return true;
+    if (equal(value, MakeSpan("false"))) return false;
+
+    int result;
+    return ParseInteger(value, result) ? result != 0 : Default;
+}
+
+bool TIniIndex::ParseInteger(const TSpan& Value, int& Result) {
+    const char* p = Value.Data;
+    const char* end = p + Value.Length;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+    int base = 10;
+    if (p < end && *p == '$') {
+        base = 16;
+        p++;
+    } else if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+        base = 16;
+        p += 2;
+    }
+    if (p == end) return false;
+
+    // Шестнадцатеричные значения до $FFFFFFFF читаются как в Delphi - с переполнением
+    long long limit = base == 16 ? 0xFFFFFFFFLL : (long long)INT_MAX + 1;
+    long long value = 0;
+    for (; p < end; p++) {
+        int digit;
+        char c = FoldCase(*p);
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (base == 16 && c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else return false;
+
+        value = value * base + digit;
+        if (value > limit) return false;
+    }
+
+    if (base == 16 && value > INT_MAX) value -= 0x100000000LL;
+    if (negative) value = -value;
+    if (value > INT_MAX || value < INT_MIN) return false;
+
+    Result = (int)value;
+    return true;
+}
+
+bool TIniIndex::ParseFloat(const TSpan& Value, double& Result) {
+    char buffer[64];
+    if (Value.Length == 0 || Value.Length >= sizeof(buffer)) return false;
+
+    for (size_t i = 0; i < Value.Length; i++) {
+        buffer[i] = Value.Data[i] == ',' ? '.' : Value.Data[i];
+    }
+    buffer[Value.Length] = '\0';
+
+    char* end;
+    Result = strtod(buffer, &end);
+    return end == buffer + Value.Length;
+}
@@ -0,0 +1,85 @@
+#ifndef IniIndexH
+#define IniIndexH
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// INI-файл, разобранный за один проход: секции и ключи - ссылки на участки
+// общего буфера, секция ищется по хешу. Правила разбора повторяют
+// GetPrivateProfileString, поэтому файлы читаются одинаково на всех платформах
+class TIniIndex {
+public:
+    struct TSpan {
+        const char* Data;
+        size_t Length;
+    };
+
+private:
+    struct TEntry {
+        TSpan Key;
+        TSpan Value;
+    };
+
+    struct TSection {
+        TSpan Name;
+        size_t FirstEntry;
+        size_t EntryCount;
+    };
+
+    // Имена секций и ключей сравниваются без учета регистра
+    struct TSpanHash {
+        size_t operator()(const TSpan& Span) const;
+    };
+    struct TSpanEqual {
+        bool operator()(const TSpan& A, const TSpan& B) const;
+    };
+
+    std::string FBuffer;
+    bool FUtf8;
+    std::vector<TEntry> FEntries;
+    std::vector<TSection> FSections;
+    std::unordered_map<TSpan, size_t, TSpanHash, TSpanEqual> FSectionIndex;
+
+    void Parse();
+    const TEntry* FindEntry(const char* Section, const char* Key) const;
+
+    TIniIndex(const TIniIndex&);
+    TIniIndex& operator=(const TIniIndex&);
+
+public:
+    TIniIndex();
+
+    // Текст в UTF-16 с BOM перекодируется в UTF-8, остальное хранится как есть
+    void Assign(std::string&& Data);
+    bool LoadFromFile(const wchar_t* FileName);
+    void Clear();
+
+    // true - текст в UTF-8 (был BOM), иначе в однобайтовой кодировке системы
+    bool IsUtf8() const { return FUtf8; }
+
+    size_t GetSectionCount() const { return FSections.size(); }
+    TSpan GetSectionName(size_t Section) const { return FSections[Section].Name; }
+    // Индекс секции или -1; при повторе имени действует первая секция
+    int FindSection(const char* Section) const;
+
+    size_t GetKeyCount(size_t Section) const { return FSections[Section].EntryCount; }
+    TSpan GetKey(size_t Section, size_t Key) const { return FEntries[FSections[Section].FirstEntry + Key].Key; }
+    TSpan GetValue(size_t Section, size_t Key) const { return FEntries[FSections[Section].FirstEntry + Key].Value; }
+
+    // Значение ключа без копирования; false - ключа нет
+    bool Find(const char* Section, const char* Key, TSpan& Value) const;
+
+    std::string ReadString(const char* Section, const char* Key, const std::string& Default) const;
+    // Десятичные и шестнадцатеричные ($FF, 0xFF) числа, как StrToIntDef
+    int ReadInteger(const char* Section, const char* Key, int Default) const;
+    // Разделителем дробной части считаются и точка, и запятая
+    double ReadFloat(const char* Section, const char* Key, double Default) const;
+    bool ReadBool(const char* Section, const char* Key, bool Default) const;
+
+    static bool ParseInteger(const TSpan& Value, int& Result);
+    static bool ParseFloat(const TSpan& Value, double& Result);
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include "LabelAtlas.h"
+#include <algorithm>
+#include <math.h>
+
+#pragma package(smart_init)
+
+size_t TLabelAtlas::TKeyHash::operator()(const TKey& Key) const {
+    size_t hash = static_cast<size_t>(Key.FontHeight) * 31 + Key.FontStyle;
+    hash = hash * 31 + static_cast<size_t>(Key.FontColor);
+    hash = hash * 31 + static_cast<size_t>(Key.Background);
+    for (int i = 1; i <= Key.Text.Length(); i++) {
+        hash = hash * 31 + Key.Text[i];
+    }
+    return hash;
+}
+
+TLabelAtlas::TLabelAtlas() : FMeasure(new TBitmap()), FZoom(0.0) {
+    FMeasure->SetSize(1, 1);
+}
+
+void TLabelAtlas::Clear() {
+    FEntries.clear();
+    FPages.clear();
+}
+
+bool TLabelAtlas::Allocate(int Width, int Height, int& Page, TRect& Source) {
+    if (Width > PageSize || Height > PageSize) return false;
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (!FPages.empty()) {
+            TPage& page = FPages.back();
+
+            // Не помещается в текущую полку - начинаем новую
+            if (page.ShelfX + Width > PageSize) {
+                page.ShelfY += page.ShelfHeight;
+                page.ShelfX = 0;
+                page.ShelfHeight = 0;
+            }
+
+            if (page.ShelfY + Height <= PageSize) {
+                Page = static_cast<int>(FPages.size()) - 1;
+                Source = TRect(page.ShelfX, page.ShelfY, page.ShelfX + Width, page.ShelfY + Height);
+                page.ShelfX += Width;
+                page.ShelfHeight = std::max(page.ShelfHeight, Height);
+                return true;
+            }
+        }
+
+        // Атлас заполнен - начинаем заново, в кэш попадут актуальные подписи
+        if (static_cast<int>(FPages.size()) >= MaxPages) {
+            Clear();
+        }
+
+        TPage page;
+        page.Bitmap.reset(new TBitmap());
+        page.Bitmap->PixelFormat = pf24bit;
+        page.Bitmap->SetSize(PageSize, PageSize);
+        page.ShelfX = 0;
+        page.ShelfY = 0;
+        page.ShelfHeight = 0;
+        FPages.push_back(std::move(page));
+    }
+
+    return false;
+}
+
+bool TLabelAtlas::AddEntry(TCanvas* Canvas, const TKey& Key, TEntry& Entry) {
+    // Шрифт страницы - шрифт холста в масштабе вида
+    std::unique_ptr<TFont> font(new TFont());
+    font->Assign(Canvas->Font);
+    font->Height = static_cast<int>(floor(Canvas->Font->Height * FZoom + 0.5));
+    if (font->Height == 0) return false;
+
+    FMeasure->Canvas->Font->Assign(font.get());
+    TSize size = FMeasure->Canvas->TextExtent(Key.Text);
+    if (size.cx <= 0 || size.cy <= 0) return false;
+
+    if (!Allocate(size.cx, size.cy, Entry.Page, Entry.Source)) return false;
+
+    TCanvas* target = FPages[Entry.Page].Bitmap->Canvas;
+    target->Font->Assign(font.get());
+    target->Brush->Style = bsSolid;
+    target->Brush->Color = Key.Background;
+    target->TextRect(Entry.Source, Entry.Source.Left, Entry.Source.Top, Key.Text);
+    return true;
+}
+
+bool TLabelAtlas::Draw(TCanvas* Canvas, int X, int Y, const wchar_t* Text) {
+    if (!Text || !*Text) return true;
+
+    // Прозрачный фон требует смешивания - такие подписи выводятся как есть
+    if (Canvas->Brush->Style != bsSolid) return false;
+
+    HDC dc = Canvas->Handle;
+    bool advanced = GetGraphicsMode(dc) == GM_ADVANCED;
+    XFORM transform = { 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+    if (advanced) {
+        GetWorldTransform(dc, &transform);
+    }
+    // Повернутый текст не кэшируем
+    if (transform.eM12 != 0.0f || transform.eM21 != 0.0f || transform.eM11 != transform.eM22) return false;
+
+    if (transform.eM11 != FZoom || Canvas->Font->Name != FFontName) {
+        Clear();
+        FZoom = transform.eM11;
+        FFontName = Canvas->Font->Name;
+    }
+
+    TKey key;
+    key.Text = Text;
+    key.FontHeight = Canvas->Font->Height;
+    key.FontStyle = 0;
+    if (Canvas->Font->Style.Contains(fsBold)) key.FontStyle |= 1;
+    if (Canvas->Font->Style.Contains(fsItalic)) key.FontStyle |= 2;
+    if (Canvas->Font->Style.Contains(fsUnderline)) key.FontStyle |= 4;
+    if (Canvas->Font->Style.Contains(fsStrikeOut)) key.FontStyle |= 8;
+    key.FontColor = Canvas->Font->Color;
+    key.Background = Canvas->Brush->Color;
+
+    auto it = FEntries.find(key);
+    if (it == FEntries.end()) {
+        TEntry entry;
+        if (!AddEntry(Canvas, key, entry)) return false;
+        it = FEntries.insert(std::make_pair(key, entry)).first;
+    }
+
+    const TEntry& entry = it->second;
+    TCanvas* page = FPages[entry.Page].Bitmap->Canvas;
+
+    // Копирование идет без преобразования, точку вывода переводим сами
+    int x = static_cast<int>(floor(X * transform.eM11 + transform.eDx + 0.5));
+    int y = static_cast<int>(floor(Y * transform.eM22 + transform.eDy + 0.5));
+    if (advanced) {
+        ModifyWorldTransform(dc, nullptr, MWT_IDENTITY);
+    }
+    BitBlt(dc, x, y, entry.Source.Width(), entry.Source.Height(),
+           page->Handle, entry.Source.Left, entry.Source.Top, SRCCOPY);
+    if (advanced) {
+        SetWorldTransform(dc, &transform);
+    }
+    return true;
+}
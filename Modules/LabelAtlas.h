@@ -0,0 +1,68 @@
+#ifndef LabelAtlasH
+#define LabelAtlasH
+
+#include <Vcl.Graphics.hpp>
+#include <windows.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Кэш отрисованных подписей: строка растеризуется один раз для данного
+// шрифта и масштаба, дальше выводится копированием из страницы атласа.
+// Смена масштаба или гарнитуры сбрасывает атлас
+class TLabelAtlas {
+private:
+    static const int PageSize = 1024;
+    static const int MaxPages = 4;
+
+    struct TKey {
+        String Text;
+        int FontHeight;
+        unsigned FontStyle;
+        TColor FontColor;
+        TColor Background;
+
+        bool operator==(const TKey& Other) const {
+            return FontHeight == Other.FontHeight && FontStyle == Other.FontStyle &&
+                   FontColor == Other.FontColor && Background == Other.Background && Text == Other.Text;
+        }
+    };
+
+    struct TKeyHash {
+        size_t operator()(const TKey& Key) const;
+    };
+
+    struct TEntry {
+        int Page;
+        TRect Source;
+    };
+
+    // Страница заполняется полками: строки подписей одной высоты идут подряд
+    struct TPage {
+        std::unique_ptr<TBitmap> Bitmap;
+        int ShelfX;
+        int ShelfY;
+        int ShelfHeight;
+    };
+
+    std::unordered_map<TKey, TEntry, TKeyHash> FEntries;
+    std::vector<TPage> FPages;
+    // Холст для измерения строк
+    std::unique_ptr<TBitmap> FMeasure;
+    double FZoom;
+    String FFontName;
+
+    bool Allocate(int Width, int Height, int& Page, TRect& Source);
+    bool AddEntry(TCanvas* Canvas, const TKey& Key, TEntry& Entry);
+
+public:
+    TLabelAtlas();
+
+    void Clear();
+
+    // Вывод подписи в точке X, Y с учетом текущего мирового преобразования DC.
+    // false - подпись не может быть взята из атласа, нужен обычный TextOut
+    bool Draw(TCanvas* Canvas, int X, int Y, const wchar_t* Text);
+};
+
+#endif
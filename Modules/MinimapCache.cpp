@@ -0,0 +1,236 @@
+#include "MinimapCache.h"
+#include "GdiRenderTarget.h"
+#include <algorithm>
+
+#pragma package(smart_init)
+
+// Округление вниз для отрицательных координат тоже
+static int FloorToStep(int Value, int Step) {
+    return (Value >= 0 ? Value / Step : -((-Value + Step - 1) / Step)) * Step;
+}
+
+static TRect UnionRect(const TRect& A, const TRect& B) {
+    return TRect(std::min(A.Left, B.Left), std::min(A.Top, B.Top),
+                 std::max(A.Right, B.Right), std::max(A.Bottom, B.Bottom));
+}
+
+TMinimapCache::TMinimapCache()
+    : FBitmap(new TBitmap()), FBounds(0, 0, 0, 0), FValid(false), FElementCount(0), FRebuild(false),
+      FRoutesVersion(0), FStamp(0) {
+    FBitmap->PixelFormat = pf24bit;
+}
+
+void TMinimapCache::Clear() {
+    FValid = false;
+    FWires.clear();
+    FDirty.clear();
+}
+
+void TMinimapCache::AddDirty(const TRect& Rect) {
+    // Запас на толщину линий после уменьшения
+    TRect dirty = Rect;
+    dirty.Inflate(Scale, Scale);
+    FDirty.push_back(dirty);
+
+    if (FDirty.size() > MaxDirtyRects) {
+        TRect merged = FDirty[0];
+        for (const TRect& rect : FDirty) {
+            merged = UnionRect(merged, rect);
+        }
+        FDirty.assign(1, merged);
+    }
+}
+
+void TMinimapCache::AddElement(const TRect& Bounds) {
+    FElementCount++;
+    if (FValid) AddDirty(Bounds);
+}
+
+void TMinimapCache::RemoveElement(const TRect& Bounds) {
+    if (FElementCount > 0) FElementCount--;
+    if (FValid) AddDirty(Bounds);
+}
+
+void TMinimapCache::MoveElement(const TRect& OldBounds, const TRect& NewBounds) {
+    if (!FValid) return;
+    AddDirty(OldBounds);
+    AddDirty(NewBounds);
+}
+
+bool TMinimapCache::Update(const std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                           const std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections,
+                           const TWireRouteCache& Routes) {
+    bool synced = FValid && !FRebuild && FElementCount == Elements.size();
+    if (synced && FDirty.empty() && FRoutesVersion == Routes.GetVersion()) return false;
+
+    // Трассировка - забота кадра; карта берет то, что уже рассчитано
+    std::vector<const TWireRoute*> routes(Connections.size(), nullptr);
+    for (size_t i = 0; i < Connections.size(); i++) {
+        routes[i] = Routes.FindRoute(Connections[i].first, Connections[i].second);
+    }
+
+    bool empty = true;
+    TRect bounds(0, 0, 0, 0);
+    for (const auto& element : Elements) {
+        bounds = empty ? element->Bounds : UnionRect(bounds, element->Bounds);
+        empty = false;
+    }
+    for (const TWireRoute* route : routes) {
+        if (!route || route->Pending) continue;
+        bounds = empty ? route->Bounds : UnionRect(bounds, route->Bounds);
+        empty = false;
+    }
+
+    FElementCount = Elements.size();
+    FRebuild = false;
+    if (empty) {
+        bool changed = FValid;
+        Clear();
+        FRoutesVersion = Routes.GetVersion();
+        return changed;
+    }
+
+    TRect rounded(FloorToStep(bounds.Left - Scale, BoundsStep), FloorToStep(bounds.Top - Scale, BoundsStep),
+                  FloorToStep(bounds.Right + Scale, BoundsStep) + BoundsStep,
+                  FloorToStep(bounds.Bottom + Scale, BoundsStep) + BoundsStep);
+
+    FStamp++;
+    if (!synced || rounded != FBounds) {
+        // Схема вышла за габариты карты или правка прошла мимо карты - перестраиваем целиком
+        Clear();
+        FBounds = rounded;
+        FBitmap->SetSize(FBounds.Width() / Scale, FBounds.Height() / Scale);
+        FDirty.push_back(FBounds);
+        FValid = true;
+
+        for (size_t i = 0; i < routes.size(); i++) {
+            if (!routes[i] || routes[i]->Pending) continue;
+            TMinimapWire wire = { routes[i]->Bounds, routes[i]->Version, FStamp };
+            FWires[TWireKey(Connections[i].first, Connections[i].second)] = wire;
+        }
+    } else if (FRoutesVersion != Routes.GetVersion()) {
+        // Сверка маршрутов с прошлым снимком по версиям: добавленные, удаленные и перестроенные
+        for (size_t i = 0; i < Connections.size(); i++) {
+            const TWireRoute* route = routes[i];
+            if (!route) continue;
+
+            TWireKey key(Connections[i].first, Connections[i].second);
+            auto it = FWires.find(key);
+            if (route->Pending) {
+                // Отложенный маршрут сохраняет прежний снимок до окончательного
+                if (it != FWires.end()) it->second.Seen = FStamp;
+                continue;
+            }
+
+            if (it == FWires.end()) {
+                AddDirty(route->Bounds);
+                TMinimapWire wire = { route->Bounds, route->Version, FStamp };
+                FWires[key] = wire;
+            } else {
+                if (it->second.Version != route->Version) {
+                    AddDirty(it->second.Bounds);
+                    AddDirty(route->Bounds);
+                    it->second.Bounds = route->Bounds;
+                    it->second.Version = route->Version;
+                }
+                it->second.Seen = FStamp;
+            }
+        }
+        for (auto it = FWires.begin(); it != FWires.end(); ) {
+            if (it->second.Seen != FStamp) {
+                AddDirty(it->second.Bounds);
+                it = FWires.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    FRoutesVersion = Routes.GetVersion();
+
+    if (FDirty.empty()) return false;
+
+    for (const TRect& area : FDirty) {
+        Redraw(area, Elements, routes);
+    }
+    FDirty.clear();
+    return true;
+}
+
+void TMinimapCache::Redraw(const TRect& Area, const std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                           const std::vector<const TWireRoute*>& Routes) {
+    TCanvas* canvas = FBitmap->Canvas;
+
+    TRect device((Area.Left - FBounds.Left) / Scale, (Area.Top - FBounds.Top) / Scale,
+                 (Area.Right - FBounds.Left + Scale - 1) / Scale, (Area.Bottom - FBounds.Top + Scale - 1) / Scale);
+    if (!IntersectRect(device, device, TRect(0, 0, FBitmap->Width, FBitmap->Height))) return;
+
+    IntersectClipRect(canvas->Handle, device.Left, device.Top, device.Right, device.Bottom);
+    canvas->Brush->Color = clWhite;
+    canvas->FillRect(device);
+
+    {
+        TGdiRenderTarget target(canvas);
+        target.SetTransform(1.0 / Scale, FBounds.Left / Scale, FBounds.Top / Scale);
+
+        // Провода под элементами, каждый слой - одним пакетом
+        for (const TWireRoute* route : Routes) {
+            if (!route || route->Pending || route->Path.size() < 2 || !route->Bounds.IntersectsWith(Area)) continue;
+            FList.AddPolyline(TPenState(clSilver, 1), route->Path.data(), static_cast<int>(route->Path.size()));
+        }
+        FList.Submit(&target);
+        FList.Clear();
+
+        for (const auto& element : Elements) {
+            if (!element->Bounds.IntersectsWith(Area)) continue;
+            FList.AddFillRect(clGray, element->Bounds);
+        }
+        FList.Submit(&target);
+        FList.Clear();
+    }
+
+    SelectClipRgn(canvas->Handle, nullptr);
+}
+
+TRect TMinimapCache::GetDisplayRect(const TRect& Dest) const {
+    if (!FValid || FBitmap->Width == 0 || FBitmap->Height == 0) return TRect(Dest.Left, Dest.Top, Dest.Left, Dest.Top);
+
+    double scale = std::min(static_cast<double>(Dest.Width()) / FBitmap->Width,
+                            static_cast<double>(Dest.Height()) / FBitmap->Height);
+    int width = static_cast<int>(FBitmap->Width * scale);
+    int height = static_cast<int>(FBitmap->Height * scale);
+    int left = Dest.Left + (Dest.Width() - width) / 2;
+    int top = Dest.Top + (Dest.Height() - height) / 2;
+    return TRect(left, top, left + width, top + height);
+}
+
+void TMinimapCache::Draw(TCanvas* Canvas, const TRect& Dest) const {
+    if (!FValid) return;
+
+    TRect display = GetDisplayRect(Dest);
+    HDC dc = Canvas->Handle;
+    int oldMode = SetStretchBltMode(dc, HALFTONE);
+    SetBrushOrgEx(dc, 0, 0, nullptr);
+    StretchBlt(dc, display.Left, display.Top, display.Width(), display.Height(),
+               FBitmap->Canvas->Handle, 0, 0, FBitmap->Width, FBitmap->Height, SRCCOPY);
+    SetStretchBltMode(dc, oldMode);
+}
+
+TPoint TMinimapCache::DisplayToLogical(const TRect& Dest, const TPoint& Point) const {
+    TRect display = GetDisplayRect(Dest);
+    if (display.Width() == 0 || display.Height() == 0) return TPoint(FBounds.Left, FBounds.Top);
+
+    return TPoint(FBounds.Left + static_cast<int>(static_cast<double>(Point.X - display.Left) * FBounds.Width() / display.Width()),
+                  FBounds.Top + static_cast<int>(static_cast<double>(Point.Y - display.Top) * FBounds.Height() / display.Height()));
+}
+
+TRect TMinimapCache::LogicalToDisplay(const TRect& Dest, const TRect& Logical) const {
+    TRect display = GetDisplayRect(Dest);
+    if (FBounds.Width() == 0 || FBounds.Height() == 0) return display;
+
+    double scaleX = static_cast<double>(display.Width()) / FBounds.Width();
+    double scaleY = static_cast<double>(display.Height()) / FBounds.Height();
+    return TRect(display.Left + static_cast<int>((Logical.Left - FBounds.Left) * scaleX),
+                 display.Top + static_cast<int>((Logical.Top - FBounds.Top) * scaleY),
+                 display.Left + static_cast<int>((Logical.Right - FBounds.Left) * scaleX),
+                 display.Top + static_cast<int>((Logical.Bottom - FBounds.Top) * scaleY));
+}
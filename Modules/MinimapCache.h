@@ -0,0 +1,77 @@
+#ifndef MinimapCacheH
+#define MinimapCacheH
+
+#include "CircuitElement.h"
+#include "WireRouter.h"
+#include "DisplayList.h"
+#include <Vcl.Graphics.hpp>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Обзорная карта схемы: уменьшенный растр, в котором перерисовываются
+// только области с изменившимися элементами и маршрутами. Карта показывает
+// структуру схемы - Draw() элементов для нее не вызывается
+class TMinimapCache {
+private:
+    // Логических единиц на пиксель карты
+    static const int Scale = 8;
+    // Габариты карты округляются до блока - мелкие правки не вызывают перестройку
+    static const int BoundsStep = 512;
+    // При большом числе измененных областей они объединяются в одну
+    static const int MaxDirtyRects = 16;
+
+    struct TMinimapWire {
+        TRect Bounds;
+        unsigned Version;
+        unsigned Seen;
+    };
+
+    std::unique_ptr<TBitmap> FBitmap;
+    TRect FBounds;
+    bool FValid;
+
+    // Элементы карта не сверяет: их правки отмечаются вызовами AddElement и др.
+    // Число элементов - страховка для правок, которые карту не известили
+    size_t FElementCount;
+    bool FRebuild;
+    // Маршруты на момент последней сверки, сравниваются по номерам версий
+    std::unordered_map<TWireKey, TMinimapWire, TWireKeyHash> FWires;
+    unsigned FRoutesVersion;
+    unsigned FStamp;
+    std::vector<TRect> FDirty;
+    TDisplayList FList;
+
+    void AddDirty(const TRect& Rect);
+    void Redraw(const TRect& Area, const std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                const std::vector<const TWireRoute*>& Routes);
+
+public:
+    TMinimapCache();
+
+    // Без правок и перестроенных маршрутов сверка стоит O(1); иначе
+    // перерисовываются только изменившиеся области. Маршруты берутся готовыми
+    // из кэша вкладки, отложенные ждут окончательной трассировки.
+    // Возвращает true, если изображение карты изменилось
+    bool Update(const std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                const std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections,
+                const TWireRouteCache& Routes);
+    void Clear();
+
+    // Точки правки элементов - те же, что у карты занятости
+    void AddElement(const TRect& Bounds);
+    void RemoveElement(const TRect& Bounds);
+    void MoveElement(const TRect& OldBounds, const TRect& NewBounds);
+    // Правка без подробностей (группировка и т.п.) - карта строится заново
+    void Invalidate() { FRebuild = true; }
+
+    bool IsEmpty() const { return !FValid; }
+
+    // Карта вписывается в Dest с сохранением пропорций
+    TRect GetDisplayRect(const TRect& Dest) const;
+    void Draw(TCanvas* Canvas, const TRect& Dest) const;
+    TPoint DisplayToLogical(const TRect& Dest, const TPoint& Point) const;
+    TRect LogicalToDisplay(const TRect& Dest, const TRect& Logical) const;
+};
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef NarrowPathH
+#define NarrowPathH
+
+#include <cstdlib>
+#include <string>
+
+// Имя файла для функций с узкими путями (fopen, open вне Windows):
+// переводится в многобайтовую кодировку текущей локали.
+// false - в имени есть символ, которого нет в этой кодировке
+inline bool NarrowPath(const wchar_t* FileName, std::string& Path) {
+    size_t length = wcstombs(nullptr, FileName, 0);
+    if (length == (size_t)-1) return false;
+    Path.assign(length, '\0');
+    wcstombs(&Path[0], FileName, length + 1);
+    return true;
+}
+
+#endif
@@ -0,0 +1,369 @@
+#include "NetlistFile.h"
+#include <cstring>
+
+#pragma package(smart_init)
+
+namespace {
+    const char NetlistMagic[] = "SETUNNET";
+
+    bool IsSpace(char C) {
+        return C == ' ' || C == '\t';
+    }
+
+    bool IsKeyChar(char C) {
+        return (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z') || (C >= '0' && C <= '9') || C == '_';
+    }
+}
+
+TNetlistWriter::TNetlistWriter(std::ostream& Stream)
+    : FStream(Stream), FDepth(0) {
+}
+
+void TNetlistWriter::BeginLine(const char* Keyword) {
+    FLine.assign(FDepth * 2, ' ');
+    FLine += Keyword;
+}
+
+void TNetlistWriter::AppendInt(int64_t Value) {
+    // Числа пишутся без локали и без промежуточных строк
+    char digits[24];
+    size_t count = 0;
+    uint64_t magnitude = Value < 0 ? (uint64_t)0 - (uint64_t)Value : (uint64_t)Value;
+    do {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (Value < 0) FLine += '-';
+    while (count) FLine += digits[--count];
+}
+
+void TNetlistWriter::AppendElement(const TNetlistElement& Element, bool WithClass) {
+    FLine += ' ';
+    AppendInt(Element.Id);
+    if (WithClass) {
+        FLine += ' ';
+        FLine += Element.ClassName;
+    }
+    FLine += ' ';
+    AppendInt(Element.Left);
+    FLine += ' ';
+    AppendInt(Element.Top);
+
+    if (Element.Width || Element.Height) {
+        FLine += " w=";
+        AppendInt(Element.Width);
+        FLine += " h=";
+        AppendInt(Element.Height);
+    }
+    if (Element.State) {
+        FLine += " state=";
+        AppendInt(Element.State);
+    }
+    for (const auto& param : Element.Params) {
+        FLine += ' ';
+        FLine += param.first;
+        FLine += '=';
+        AppendInt(param.second);
+    }
+    for (const auto& param : Element.StateParams) {
+        FLine += " state.";
+        FLine += param.first;
+        FLine += '=';
+        AppendInt(param.second);
+    }
+
+    if (Element.HasName) {
+        FLine += " name=\"";
+        for (char c : Element.Name) {
+            if (c == '"' || c == '\\') {
+                FLine += '\\';
+                FLine += c;
+            } else if (c == '\n') {
+                FLine += "\\n";
+            } else if (c != '\r') {
+                FLine += c;
+            }
+        }
+        FLine += '"';
+    }
+}
+
+void TNetlistWriter::EndLine() {
+    FLine += '\n';
+    FStream.write(FLine.data(), (std::streamsize)FLine.size());
+}
+
+void TNetlistWriter::WriteHeader(int32_t NextElementId) {
+    BeginLine(NetlistMagic);
+    FLine += ' ';
+    AppendInt(NetlistVersion);
+    EndLine();
+
+    BeginLine("next ");
+    AppendInt(NextElementId);
+    EndLine();
+}
+
+void TNetlistWriter::WriteElement(const TNetlistElement& Element) {
+    BeginLine("element");
+    AppendElement(Element, true);
+    EndLine();
+}
+
+void TNetlistWriter::BeginSubCircuit(const TNetlistElement& Element) {
+    BeginLine("subcircuit");
+    AppendElement(Element, false);
+    EndLine();
+    FDepth++;
+}
+
+void TNetlistWriter::EndSubCircuit() {
+    if (FDepth > 0) FDepth--;
+    BeginLine("end");
+    EndLine();
+}
+
+void TNetlistWriter::WriteNet(const std::vector<TNetlistPin>& Pins) {
+    BeginLine("net");
+    for (const auto& pin : Pins) {
+        FLine += ' ';
+        AppendInt(pin.Element);
+        FLine += pin.IsInput ? ".in" : ".out";
+        AppendInt(pin.Port);
+    }
+    EndLine();
+}
+
+TNetlistReader::TNetlistReader(std::istream& Stream)
+    : FStream(Stream), FPosition(0), FLineNumber(0), FDepth(0), FHeaderRead(false), FError(neNone) {
+}
+
+bool TNetlistReader::ReadLine() {
+    while (std::getline(FStream, FLine)) {
+        FLineNumber++;
+        if (!FLine.empty() && FLine[FLine.size() - 1] == '\r') {
+            FLine.erase(FLine.size() - 1);
+        }
+        FPosition = 0;
+        if (FLineNumber == 1 && FLine.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+            FPosition = 3;
+        }
+
+        SkipSpaces();
+        if (!AtEnd() && FLine[FPosition] != '#') return true;
+    }
+    return false;
+}
+
+void TNetlistReader::SkipSpaces() {
+    while (FPosition < FLine.size() && IsSpace(FLine[FPosition])) {
+        FPosition++;
+    }
+}
+
+bool TNetlistReader::ReadWord(std::string& Word) {
+    size_t start = FPosition;
+    while (FPosition < FLine.size() && !IsSpace(FLine[FPosition])) {
+        FPosition++;
+    }
+    Word.assign(FLine, start, FPosition - start);
+    return !Word.empty();
+}
+
+bool TNetlistReader::ReadInt(int32_t& Value) {
+    bool negative = FPosition < FLine.size() && FLine[FPosition] == '-';
+    if (negative) FPosition++;
+
+    size_t start = FPosition;
+    int64_t result = 0;
+    while (FPosition < FLine.size() && FLine[FPosition] >= '0' && FLine[FPosition] <= '9') {
+        result = result * 10 + (FLine[FPosition] - '0');
+        if (result > 2147483648LL) return Fail(neNumber);
+        FPosition++;
+    }
+    if (FPosition == start) return Fail(neNumber);
+
+    if (negative) result = -result;
+    if (result > 2147483647LL) return Fail(neNumber);
+    Value = (int32_t)result;
+    return true;
+}
+
+bool TNetlistReader::ReadQuoted(std::string& Value) {
+    if (AtEnd() || FLine[FPosition] != '"') return Fail(neSyntax);
+    FPosition++;
+
+    Value.clear();
+    while (FPosition < FLine.size()) {
+        char c = FLine[FPosition++];
+        if (c == '"') return true;
+        if (c == '\\' && FPosition < FLine.size()) {
+            c = FLine[FPosition++];
+            if (c == 'n') c = '\n';
+        }
+        Value += c;
+    }
+    return Fail(neSyntax);
+}
+
+bool TNetlistReader::ReadElement(TNetlistElement& Element, bool WithClass) {
+    Element.ClassName.clear();
+    Element.Name.clear();
+    Element.HasName = false;
+    Element.Width = Element.Height = Element.State = 0;
+    Element.Params.clear();
+    Element.StateParams.clear();
+
+    SkipSpaces();
+    if (!ReadInt(Element.Id)) return false;
+    if (WithClass) {
+        SkipSpaces();
+        if (!ReadWord(Element.ClassName)) return Fail(neSyntax);
+    }
+    SkipSpaces();
+    if (!ReadInt(Element.Left)) return false;
+    SkipSpaces();
+    if (!ReadInt(Element.Top)) return false;
+
+    std::string key;
+    for (;;) {
+        if (!AtEnd() && !IsSpace(FLine[FPosition])) return Fail(neSyntax);
+        SkipSpaces();
+        if (AtEnd()) return true;
+
+        size_t start = FPosition;
+        while (FPosition < FLine.size() && IsKeyChar(FLine[FPosition])) {
+            FPosition++;
+        }
+        // state.<ключ> - параметр состояния
+        bool isState = false;
+        if (FPosition - start == 5 && FLine.compare(start, 5, "state") == 0 &&
+            FPosition < FLine.size() && FLine[FPosition] == '.') {
+            isState = true;
+            start = ++FPosition;
+            while (FPosition < FLine.size() && IsKeyChar(FLine[FPosition])) {
+                FPosition++;
+            }
+        }
+        if (FPosition == start || AtEnd() || FLine[FPosition] != '=') return Fail(neSyntax);
+        key.assign(FLine, start, FPosition - start);
+        FPosition++;
+
+        if (key == "name") {
+            if (!ReadQuoted(Element.Name)) return false;
+            Element.HasName = true;
+            continue;
+        }
+
+        int32_t value;
+        if (!ReadInt(value)) return false;
+        if (isState) {
+            Element.StateParams.push_back(std::make_pair(key, value));
+        } else if (key == "w") {
+            Element.Width = value;
+        } else if (key == "h") {
+            Element.Height = value;
+        } else if (key == "state") {
+            Element.State = value;
+        } else {
+            Element.Params.push_back(std::make_pair(key, value));
+        }
+    }
+}
+
+bool TNetlistReader::ReadPin(TNetlistPin& Pin) {
+    if (!ReadInt(Pin.Element)) return false;
+    if (AtEnd() || FLine[FPosition] != '.') return Fail(neSyntax);
+    FPosition++;
+
+    if (FLine.compare(FPosition, 2, "in") == 0) {
+        Pin.IsInput = true;
+        FPosition += 2;
+    } else if (FLine.compare(FPosition, 3, "out") == 0) {
+        Pin.IsInput = false;
+        FPosition += 3;
+    } else {
+        return Fail(neSyntax);
+    }
+
+    int32_t port;
+    if (!ReadInt(port)) return false;
+    if (port < 0) return Fail(neNumber);
+    Pin.Port = (uint32_t)port;
+    return true;
+}
+
+bool TNetlistReader::Next(TNetlistRecord& Record) {
+    if (FError != neNone) return false;
+
+    std::string keyword;
+    for (;;) {
+        if (!ReadLine()) {
+            if (!FHeaderRead) return Fail(neHeader);
+            if (FDepth > 0) return Fail(neUnclosed);
+            return false;
+        }
+        ReadWord(keyword);
+
+        if (FHeaderRead) break;
+
+        // Первая значимая строка - сигнатура и версия формата
+        if (keyword != NetlistMagic) return Fail(neHeader);
+        int32_t version;
+        SkipSpaces();
+        if (!ReadInt(version)) return false;
+        if (version != (int32_t)NetlistVersion) return Fail(neVersion);
+        FHeaderRead = true;
+    }
+
+    if (keyword == "element") {
+        Record.Kind = nrElement;
+        if (!ReadElement(Record.Element, true)) return false;
+    } else if (keyword == "subcircuit") {
+        Record.Kind = nrSubCircuit;
+        if (!ReadElement(Record.Element, false)) return false;
+        FDepth++;
+    } else if (keyword == "end") {
+        if (FDepth == 0) return Fail(neUnexpectedEnd);
+        Record.Kind = nrEnd;
+        FDepth--;
+    } else if (keyword == "net") {
+        Record.Kind = nrNet;
+        Record.Pins.clear();
+        for (;;) {
+            if (!AtEnd() && !IsSpace(FLine[FPosition])) return Fail(neSyntax);
+            SkipSpaces();
+            if (AtEnd()) break;
+            TNetlistPin pin;
+            if (!ReadPin(pin)) return false;
+            Record.Pins.push_back(pin);
+        }
+        if (Record.Pins.size() < 2) return Fail(neSyntax);
+    } else if (keyword == "next") {
+        Record.Kind = nrNextId;
+        SkipSpaces();
+        if (!ReadInt(Record.NextElementId)) return false;
+    } else {
+        return Fail(neSyntax);
+    }
+
+    SkipSpaces();
+    return AtEnd() ? true : Fail(neSyntax);
+}
+
+uint64_t NetlistHash(const std::string& Text) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : Text) {
+        hash = (hash ^ (unsigned char)c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool TNetlistReader::HasNetlistMagic(const char* Data, size_t Length) {
+    size_t magic = sizeof(NetlistMagic) - 1;
+    if (Length >= 3 && memcmp(Data, "\xEF\xBB\xBF", 3) == 0) {
+        Data += 3;
+        Length -= 3;
+    }
+    return Length >= magic && memcmp(Data, NetlistMagic, magic) == 0;
+}
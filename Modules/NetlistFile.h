@@ -0,0 +1,132 @@
+#ifndef NetlistFileH
+#define NetlistFileH
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Текстовый список соединений схемы: одна строка - один элемент или одна цепь.
+// Выводы называются по номеру (in0, out1), координат выводов в файле нет -
+// их расставляет сам элемент. Кодировка UTF-8, числа целые.
+//
+//   SETUNNET 1
+//   next 12
+//   element 1 TDecoder 100 40 w=80 h=165 InputBits=2 name="Дешифратор"
+//   element 2 TCounter 300 40 state=1 MaxCount=8 state.Count=3
+//   subcircuit 5 300 200 w=120 h=80 name="SubCircuit"
+//     element 1 TLogicAnd 0 0
+//     net 1.out0 ...
+//   end
+//   net 1.out0 5.in0 7.in2
+//
+// Первый вывод цепи - источник, остальные - приемники. Параметры state.* -
+// состояние моделирования элемента, остальные - его структура.
+// Строки с # - комментарии.
+// Чтение и запись идут потоком, память не зависит от размера файла
+
+const uint32_t NetlistVersion = 1;
+
+enum TNetlistRecordKind { nrNextId, nrElement, nrSubCircuit, nrEnd, nrNet };
+
+struct TNetlistPin {
+    int32_t Element;
+    bool IsInput;
+    uint32_t Port;
+};
+
+struct TNetlistElement {
+    int32_t Id;
+    std::string ClassName;      // у подсхемы пусто
+    std::string Name;
+    bool HasName;
+    int32_t Left;
+    int32_t Top;
+    int32_t Width;              // 0 - размер по умолчанию для класса
+    int32_t Height;
+    int32_t State;
+    std::vector<std::pair<std::string, int32_t>> Params;
+    std::vector<std::pair<std::string, int32_t>> StateParams;   // пишутся с префиксом state.
+
+    TNetlistElement() : Id(0), HasName(false), Left(0), Top(0), Width(0), Height(0), State(0) {}
+};
+
+// Запись заполняет только поля своего вида
+struct TNetlistRecord {
+    TNetlistRecordKind Kind;
+    int32_t NextElementId;
+    TNetlistElement Element;
+    std::vector<TNetlistPin> Pins;
+};
+
+class TNetlistWriter {
+private:
+    std::ostream& FStream;
+    std::string FLine;
+    int FDepth;
+
+    void BeginLine(const char* Keyword);
+    void AppendInt(int64_t Value);
+    void AppendElement(const TNetlistElement& Element, bool WithClass);
+    void EndLine();
+
+public:
+    explicit TNetlistWriter(std::ostream& Stream);
+
+    void WriteHeader(int32_t NextElementId);
+    void WriteElement(const TNetlistElement& Element);
+    // Строки до EndSubCircuit - содержимое подсхемы
+    void BeginSubCircuit(const TNetlistElement& Element);
+    void EndSubCircuit();
+    void WriteNet(const std::vector<TNetlistPin>& Pins);
+
+    bool IsGood() const { return FStream.good(); }
+};
+
+class TNetlistReader {
+public:
+    enum TError { neNone, neHeader, neVersion, neSyntax, neNumber, neUnexpectedEnd, neUnclosed };
+
+private:
+    std::istream& FStream;
+    std::string FLine;
+    size_t FPosition;
+    size_t FLineNumber;
+    int FDepth;
+    bool FHeaderRead;
+    TError FError;
+
+    bool Fail(TError Error) { FError = Error; return false; }
+    bool ReadLine();
+    void SkipSpaces();
+    bool AtEnd() const { return FPosition >= FLine.size(); }
+    bool ReadWord(std::string& Word);
+    bool ReadInt(int32_t& Value);
+    bool ReadElement(TNetlistElement& Element, bool WithClass);
+    bool ReadPin(TNetlistPin& Pin);
+    bool ReadQuoted(std::string& Value);
+
+    TNetlistReader(const TNetlistReader&);
+    TNetlistReader& operator=(const TNetlistReader&);
+
+public:
+    explicit TNetlistReader(std::istream& Stream);
+
+    // false - конец файла или ошибка (GetError); Record переиспользуется между вызовами
+    bool Next(TNetlistRecord& Record);
+
+    TError GetError() const { return FError; }
+    size_t GetLineNumber() const { return FLineNumber; }
+
+    // Начало файла похоже на список соединений
+    static bool HasNetlistMagic(const char* Data, size_t Length);
+};
+
+// Хеш текста списка соединений (FNV-1a, 64 бита): одинаковые схемы в
+// каноническом виде дают одинаковый хеш
+uint64_t NetlistHash(const std::string& Text);
+
+#endif
@@ -0,0 +1,313 @@
+#include "OccupancyGrid.h"
+#include <algorithm>
+#include <climits>
+
+#pragma package(smart_init)
+
+namespace {
+    typedef unsigned long long TWord;
+
+    // Начальный радиус поиска свободного места и запас при расширении карты, в клетках
+    const int InitialSearchRadius = 16;
+    const int MaxSearchRadius = 1 << 16;
+    const int GrowMargin = 64;
+
+    int FloorDiv(int Value, int Divisor) {
+        return Value >= 0 ? Value / Divisor : -((-Value + Divisor - 1) / Divisor);
+    }
+
+    int RoundDiv(int Value, int Divisor) {
+        return FloorDiv(Value + Divisor / 2, Divisor);
+    }
+
+    TWord LowMask(int Bits) {
+        return Bits >= 64 ? ~0ULL : (1ULL << Bits) - 1;
+    }
+
+    // Номера младшего и старшего установленного бита, Word != 0
+    int LowestBit(TWord Word) {
+        int bit = 0;
+        for (int step = 32; step > 0; step >>= 1) {
+            if ((Word & LowMask(step)) == 0) {
+                Word >>= step;
+                bit += step;
+            }
+        }
+        return bit;
+    }
+
+    int HighestBit(TWord Word) {
+        int bit = 0;
+        for (int step = 32; step > 0; step >>= 1) {
+            if (Word >> step) {
+                Word >>= step;
+                bit += step;
+            }
+        }
+        return bit;
+    }
+
+    // Row[i] &= Row[i + Shift] для всей строки битов; за концом строки - нули
+    void AndShifted(TWord* Row, int Words, int Shift) {
+        int wordShift = Shift / 64;
+        int bitShift = Shift % 64;
+        for (int i = 0; i < Words; i++) {
+            TWord lo = i + wordShift < Words ? Row[i + wordShift] : 0;
+            TWord hi = i + wordShift + 1 < Words ? Row[i + wordShift + 1] : 0;
+            Row[i] &= bitShift ? (lo >> bitShift) | (hi << (64 - bitShift)) : lo;
+        }
+    }
+
+    // Ближайший к Column установленный бит строки в пределах [0, Count), -1 - нет
+    int NearestBit(const TWord* Row, int Count, int Column) {
+        int words = (Count + 63) / 64;
+        int right = -1;
+        for (int i = Column / 64; i < words; i++) {
+            TWord word = Row[i];
+            if (i == Column / 64) word &= ~LowMask(Column % 64);
+            if (word) {
+                right = i * 64 + LowestBit(word);
+                break;
+            }
+        }
+        if (right >= Count) right = -1;
+
+        int left = -1;
+        for (int i = Column / 64; i >= 0; i--) {
+            TWord word = Row[i];
+            if (i == Column / 64) word &= LowMask(Column % 64);
+            if (word) {
+                left = i * 64 + HighestBit(word);
+                break;
+            }
+        }
+
+        if (left < 0) return right;
+        if (right < 0) return left;
+        return Column - left <= right - Column ? left : right;
+    }
+}
+
+TOccupancyGrid::TOccupancyGrid()
+    : FOriginX(0), FOriginY(0), FWordsPerRow(0), FRows(0), FCount(0), FValid(true) {
+}
+
+void TOccupancyGrid::Clear() {
+    FBits.clear();
+    FOverlaps.clear();
+    FOriginX = 0;
+    FOriginY = 0;
+    FWordsPerRow = 0;
+    FRows = 0;
+    FCount = 0;
+    FValid = true;
+}
+
+void TOccupancyGrid::GetCells(const TRect& Bounds, int& Left, int& Top, int& Right, int& Bottom) {
+    Left = FloorDiv(Bounds.Left, CellSize);
+    Top = FloorDiv(Bounds.Top, CellSize);
+    Right = FloorDiv(Bounds.Right - 1, CellSize);
+    Bottom = FloorDiv(Bounds.Bottom - 1, CellSize);
+}
+
+void TOccupancyGrid::EnsureCells(int Left, int Top, int Right, int Bottom) {
+    if (FRows > 0 && Left >= FOriginX && Top >= FOriginY &&
+        Right < FOriginX + FWordsPerRow * WordBits && Bottom < FOriginY + FRows) {
+        return;
+    }
+
+    // Карта расширяется с запасом; сдвиг по X кратен слову, чтобы строки копировались целыми словами
+    int originX, originY, right, bottom;
+    if (FRows == 0) {
+        originX = Left - GrowMargin;
+        originY = Top - GrowMargin;
+        right = Right + GrowMargin;
+        bottom = Bottom + GrowMargin;
+    } else {
+        int left = std::min(Left - GrowMargin, FOriginX);
+        originX = FOriginX - ((FOriginX - left + WordBits - 1) / WordBits) * WordBits;
+        originY = std::min(Top - GrowMargin, FOriginY);
+        right = std::max(Right + GrowMargin, FOriginX + FWordsPerRow * WordBits - 1);
+        bottom = std::max(Bottom + GrowMargin, FOriginY + FRows - 1);
+    }
+
+    int wordsPerRow = (right - originX + WordBits) / WordBits;
+    int rows = bottom - originY + 1;
+    std::vector<TWord> bits((size_t)wordsPerRow * rows, 0);
+
+    int wordOffset = (FOriginX - originX) / WordBits;
+    for (int y = 0; y < FRows; y++) {
+        std::copy(FBits.begin() + (size_t)y * FWordsPerRow, FBits.begin() + (size_t)(y + 1) * FWordsPerRow,
+                  bits.begin() + (size_t)(y + FOriginY - originY) * wordsPerRow + wordOffset);
+    }
+
+    FBits.swap(bits);
+    FOriginX = originX;
+    FOriginY = originY;
+    FWordsPerRow = wordsPerRow;
+    FRows = rows;
+}
+
+void TOccupancyGrid::UpdateCells(const TRect& Bounds, bool Occupy) {
+    int left, top, right, bottom;
+    GetCells(Bounds, left, top, right, bottom);
+    if (left > right || top > bottom) return;
+
+    if (Occupy) {
+        EnsureCells(left, top, right, bottom);
+    } else {
+        // Вне карты снимать нечего
+        left = std::max(left, FOriginX);
+        top = std::max(top, FOriginY);
+        right = std::min(right, FOriginX + FWordsPerRow * WordBits - 1);
+        bottom = std::min(bottom, FOriginY + FRows - 1);
+        if (left > right || top > bottom) return;
+    }
+
+    int from = left - FOriginX;
+    int to = right - FOriginX;
+    for (int y = top; y <= bottom; y++) {
+        TWord* row = &FBits[(size_t)(y - FOriginY) * FWordsPerRow];
+
+        for (int w = from / WordBits; w <= to / WordBits; w++) {
+            int lo = std::max(from, w * WordBits) - w * WordBits;
+            int hi = std::min(to, w * WordBits + WordBits - 1) - w * WordBits;
+            TWord mask = LowMask(hi - lo + 1) << lo;
+            TWord& word = row[w];
+
+            if (Occupy) {
+                // Наложение элементов запоминается отдельно, чтобы снятие одного не освободило клетку
+                TWord shared = word & mask;
+                for (int bit = 0; shared; bit++, shared >>= 1) {
+                    if (shared & 1) FOverlaps[CellKey(FOriginX + w * WordBits + bit, y)]++;
+                }
+                word |= mask;
+            } else if (FOverlaps.empty()) {
+                word &= ~mask;
+            } else {
+                TWord taken = word & mask;
+                for (int bit = 0; taken; bit++, taken >>= 1) {
+                    if (!(taken & 1)) continue;
+                    auto it = FOverlaps.find(CellKey(FOriginX + w * WordBits + bit, y));
+                    if (it == FOverlaps.end()) {
+                        word &= ~(1ULL << bit);
+                    } else if (--it->second == 0) {
+                        FOverlaps.erase(it);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TOccupancyGrid::TWord TOccupancyGrid::ReadWord(int Row, int Column) const {
+    int y = Row - FOriginY;
+    if (y < 0 || y >= FRows) return 0;
+
+    const TWord* row = &FBits[(size_t)y * FWordsPerRow];
+    int offset = Column - FOriginX;
+    int index = FloorDiv(offset, WordBits);
+    int shift = offset - index * WordBits;
+
+    TWord lo = index >= 0 && index < FWordsPerRow ? row[index] : 0;
+    TWord hi = index + 1 >= 0 && index + 1 < FWordsPerRow ? row[index + 1] : 0;
+    return shift ? (lo >> shift) | (hi << (WordBits - shift)) : lo;
+}
+
+void TOccupancyGrid::Add(const TRect& Bounds) {
+    UpdateCells(Bounds, true);
+    FCount++;
+}
+
+void TOccupancyGrid::Remove(const TRect& Bounds) {
+    UpdateCells(Bounds, false);
+    if (FCount > 0) FCount--;
+}
+
+void TOccupancyGrid::Move(const TRect& OldBounds, const TRect& NewBounds) {
+    if (OldBounds == NewBounds) return;
+    UpdateCells(OldBounds, false);
+    UpdateCells(NewBounds, true);
+}
+
+bool TOccupancyGrid::IsFree(const TRect& Bounds) const {
+    int left, top, right, bottom;
+    GetCells(Bounds, left, top, right, bottom);
+
+    for (int y = top; y <= bottom; y++) {
+        for (int x = left; x <= right; x += WordBits) {
+            if (ReadWord(y, x) & LowMask(right - x + 1)) return false;
+        }
+    }
+    return true;
+}
+
+bool TOccupancyGrid::FindFree(const TPoint& Preferred, int Width, int Height, TPoint& Result) const {
+    int width = std::max(1, (Width + CellSize - 1) / CellSize);
+    int height = std::max(1, (Height + CellSize - 1) / CellSize);
+    int px = RoundDiv(Preferred.X, CellSize);
+    int py = RoundDiv(Preferred.Y, CellSize);
+
+    // Окно поиска растет, пока не выйдет за карту - снаружи место есть всегда
+    for (int radius = InitialSearchRadius; radius <= MaxSearchRadius; radius *= 2) {
+        int left = px - radius;
+        int top = py - radius;
+        int columns = 2 * radius + 1;
+        int candidates = 2 * radius + 1;
+        int span = columns + width - 1;
+        int words = (span + WordBits - 1) / WordBits;
+        int rows = candidates + height - 1;
+
+        // Свободные клетки окна
+        std::vector<TWord> free((size_t)rows * words);
+        for (int r = 0; r < rows; r++) {
+            TWord* row = &free[(size_t)r * words];
+            for (int k = 0; k < words; k++) {
+                row[k] = ~ReadWord(top + r, left + k * WordBits) & LowMask(span - k * WordBits);
+            }
+
+            // Бит j остается, если свободны клетки j..j+width-1 (удвоением длины серии)
+            int run = 1;
+            for (; run * 2 <= width; run *= 2) AndShifted(row, words, run);
+            if (run < width) AndShifted(row, words, width - run);
+        }
+
+        // То же по вертикали: бит строки r - свободен прямоугольник с углом в (j, r)
+        auto andRows = [&](int Shift) {
+            for (int r = 0; r < rows; r++) {
+                TWord* row = &free[(size_t)r * words];
+                const TWord* below = r + Shift < rows ? &free[(size_t)(r + Shift) * words] : nullptr;
+                for (int k = 0; k < words; k++) row[k] = below ? row[k] & below[k] : 0;
+            }
+        };
+        int run = 1;
+        for (; run * 2 <= height; run *= 2) andRows(run);
+        if (run < height) andRows(height - run);
+
+        // Строки перебираются по удалению от желаемой, пока они могут дать место ближе найденного
+        long long best = LLONG_MAX;
+        for (int d = 0; d <= radius && (long long)d * d < best; d++) {
+            for (int sign = 1; sign >= -1; sign -= 2) {
+                if (d == 0 && sign < 0) break;
+
+                int r = radius + sign * d;
+                int column = NearestBit(&free[(size_t)r * words], columns, radius);
+                if (column < 0) continue;
+
+                long long dx = column - radius;
+                long long distance = dx * dx + (long long)d * d;
+                if (distance < best) {
+                    best = distance;
+                    Result = TPoint((left + column) * CellSize, (top + r) * CellSize);
+                }
+            }
+        }
+
+        // Место дальше радиуса могло уступить соседнему за пределами окна
+        if (best <= (long long)radius * radius || (best != LLONG_MAX && radius * 2 > MaxSearchRadius)) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,71 @@
+#ifndef OccupancyGridH
+#define OccupancyGridH
+
+#include <System.Types.hpp>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+
+// Карта занятости схемы: один бит на клетку сетки привязки. Поиск свободного
+// места идет по 64 клетки за операцию вместо проверки каждого элемента
+class TOccupancyGrid {
+public:
+    static const int CellSize = 20;
+
+private:
+    typedef unsigned long long TWord;
+    static const int WordBits = 64;
+
+    // Покрытая картой область в клетках; за ее пределами все свободно
+    int FOriginX;
+    int FOriginY;
+    int FWordsPerRow;
+    int FRows;
+    std::vector<TWord> FBits;
+
+    // Клетки под несколькими элементами: сколько еще элементов, кроме первого
+    std::unordered_map<long long, unsigned> FOverlaps;
+
+    size_t FCount;
+    bool FValid;
+
+    static long long CellKey(int X, int Y) {
+        return ((long long)X << 32) | (unsigned)Y;
+    }
+
+    static void GetCells(const TRect& Bounds, int& Left, int& Top, int& Right, int& Bottom);
+    void EnsureCells(int Left, int Top, int Right, int Bottom);
+    void UpdateCells(const TRect& Bounds, bool Occupy);
+    TWord ReadWord(int Row, int Column) const;
+
+public:
+    TOccupancyGrid();
+
+    void Clear();
+
+    // Карта перестраивается по элементам вкладки, если она устарела или число
+    // элементов не совпадает с отмеченным
+    void Invalidate() { FValid = false; }
+    bool IsSynced(size_t ElementCount) const { return FValid && FCount == ElementCount; }
+    template <typename TElements> void Rebuild(const TElements& Elements);
+
+    void Add(const TRect& Bounds);
+    void Remove(const TRect& Bounds);
+    void Move(const TRect& OldBounds, const TRect& NewBounds);
+
+    bool IsFree(const TRect& Bounds) const;
+
+    // Ближайшее к Preferred свободное место для прямоугольника Width x Height,
+    // левый верхний угол привязан к сетке
+    bool FindFree(const TPoint& Preferred, int Width, int Height, TPoint& Result) const;
+};
+
+template <typename TElements>
+void TOccupancyGrid::Rebuild(const TElements& Elements) {
+    Clear();
+    for (const auto& element : Elements) {
+        Add(element->Bounds);
+    }
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include "ParallelLoop.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#pragma package(smart_init)
+
+TParallelLoop::TParallelLoop(unsigned ThreadCount) : FThreadCount(ThreadCount) {
+    if (FThreadCount == 0) {
+        FThreadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+void TParallelLoop::Run(size_t Count, size_t Grain, const TRangeFunc& Func) const {
+    if (Count == 0) return;
+    Grain = std::max<size_t>(1, Grain);
+
+    size_t chunks = (Count + Grain - 1) / Grain;
+    unsigned threadCount = static_cast<unsigned>(std::min<size_t>(FThreadCount, chunks));
+
+    // Мелкие диапазоны дешевле обработать на месте, чем запускать потоки
+    if (threadCount <= 1) {
+        for (size_t begin = 0; begin < Count; begin += Grain) {
+            Func(begin, std::min(Count, begin + Grain));
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex mutex;
+
+    auto worker = [&]() {
+        while (!failed) {
+            size_t chunk = nextChunk++;
+            if (chunk >= chunks) break;
+
+            size_t begin = chunk * Grain;
+            try {
+                Func(begin, std::min(Count, begin + Grain));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) error = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    // Запущенные потоки дожидаются и при исключении из запуска следующего:
+    // поток, разрушенный без join, завершает программу
+    struct TJoinGuard {
+        std::vector<std::thread>& Threads;
+        ~TJoinGuard() {
+            for (auto& thread : Threads) {
+                if (thread.joinable()) thread.join();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    {
+        TJoinGuard guard = { threads };
+        try {
+            for (unsigned i = 1; i < threadCount; i++) {
+                threads.emplace_back(worker);
+            }
+        } catch (...) {
+            failed = true;
+            throw;
+        }
+        worker();
+    }
+
+    if (error) std::rethrow_exception(error);
+}
@@ -0,0 +1,27 @@
+#ifndef ParallelLoopH
+#define ParallelLoopH
+
+#include <cstddef>
+#include <functional>
+
+// Параллельная обработка диапазона индексов порциями. Порции раздаются
+// потокам по мере освобождения, текущий поток тоже участвует в работе
+class TParallelLoop {
+public:
+    typedef std::function<void(size_t Begin, size_t End)> TRangeFunc;
+
+private:
+    unsigned FThreadCount;
+
+public:
+    // 0 - по числу аппаратных потоков
+    explicit TParallelLoop(unsigned ThreadCount = 0);
+
+    unsigned GetThreadCount() const { return FThreadCount; }
+
+    // Func получает непересекающиеся диапазоны [Begin, End) не длиннее Grain и
+    // вызывается из рабочих потоков. Первое исключение пробрасывается наружу
+    void Run(size_t Count, size_t Grain, const TRangeFunc& Func) const;
+};
+
+#endif
@@ -0,0 +1,217 @@
+#include "PngWriter.h"
+#include <cstring>
+
+#pragma package(smart_init)
+
+// Сжатие - deflate с фиксированными кодами Хаффмана: повтор предыдущего
+// пикселя кодируется ссылкой на расстояние 3, остальное - литералами.
+// Для схем с большими однотонными областями этого достаточно
+
+static const int LengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const int LengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const int MaxMatch = 258;
+static const size_t IdatChunkSize = 65536;
+
+static uint32_t Crc32(uint32_t Crc, const unsigned char* Data, size_t Size) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+
+    Crc = ~Crc;
+    for (size_t i = 0; i < Size; i++) {
+        Crc = table[(Crc ^ Data[i]) & 0xFF] ^ (Crc >> 8);
+    }
+    return ~Crc;
+}
+
+static void PutBigEndian(unsigned char* Dest, uint32_t Value) {
+    Dest[0] = static_cast<unsigned char>(Value >> 24);
+    Dest[1] = static_cast<unsigned char>(Value >> 16);
+    Dest[2] = static_cast<unsigned char>(Value >> 8);
+    Dest[3] = static_cast<unsigned char>(Value);
+}
+
+TPngWriter::TPngWriter()
+    : FOut(nullptr), FWidth(0), FHeight(0), FRowsWritten(0),
+      FBitBuffer(0), FBitCount(0), FAdlerA(1), FAdlerB(0) {
+}
+
+void TPngWriter::WriteChunk(const char* Type, const unsigned char* Data, size_t Size) {
+    unsigned char header[8];
+    PutBigEndian(header, static_cast<uint32_t>(Size));
+    memcpy(header + 4, Type, 4);
+    FOut->write(reinterpret_cast<const char*>(header), 8);
+    if (Size > 0) {
+        FOut->write(reinterpret_cast<const char*>(Data), Size);
+    }
+
+    uint32_t crc = Crc32(0, header + 4, 4);
+    crc = Crc32(crc, Data, Size);
+    unsigned char trailer[4];
+    PutBigEndian(trailer, crc);
+    FOut->write(reinterpret_cast<const char*>(trailer), 4);
+}
+
+void TPngWriter::FlushIdat(bool Force) {
+    while (FCompressed.size() >= IdatChunkSize) {
+        WriteChunk("IDAT", FCompressed.data(), IdatChunkSize);
+        FCompressed.erase(FCompressed.begin(), FCompressed.begin() + IdatChunkSize);
+    }
+    if (Force && !FCompressed.empty()) {
+        WriteChunk("IDAT", FCompressed.data(), FCompressed.size());
+        FCompressed.clear();
+    }
+}
+
+void TPngWriter::PutBits(uint32_t Value, int Count) {
+    FBitBuffer |= Value << FBitCount;
+    FBitCount += Count;
+    while (FBitCount >= 8) {
+        FCompressed.push_back(static_cast<unsigned char>(FBitBuffer));
+        FBitBuffer >>= 8;
+        FBitCount -= 8;
+    }
+}
+
+void TPngWriter::PutCode(uint32_t Code, int Length) {
+    // Коды Хаффмана записываются со старшего бита
+    uint32_t reversed = 0;
+    for (int i = 0; i < Length; i++) {
+        reversed = (reversed << 1) | ((Code >> i) & 1);
+    }
+    PutBits(reversed, Length);
+}
+
+void TPngWriter::PutLiteral(int Value) {
+    if (Value < 144) PutCode(0x30 + Value, 8);
+    else if (Value < 256) PutCode(0x190 + (Value - 144), 9);
+    else if (Value < 280) PutCode(Value - 256, 7);
+    else PutCode(0xC0 + (Value - 280), 8);
+}
+
+void TPngWriter::PutMatch(int Length) {
+    int index = 28;
+    while (LengthBase[index] > Length) index--;
+
+    PutLiteral(257 + index);
+    if (LengthExtra[index] > 0) {
+        PutBits(Length - LengthBase[index], LengthExtra[index]);
+    }
+    // Код расстояния 2 - ровно 3 байта, без дополнительных битов
+    PutCode(2, 5);
+}
+
+void TPngWriter::UpdateAdler(const unsigned char* Data, size_t Size) {
+    for (size_t i = 0; i < Size; i++) {
+        FAdlerA = (FAdlerA + Data[i]) % 65521;
+        FAdlerB = (FAdlerB + FAdlerA) % 65521;
+    }
+}
+
+void TPngWriter::CompressRow(const unsigned char* Row) {
+    // Фильтр строки 0 (None)
+    unsigned char filter = 0;
+    UpdateAdler(&filter, 1);
+    PutLiteral(0);
+
+    size_t size = static_cast<size_t>(FWidth) * 3;
+    UpdateAdler(Row, size);
+
+    size_t i = 0;
+    while (i < size) {
+        if (i >= 3) {
+            size_t length = 0;
+            while (i + length < size && length < MaxMatch && Row[i + length] == Row[i + length - 3]) {
+                length++;
+            }
+            if (length >= 3) {
+                PutMatch(static_cast<int>(length));
+                i += length;
+                continue;
+            }
+        }
+        PutLiteral(Row[i]);
+        i++;
+    }
+}
+
+void TPngWriter::Begin(std::ostream& Out, int Width, int Height) {
+    FOut = &Out;
+    FWidth = Width;
+    FHeight = Height;
+    FRowsWritten = 0;
+    FCompressed.clear();
+    FBitBuffer = 0;
+    FBitCount = 0;
+    FAdlerA = 1;
+    FAdlerB = 0;
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    FOut->write(reinterpret_cast<const char*>(signature), 8);
+
+    unsigned char header[13];
+    PutBigEndian(header, static_cast<uint32_t>(Width));
+    PutBigEndian(header + 4, static_cast<uint32_t>(Height));
+    header[8] = 8;   // бит на канал
+    header[9] = 2;   // RGB
+    header[10] = 0;  // deflate
+    header[11] = 0;  // стандартные фильтры
+    header[12] = 0;  // без чересстрочности
+    WriteChunk("IHDR", header, sizeof(header));
+
+    // Заголовок zlib: окно 32К, без словаря
+    FCompressed.push_back(0x78);
+    FCompressed.push_back(0x01);
+}
+
+void TPngWriter::WriteRows(const unsigned char* Rgb, int Count) {
+    if (!FOut || Count <= 0) return;
+
+    // Каждая порция - отдельный нефинальный блок с фиксированными кодами
+    PutBits(0, 1);
+    PutBits(1, 2);
+    for (int y = 0; y < Count; y++) {
+        CompressRow(Rgb + static_cast<size_t>(y) * FWidth * 3);
+    }
+    PutLiteral(256);
+
+    FRowsWritten += Count;
+    FlushIdat(false);
+}
+
+bool TPngWriter::Finish() {
+    if (!FOut) return false;
+
+    // Пустой финальный блок и выравнивание до байта
+    PutBits(1, 1);
+    PutBits(1, 2);
+    PutLiteral(256);
+    if (FBitCount > 0) {
+        PutBits(0, 8 - FBitCount);
+    }
+
+    unsigned char adler[4];
+    PutBigEndian(adler, (FAdlerB << 16) | FAdlerA);
+    FCompressed.insert(FCompressed.end(), adler, adler + 4);
+    FlushIdat(true);
+
+    WriteChunk("IEND", nullptr, 0);
+    FOut = nullptr;
+    return FRowsWritten == FHeight;
+}
@@ -0,0 +1,45 @@
+#ifndef PngWriterH
+#define PngWriterH
+
+#include <ostream>
+#include <vector>
+#include <cstdint>
+
+// Потоковая запись PNG (RGB, 8 бит) без сторонних библиотек.
+// Строки подаются порциями - целиком изображение в памяти держать не нужно
+class TPngWriter {
+private:
+    std::ostream* FOut;
+    int FWidth;
+    int FHeight;
+    int FRowsWritten;
+
+    // Сжатые данные, еще не выписанные в IDAT
+    std::vector<unsigned char> FCompressed;
+    uint32_t FBitBuffer;
+    int FBitCount;
+    uint32_t FAdlerA;
+    uint32_t FAdlerB;
+
+    void WriteChunk(const char* Type, const unsigned char* Data, size_t Size);
+    void FlushIdat(bool Force);
+
+    void PutBits(uint32_t Value, int Count);
+    void PutCode(uint32_t Code, int Length);
+    void PutLiteral(int Value);
+    void PutMatch(int Length);
+    void UpdateAdler(const unsigned char* Data, size_t Size);
+    void CompressRow(const unsigned char* Row);
+
+public:
+    TPngWriter();
+
+    // Сигнатура и заголовок IHDR
+    void Begin(std::ostream& Out, int Width, int Height);
+    // Count строк по Width*3 байт подряд
+    void WriteRows(const unsigned char* Rgb, int Count);
+    // Завершение потока deflate и IEND; возвращает false, если строк передано меньше Height
+    bool Finish();
+};
+
+#endif
@@ -0,0 +1,232 @@
+#include "RasterRenderTarget.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+
+#pragma package(smart_init)
+
+// Растровый шрифт 5x7 для символов 0x20..0x7E: столбцы слева направо, бит 0 - верхняя строка
+static const unsigned char Font5x7[95][5] = {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x55,0x22,0x50}, {0x00,0x05,0x03,0x00,0x00},
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x08,0x2A,0x1C,0x2A,0x08}, {0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31},
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03},
+    {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00},
+    {0x00,0x08,0x14,0x22,0x41}, {0x14,0x14,0x14,0x14,0x14}, {0x41,0x22,0x14,0x08,0x00}, {0x02,0x01,0x51,0x09,0x06},
+    {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x01,0x01}, {0x3E,0x41,0x41,0x51,0x32},
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x04,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31},
+    {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x7F,0x20,0x18,0x20,0x7F},
+    {0x63,0x14,0x08,0x14,0x63}, {0x03,0x04,0x78,0x04,0x03}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x00,0x7F,0x41,0x41},
+    {0x02,0x04,0x08,0x10,0x20}, {0x41,0x41,0x7F,0x00,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+    {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78}, {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20},
+    {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x08,0x14,0x54,0x54,0x3C},
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x00,0x7F,0x10,0x28,0x44},
+    {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+    {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20},
+    {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+    {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+    {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x08,0x04,0x08,0x10,0x08}
+};
+
+// Символы вне ASCII, встречающиеся в подписях элементов
+static const unsigned char GlyphSigma[5] = {0x63,0x55,0x49,0x41,0x41};
+static const unsigned char GlyphGreaterEqual[5] = {0x51,0x4A,0x4A,0x44,0x44};
+static const unsigned char GlyphUnknown[5] = {0x7F,0x41,0x41,0x41,0x7F};
+
+static const unsigned char* FindGlyph(wchar_t Char) {
+    if (Char >= 0x20 && Char <= 0x7E) return Font5x7[Char - 0x20];
+    if (Char == 0x03A3) return GlyphSigma;
+    if (Char == 0x2265) return GlyphGreaterEqual;
+    return GlyphUnknown;
+}
+
+TRasterRenderTarget::TRasterRenderTarget(int Width, int Height)
+    : FWidth(0), FHeight(0), FPenX(0), FPenY(0) {
+    Resize(Width, Height);
+}
+
+void TRasterRenderTarget::Resize(int Width, int Height) {
+    FWidth = std::max(Width, 0);
+    FHeight = std::max(Height, 0);
+    FPixels.assign(static_cast<size_t>(FWidth) * FHeight * 3, 0xFF);
+}
+
+void TRasterRenderTarget::Clear(TRenderColor Color) {
+    FillDeviceRect(0, 0, FWidth, FHeight, Color);
+}
+
+void TRasterRenderTarget::Blit(const TRasterRenderTarget& Source, int X, int Y) {
+    int left = std::max(0, X);
+    int right = std::min(FWidth, X + Source.FWidth);
+    if (left >= right) return;
+
+    for (int y = std::max(0, Y); y < std::min(FHeight, Y + Source.FHeight); y++) {
+        const unsigned char* src = Source.GetRow(y - Y) + (left - X) * 3;
+        unsigned char* dst = &FPixels[(static_cast<size_t>(y) * FWidth + left) * 3];
+        memcpy(dst, src, static_cast<size_t>(right - left) * 3);
+    }
+}
+
+int TRasterRenderTarget::DevicePenWidth() const {
+    return std::max(1, static_cast<int>(FPenWidth * FZoom + 0.5));
+}
+
+void TRasterRenderTarget::FillDeviceRect(int Left, int Top, int Right, int Bottom, TRenderColor Color) {
+    Left = std::max(Left, 0);
+    Top = std::max(Top, 0);
+    Right = std::min(Right, FWidth);
+    Bottom = std::min(Bottom, FHeight);
+    if (Left >= Right || Top >= Bottom) return;
+
+    unsigned char r = Color & 0xFF;
+    unsigned char g = (Color >> 8) & 0xFF;
+    unsigned char b = (Color >> 16) & 0xFF;
+
+    for (int y = Top; y < Bottom; y++) {
+        unsigned char* pixel = &FPixels[(static_cast<size_t>(y) * FWidth + Left) * 3];
+        for (int x = Left; x < Right; x++) {
+            *pixel++ = r;
+            *pixel++ = g;
+            *pixel++ = b;
+        }
+    }
+}
+
+void TRasterRenderTarget::DrawDeviceLine(int X1, int Y1, int X2, int Y2) {
+    int width = DevicePenWidth();
+    int half = width / 2;
+
+    // Шаблон штриховки в шагах линии, как у косметических перьев GDI
+    int onSteps = 1, period = 1;
+    if (FPenStyle == rpsDash) { onSteps = 6 * width; period = 9 * width; }
+    else if (FPenStyle == rpsDot) { onSteps = width; period = 3 * width; }
+
+    int dx = abs(X2 - X1), sx = X1 < X2 ? 1 : -1;
+    int dy = -abs(Y2 - Y1), sy = Y1 < Y2 ? 1 : -1;
+    int error = dx + dy;
+    int step = 0;
+
+    // Последняя точка не рисуется - как у LineTo
+    while (X1 != X2 || Y1 != Y2) {
+        if (step % period < onSteps) {
+            FillDeviceRect(X1 - half, Y1 - half, X1 - half + width, Y1 - half + width, FPenColor);
+        }
+        step++;
+
+        int doubled = 2 * error;
+        if (doubled >= dy) { error += dy; X1 += sx; }
+        if (doubled <= dx) { error += dx; Y1 += sy; }
+    }
+}
+
+void TRasterRenderTarget::MoveTo(int X, int Y) {
+    FPenX = X;
+    FPenY = Y;
+}
+
+void TRasterRenderTarget::LineTo(int X, int Y) {
+    DrawDeviceLine(DeviceX(FPenX), DeviceY(FPenY), DeviceX(X), DeviceY(Y));
+    FPenX = X;
+    FPenY = Y;
+}
+
+void TRasterRenderTarget::Polyline(const TRenderPoint* Points, int Count) {
+    if (Count < 2) return;
+
+    MoveTo(Points[0].X, Points[0].Y);
+    for (int i = 1; i < Count; i++) {
+        LineTo(Points[i].X, Points[i].Y);
+    }
+}
+
+void TRasterRenderTarget::Rectangle(int Left, int Top, int Right, int Bottom) {
+    int left = DeviceX(Left), top = DeviceY(Top);
+    int right = DeviceX(Right) - 1, bottom = DeviceY(Bottom) - 1;
+
+    if (!FBrushClear) {
+        FillDeviceRect(left, top, right + 1, bottom + 1, FBrushColor);
+    }
+
+    DrawDeviceLine(left, top, right, top);
+    DrawDeviceLine(right, top, right, bottom);
+    DrawDeviceLine(right, bottom, left, bottom);
+    DrawDeviceLine(left, bottom, left, top);
+}
+
+void TRasterRenderTarget::Ellipse(int Left, int Top, int Right, int Bottom) {
+    double left = DeviceX(Left), top = DeviceY(Top);
+    double right = DeviceX(Right), bottom = DeviceY(Bottom);
+    double cx = (left + right) / 2.0, cy = (top + bottom) / 2.0;
+    double rx = (right - left) / 2.0, ry = (bottom - top) / 2.0;
+    if (rx <= 0 || ry <= 0) return;
+
+    // Заливка по строкам
+    if (!FBrushClear) {
+        for (int y = static_cast<int>(top); y < static_cast<int>(bottom); y++) {
+            double t = (y + 0.5 - cy) / ry;
+            if (t < -1.0 || t > 1.0) continue;
+            double span = rx * sqrt(1.0 - t * t);
+            FillDeviceRect(static_cast<int>(cx - span + 0.5), y, static_cast<int>(cx + span + 0.5), y + 1, FBrushColor);
+        }
+    }
+
+    // Контур - ломаная по периметру
+    int segments = std::max(8, static_cast<int>((rx + ry) * 2));
+    int width = DevicePenWidth();
+    int half = width / 2;
+    for (int i = 0; i < segments; i++) {
+        double angle = 2.0 * 3.14159265358979 * i / segments;
+        int x = static_cast<int>(cx + (rx - 0.5) * cos(angle));
+        int y = static_cast<int>(cy + (ry - 0.5) * sin(angle));
+        FillDeviceRect(x - half, y - half, x - half + width, y - half + width, FPenColor);
+    }
+}
+
+void TRasterRenderTarget::FillRect(int Left, int Top, int Right, int Bottom) {
+    FillDeviceRect(DeviceX(Left), DeviceY(Top), DeviceX(Right), DeviceY(Bottom), FBrushColor);
+}
+
+void TRasterRenderTarget::DrawGlyph(int X, int Y, double Scale, const unsigned char* Columns) {
+    for (int column = 0; column < 5; column++) {
+        for (int row = 0; row < 7; row++) {
+            if (!(Columns[column] & (1 << row))) continue;
+
+            int left = X + static_cast<int>(column * Scale);
+            int top = Y + static_cast<int>(row * Scale);
+            int right = X + static_cast<int>((column + 1) * Scale);
+            int bottom = Y + static_cast<int>((row + 1) * Scale);
+            FillDeviceRect(left, top, std::max(right, left + 1), std::max(bottom, top + 1), FFontColor);
+        }
+    }
+}
+
+void TRasterRenderTarget::TextOut(int X, int Y, const wchar_t* Text) {
+    if (!Text) return;
+
+    // Высота строки как у GDI при 96 dpi; ячейка символа - 6x9 точек шрифта
+    double lineHeight = FFontSize * 96.0 / 72.0 * FZoom;
+    double scale = lineHeight / 9.0;
+    int advance = std::max(1, static_cast<int>(6 * scale + 0.5));
+
+    int x = DeviceX(X);
+    int y = DeviceY(Y);
+    size_t length = wcslen(Text);
+
+    // Непрозрачный фон под текстом, как у TCanvas::TextOut со сплошной кистью
+    if (!FBrushClear) {
+        FillDeviceRect(x, y, x + advance * static_cast<int>(length), y + static_cast<int>(lineHeight + 0.5), FBrushColor);
+    }
+
+    int glyphTop = y + static_cast<int>(scale + 0.5);
+    for (size_t i = 0; i < length; i++) {
+        DrawGlyph(x, glyphTop, scale, FindGlyph(Text[i]));
+        x += advance;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef RasterRenderTargetH
+#define RasterRenderTargetH
+
+#include "RenderTarget.h"
+#include <vector>
+#include <cstddef>
+
+// Переносимый бэкенд: растр RGB в памяти без зависимости от VCL и GDI.
+// Используется для экспорта и пакетной генерации превью
+class TRasterRenderTarget : public TRenderTarget {
+private:
+    int FWidth;
+    int FHeight;
+    std::vector<unsigned char> FPixels;
+    int FPenX;
+    int FPenY;
+
+    int DeviceX(int X) const { return static_cast<int>(X * FZoom) - FOffsetX; }
+    int DeviceY(int Y) const { return static_cast<int>(Y * FZoom) - FOffsetY; }
+    int DevicePenWidth() const;
+
+    void FillDeviceRect(int Left, int Top, int Right, int Bottom, TRenderColor Color);
+    void DrawDeviceLine(int X1, int Y1, int X2, int Y2);
+    void DrawGlyph(int X, int Y, double Scale, const unsigned char* Columns);
+
+public:
+    TRasterRenderTarget(int Width = 0, int Height = 0);
+
+    void Resize(int Width, int Height);
+    void Clear(TRenderColor Color);
+
+    int GetWidth() const { return FWidth; }
+    int GetHeight() const { return FHeight; }
+    const unsigned char* GetRow(int Y) const { return &FPixels[static_cast<size_t>(Y) * FWidth * 3]; }
+
+    // Копирование другого растра (например, готовой плитки) в позицию X, Y
+    void Blit(const TRasterRenderTarget& Source, int X, int Y);
+
+    void MoveTo(int X, int Y) override;
+    void LineTo(int X, int Y) override;
+    void Polyline(const TRenderPoint* Points, int Count) override;
+    void Rectangle(int Left, int Top, int Right, int Bottom) override;
+    void Ellipse(int Left, int Top, int Right, int Bottom) override;
+    void FillRect(int Left, int Top, int Right, int Bottom) override;
+    void TextOut(int X, int Y, const wchar_t* Text) override;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef RenderTargetH
+#define RenderTargetH
+
+// Абстракция отрисовки под TCircuitElement::Render и OptimizedDrawCircuit.
+// Заголовок не зависит от VCL - его используют и переносимые бэкенды
+// (растр в памяти, SVG), и обертка над TCanvas
+
+// Цвет в формате 0x00BBGGRR, совпадает с TColor для обычных цветов
+typedef unsigned int TRenderColor;
+
+enum TRenderPenStyle { rpsSolid, rpsDash, rpsDot };
+
+struct TRenderPoint {
+    int X;
+    int Y;
+};
+
+class TRenderTarget {
+protected:
+    TRenderColor FPenColor;
+    int FPenWidth;
+    TRenderPenStyle FPenStyle;
+    TRenderColor FBrushColor;
+    bool FBrushClear;
+    int FFontSize;
+    TRenderColor FFontColor;
+
+    // Преобразование вида: результат = координаты * FZoom - FOffset
+    double FZoom;
+    int FOffsetX;
+    int FOffsetY;
+
+public:
+    TRenderTarget()
+        : FPenColor(0), FPenWidth(1), FPenStyle(rpsSolid), FBrushColor(0xFFFFFF), FBrushClear(false),
+          FFontSize(8), FFontColor(0), FZoom(1.0), FOffsetX(0), FOffsetY(0) {}
+    virtual ~TRenderTarget() {}
+
+    // Состояние пера, кисти и шрифта - как у TCanvas
+    virtual void SetPenColor(TRenderColor Color) { FPenColor = Color; }
+    virtual void SetPenWidth(int Width) { FPenWidth = Width; }
+    virtual void SetPenStyle(TRenderPenStyle Style) { FPenStyle = Style; }
+    virtual void SetBrushColor(TRenderColor Color) { FBrushColor = Color; }
+    virtual void SetBrushClear(bool Clear) { FBrushClear = Clear; }
+    virtual void SetFontSize(int Size) { FFontSize = Size; }
+    virtual void SetFontColor(TRenderColor Color) { FFontColor = Color; }
+
+    virtual void SetTransform(double Zoom, int OffsetX, int OffsetY) {
+        FZoom = Zoom;
+        FOffsetX = OffsetX;
+        FOffsetY = OffsetY;
+    }
+
+    // Примитивы с семантикой GDI: правая и нижняя границы не включаются,
+    // Rectangle и Ellipse заливаются кистью и обводятся пером
+    virtual void MoveTo(int X, int Y) = 0;
+    virtual void LineTo(int X, int Y) = 0;
+    virtual void Polyline(const TRenderPoint* Points, int Count) = 0;
+    virtual void Rectangle(int Left, int Top, int Right, int Bottom) = 0;
+    virtual void Ellipse(int Left, int Top, int Right, int Bottom) = 0;
+    virtual void FillRect(int Left, int Top, int Right, int Bottom) = 0;
+    virtual void TextOut(int X, int Y, const wchar_t* Text) = 0;
+
+    // Набор ломаных одним вызовом - бэкенды могут вывести его пакетом
+    virtual void PolyPolyline(const TRenderPoint* Points, const unsigned* Counts, int PolyCount) {
+        for (int i = 0; i < PolyCount; i++) {
+            Polyline(Points, static_cast<int>(Counts[i]));
+            Points += Counts[i];
+        }
+    }
+};
+
+#endif
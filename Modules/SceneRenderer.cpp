@@ -0,0 +1,247 @@
+#include "SceneRenderer.h"
+#include "SvgRenderTarget.h"
+#include "PngWriter.h"
+#include <algorithm>
+#include <math.h>
+
+#pragma package(smart_init)
+
+static void RecordRectangularWire(TDisplayList& List, const std::vector<TPoint>& Path, TColor Color) {
+    // Основная линия - одна ломаная
+    List.AddPolyline(TPenState(Color, 2), Path.data(), static_cast<int>(Path.size()));
+
+    // Рисуем мостики (если есть) более толстой линией
+    TPenState bridgePen(Color, 3);
+    for (size_t i = 1; i + 2 < Path.size(); i++) {
+        TPoint prev = Path[i-1];
+        TPoint curr = Path[i];
+        TPoint next = Path[i+1];
+
+        // Если направление меняется дважды подряд - это мостик
+        bool isBridge = ((prev.X == curr.X && curr.Y == next.Y) ||
+                         (prev.Y == curr.Y && curr.X == next.X)) &&
+                        ((curr.X == next.X && next.Y == Path[i+2].Y) ||
+                         (curr.Y == next.Y && next.X == Path[i+2].X));
+
+        if (isBridge) {
+            TPoint bridge[3] = { prev, curr, next };
+            List.AddPolyline(bridgePen, bridge, 3);
+        }
+    }
+
+    // Рисуем стрелку в конце
+    TPoint lastSegmentStart = Path[Path.size() - 2];
+    TPoint arrowTip = Path[Path.size() - 1];
+
+    int dx = arrowTip.X - lastSegmentStart.X;
+    int dy = arrowTip.Y - lastSegmentStart.Y;
+    double length = sqrt(dx*dx + dy*dy);
+
+    if (length > 10) {
+        double unitX = dx / length;
+        double unitY = dy / length;
+
+        int arrowSize = 8;
+        int arrowX = arrowTip.X - static_cast<int>(unitX * arrowSize);
+        int arrowY = arrowTip.Y - static_cast<int>(unitY * arrowSize);
+
+        TPoint arrow[3] = {
+            TPoint(arrowX - static_cast<int>(unitY * arrowSize/2), arrowY + static_cast<int>(unitX * arrowSize/2)),
+            arrowTip,
+            TPoint(arrowX + static_cast<int>(unitY * arrowSize/2), arrowY - static_cast<int>(unitX * arrowSize/2))
+        };
+        List.AddPolyline(TPenState(Color, 1), arrow, 3);
+    }
+}
+
+static void RecordStraightWire(TDisplayList& List, const TPoint& Start, const TPoint& End, TColor Color, double Scale) {
+    TPenState pen(Color, static_cast<int>(2 * Scale));
+    List.AddLine(pen, Start, End);
+
+    // Стрелка только для достаточно длинных линий
+    int dx = End.X - Start.X;
+    int dy = End.Y - Start.Y;
+    double length = sqrt(dx*dx + dy*dy);
+    if (length > 15) {
+        double unitX = dx / length;
+        double unitY = dy / length;
+
+        int arrowSize = static_cast<int>(6 * Scale);
+        int arrowX = End.X - static_cast<int>(unitX * arrowSize);
+        int arrowY = End.Y - static_cast<int>(unitY * arrowSize);
+
+        TPoint arrow[3] = {
+            TPoint(arrowX - static_cast<int>(unitY * arrowSize/2), arrowY + static_cast<int>(unitX * arrowSize/2)),
+            End,
+            TPoint(arrowX + static_cast<int>(unitY * arrowSize/2), arrowY - static_cast<int>(unitX * arrowSize/2))
+        };
+        List.AddPolyline(pen, arrow, 3);
+    }
+}
+
+void TSceneRenderer::RecordWire(TDisplayList& List, const std::vector<TPoint>& Path, TColor Color,
+                                bool Rectangular, bool Simple, double Scale) {
+    if (Path.size() < 2) return;
+
+    if (Simple) {
+        // Одна ломаная без стрелок и мостиков
+        List.AddPolyline(TPenState(Color, 1), Path.data(), static_cast<int>(Path.size()));
+    } else if (Rectangular) {
+        RecordRectangularWire(List, Path, Color);
+    } else {
+        RecordStraightWire(List, Path.front(), Path.back(), Color, Scale);
+    }
+}
+
+TSceneRenderer::TSceneRenderer() : FBounds(0, 0, 0, 0), FEmpty(true) {
+}
+
+void TSceneRenderer::Clear() {
+    FWires.clear();
+    FElements.clear();
+    FBounds = TRect(0, 0, 0, 0);
+    FEmpty = true;
+}
+
+void TSceneRenderer::IncludeBounds(const TRect& Rect) {
+    if (FEmpty) {
+        FBounds = Rect;
+        FEmpty = false;
+        return;
+    }
+
+    FBounds.Left = std::min(FBounds.Left, Rect.Left);
+    FBounds.Top = std::min(FBounds.Top, Rect.Top);
+    FBounds.Right = std::max(FBounds.Right, Rect.Right);
+    FBounds.Bottom = std::max(FBounds.Bottom, Rect.Bottom);
+}
+
+void TSceneRenderer::AddWire(const std::vector<TPoint>& Path, TColor Color, bool Rectangular) {
+    if (Path.size() < 2) return;
+
+    TSceneWire wire;
+    wire.Path = Path;
+    wire.Color = Color;
+    wire.Rectangular = Rectangular;
+    wire.Bounds = TRect(Path[0].X, Path[0].Y, Path[0].X, Path[0].Y);
+    for (const auto& point : Path) {
+        wire.Bounds.Left = std::min(wire.Bounds.Left, point.X);
+        wire.Bounds.Top = std::min(wire.Bounds.Top, point.Y);
+        wire.Bounds.Right = std::max(wire.Bounds.Right, point.X);
+        wire.Bounds.Bottom = std::max(wire.Bounds.Bottom, point.Y);
+    }
+    // Запас на толщину пера, стрелку и мостики
+    wire.Bounds.Inflate(12, 12);
+
+    IncludeBounds(wire.Bounds);
+    FWires.push_back(wire);
+}
+
+void TSceneRenderer::AddElement(TCircuitElement* Element) {
+    TRect bounds = Element->Bounds;
+    bounds.Inflate(ElementMargin, ElementMargin);
+
+    IncludeBounds(bounds);
+    FElements.push_back(Element);
+}
+
+TViewTransform TSceneRenderer::GetExportView(double Zoom) const {
+    return TViewTransform(Zoom, static_cast<int>(FBounds.Left * Zoom), static_cast<int>(FBounds.Top * Zoom));
+}
+
+void TSceneRenderer::Render(TRenderTarget* Target, const TViewTransform& View, const TRect& Clip) const {
+    // Фон - в координатах цели
+    Target->SetTransform(1.0, 0, 0);
+    Target->SetBrushClear(false);
+    Target->SetBrushColor(clWhite);
+    Target->FillRect(Clip.Left, Clip.Top, Clip.Right, Clip.Bottom);
+
+    // Видимая область в логических координатах
+    TRect logicalClip(View.ToLogical(Clip.TopLeft()), View.ToLogical(Clip.BottomRight()));
+    logicalClip.Inflate(1, 1);
+
+    Target->SetTransform(View.Zoom, View.OffsetX, View.OffsetY);
+
+    TDisplayList list;
+    for (const auto& wire : FWires) {
+        if (!wire.Bounds.IntersectsWith(logicalClip)) continue;
+        RecordWire(list, wire.Path, wire.Color, wire.Rectangular, false, 1.0);
+    }
+    list.Submit(Target);
+
+    for (auto element : FElements) {
+        TRect bounds = element->Bounds;
+        bounds.Inflate(ElementMargin, ElementMargin);
+        if (!bounds.IntersectsWith(logicalClip)) continue;
+
+        element->Render(Target);
+    }
+
+    Target->SetTransform(1.0, 0, 0);
+}
+
+void TSceneRenderer::RenderTiles(TTileRenderer& Renderer, const TViewTransform& View,
+                                 const std::vector<TRenderTile>& Tiles, TRasterRenderTarget& Dest,
+                                 int DestX, int DestY) const {
+    Renderer.Render(Tiles,
+        [&](TRasterRenderTarget& Target, const TRenderTile& Tile) {
+            TViewTransform tileView(View.Zoom, View.OffsetX + Tile.X, View.OffsetY + Tile.Y);
+            Render(&Target, tileView, TRect(0, 0, Tile.Width, Tile.Height));
+        },
+        [&](const TRasterRenderTarget& Target, const TRenderTile& Tile) {
+            Dest.Blit(Target, Tile.X - DestX, Tile.Y - DestY);
+        });
+}
+
+void TSceneRenderer::RenderToRaster(TRasterRenderTarget& Image, double Zoom, unsigned ThreadCount) const {
+    int width = GetImageWidth(Zoom);
+    int height = GetImageHeight(Zoom);
+    Image.Resize(width, height);
+
+    TTileRenderer renderer(ThreadCount);
+    RenderTiles(renderer, GetExportView(Zoom), TTileRenderer::SplitIntoTiles(0, 0, width, height, ExportTileSize),
+                Image, 0, 0);
+}
+
+bool TSceneRenderer::RenderToPng(std::ostream& Out, double Zoom, const TProgressFunc& Progress,
+                                 unsigned ThreadCount) const {
+    TViewTransform view = GetExportView(Zoom);
+    int width = GetImageWidth(Zoom);
+    int height = GetImageHeight(Zoom);
+
+    TTileRenderer renderer(ThreadCount);
+
+    // Полоса должна дать работу всем потокам, но не выходить за предел памяти
+    int tilesPerRow = (width + ExportTileSize - 1) / ExportTileSize;
+    int bandTileRows = std::max(1, (2 * static_cast<int>(renderer.GetThreadCount()) + tilesPerRow - 1) / tilesPerRow);
+    size_t tileRowBytes = static_cast<size_t>(width) * 3 * ExportTileSize;
+    bandTileRows = std::min(bandTileRows, std::max(1, static_cast<int>(ExportBandBytes / tileRowBytes)));
+    int bandHeight = bandTileRows * ExportTileSize;
+
+    TPngWriter writer;
+    writer.Begin(Out, width, height);
+
+    TRasterRenderTarget band;
+    for (int top = 0; top < height; top += bandHeight) {
+        int rows = std::min(bandHeight, height - top);
+        band.Resize(width, rows);
+
+        RenderTiles(renderer, view, TTileRenderer::SplitIntoTiles(0, top, width, rows, ExportTileSize), band, 0, top);
+
+        writer.WriteRows(band.GetRow(0), rows);
+        if (!Out) return false;
+
+        if (Progress) Progress(top + rows, height);
+    }
+
+    return writer.Finish() && static_cast<bool>(Out);
+}
+
+std::string TSceneRenderer::RenderToSvg(double Zoom) const {
+    int width = GetImageWidth(Zoom);
+    int height = GetImageHeight(Zoom);
+
+    TSvgRenderTarget target;
+    Render(&target, GetExportView(Zoom), TRect(0, 0, width, height));
+    return target.GetDocument(width, height);
+}
@@ -0,0 +1,76 @@
+#ifndef SceneRendererH
+#define SceneRendererH
+
+#include "CircuitElement.h"
+#include "DisplayList.h"
+#include "RasterRenderTarget.h"
+#include "TileRenderer.h"
+#include <System.Types.hpp>
+#include <functional>
+#include <ostream>
+#include <vector>
+#include <string>
+
+// Соединение сцены: ломаная в логических координатах
+struct TSceneWire {
+    std::vector<TPoint> Path;
+    TColor Color;
+    bool Rectangular;
+    TRect Bounds;
+};
+
+// Снимок схемы для отрисовки вне окна - в растр или SVG.
+// Заполняется в главном потоке, рисуется из любых потоков только на чтение
+class TSceneRenderer {
+private:
+    std::vector<TSceneWire> FWires;
+    std::vector<TCircuitElement*> FElements;
+    TRect FBounds;
+    bool FEmpty;
+
+    void IncludeBounds(const TRect& Rect);
+    // Плитки рисуются параллельно и копируются в Dest со сдвигом на DestX, DestY
+    void RenderTiles(TTileRenderer& Renderer, const TViewTransform& View, const std::vector<TRenderTile>& Tiles,
+                     TRasterRenderTarget& Dest, int DestX, int DestY) const;
+
+public:
+    // Запас под подписи и линии управления, выходящие за границы элемента
+    static const int ElementMargin = 30;
+    static const int ExportTileSize = 256;
+    // Предел памяти под полосу потокового экспорта
+    static const size_t ExportBandBytes = 64 * 1024 * 1024;
+
+    // Ход экспорта: готово строк из общего числа
+    typedef std::function<void(int RowsDone, int RowsTotal)> TProgressFunc;
+
+    TSceneRenderer();
+
+    void Clear();
+    void AddWire(const std::vector<TPoint>& Path, TColor Color, bool Rectangular);
+    void AddElement(TCircuitElement* Element);
+
+    bool IsEmpty() const { return FEmpty; }
+    // Габариты сцены в логических координатах
+    TRect GetBounds() const { return FBounds; }
+    // Преобразование, совмещающее левый верхний угол сцены с началом изображения
+    TViewTransform GetExportView(double Zoom) const;
+    int GetImageWidth(double Zoom) const { return static_cast<int>(FBounds.Width() * Zoom) + 1; }
+    int GetImageHeight(double Zoom) const { return static_cast<int>(FBounds.Height() * Zoom) + 1; }
+
+    // Clip - область цели в координатах после преобразования View
+    void Render(TRenderTarget* Target, const TViewTransform& View, const TRect& Clip) const;
+
+    // Сцена целиком в растр; плитки рисуются параллельно
+    void RenderToRaster(TRasterRenderTarget& Image, double Zoom, unsigned ThreadCount = 0) const;
+    std::string RenderToSvg(double Zoom) const;
+    // Потоковый экспорт в PNG: полосы плиток рисуются параллельно и сразу сжимаются,
+    // в памяти одновременно только одна полоса. false - ошибка записи в Out
+    bool RenderToPng(std::ostream& Out, double Zoom, const TProgressFunc& Progress = nullptr,
+                     unsigned ThreadCount = 0) const;
+
+    // Запись ломаной соединения со стрелкой и мостиками; Scale - масштаб стрелок прямых соединений
+    static void RecordWire(TDisplayList& List, const std::vector<TPoint>& Path, TColor Color,
+                           bool Rectangular, bool Simple, double Scale);
+};
+
+#endif
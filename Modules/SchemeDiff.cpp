@@ -0,0 +1,411 @@
+#include "SchemeDiff.h"
+#include <sstream>
+#include <unordered_map>
+
+#pragma package(smart_init)
+
+namespace {
+    struct TDiffElement {
+        TNetlistElement Record;
+        uint64_t Content;       // хеш содержимого подсхемы, у элемента 0
+        uint64_t Place;         // хеш класса и положения
+        uint64_t Shape;         // хеш всего, кроме Id и положения
+    };
+
+    struct TDiffSide {
+        std::vector<TDiffElement> Elements;
+        std::unordered_map<int32_t, size_t> ById;
+        std::vector<std::pair<TNetlistPin, TNetlistPin>> Connections;
+    };
+
+    // Соединение в общей для двух версий нумерации элементов
+    struct TConnectionKey {
+        size_t From;
+        size_t To;
+        uint32_t FromPort;
+        uint32_t ToPort;
+        bool FromInput;
+        bool ToInput;
+
+        bool operator==(const TConnectionKey& Other) const {
+            return From == Other.From && To == Other.To && FromPort == Other.FromPort &&
+                   ToPort == Other.ToPort && FromInput == Other.FromInput && ToInput == Other.ToInput;
+        }
+    };
+
+    // Добавление числа к хешу FNV-1a
+    uint64_t HashMix(uint64_t Hash, uint64_t Value) {
+        return (Hash ^ Value) * 1099511628211ULL;
+    }
+
+    struct TConnectionKeyHash {
+        size_t operator()(const TConnectionKey& Key) const {
+            uint64_t hash = 14695981039346656037ULL;
+            hash = HashMix(hash, Key.From);
+            hash = HashMix(hash, Key.To);
+            hash = HashMix(hash, Key.FromPort);
+            hash = HashMix(hash, Key.ToPort);
+            hash = HashMix(hash, (uint64_t)Key.FromInput << 1 | (uint64_t)Key.ToInput);
+            return (size_t)hash;
+        }
+    };
+
+    const size_t Unmatched = (size_t)-1;
+
+    // Строки записей пишутся тем же форматом, что и список соединений
+    std::string ElementLine(const TNetlistElement& Element) {
+        std::ostringstream stream;
+        TNetlistWriter writer(stream);
+        if (Element.ClassName.empty()) {
+            writer.BeginSubCircuit(Element);
+        } else {
+            writer.WriteElement(Element);
+        }
+        std::string line = stream.str();
+        if (!line.empty()) line.erase(line.size() - 1);
+        return line;
+    }
+
+    std::string NetLine(const TNetlistPin& From, const TNetlistPin& To) {
+        std::vector<TNetlistPin> pins;
+        pins.push_back(From);
+        pins.push_back(To);
+
+        std::ostringstream stream;
+        TNetlistWriter writer(stream);
+        writer.WriteNet(pins);
+        std::string line = stream.str();
+        if (!line.empty()) line.erase(line.size() - 1);
+        return line;
+    }
+
+    // Хеши канонической строки элемента; Line - переиспользуемый буфер строки
+    void FinishElement(TDiffElement& Element, std::ostringstream& Line, TNetlistWriter& Writer, bool CompareState) {
+        TNetlistElement& record = Element.Record;
+        int32_t id = record.Id;
+        int32_t left = record.Left;
+        int32_t top = record.Top;
+        int32_t state = record.State;
+        std::vector<std::pair<std::string, int32_t>> stateParams;
+
+        record.Id = record.Left = record.Top = 0;
+        if (!CompareState) {
+            record.State = 0;
+            stateParams.swap(record.StateParams);
+        }
+        Line.str(std::string());
+        Writer.WriteElement(record);
+        record.Id = id;
+        record.Left = left;
+        record.Top = top;
+        if (!CompareState) {
+            record.State = state;
+            stateParams.swap(record.StateParams);
+        }
+
+        Element.Shape = HashMix(NetlistHash(Line.str()), Element.Content);
+        Element.Place = HashMix(HashMix(NetlistHash(record.ClassName), (uint32_t)left), (uint32_t)top);
+    }
+
+    // Элементы и соединения верхнего уровня; содержимое подсхемы сводится к
+    // хешу его текста, переписанного в каноническом виде
+    bool ReadSide(std::istream& Stream, TDiffSide& Side, bool CompareState,
+                  TNetlistReader::TError& Error, size_t& Line) {
+        TNetlistReader reader(Stream);
+        TNetlistRecord record;
+
+        std::ostringstream content;
+        TNetlistWriter contentWriter(content);
+        std::ostringstream line;
+        TNetlistWriter lineWriter(line);
+        int depth = 0;
+
+        while (reader.Next(record)) {
+            if (depth > 0) {
+                if (!CompareState) {
+                    record.Element.State = 0;
+                    record.Element.StateParams.clear();
+                }
+                switch (record.Kind) {
+                case nrElement: contentWriter.WriteElement(record.Element); break;
+                case nrSubCircuit: contentWriter.BeginSubCircuit(record.Element); depth++; break;
+                case nrNet: contentWriter.WriteNet(record.Pins); break;
+                case nrNextId: break;
+                case nrEnd:
+                    if (--depth > 0) {
+                        contentWriter.EndSubCircuit();
+                    } else {
+                        TDiffElement& element = Side.Elements.back();
+                        element.Content = NetlistHash(content.str());
+                        FinishElement(element, line, lineWriter, CompareState);
+                    }
+                    break;
+                }
+                continue;
+            }
+
+            switch (record.Kind) {
+            case nrElement:
+            case nrSubCircuit: {
+                Side.ById[record.Element.Id] = Side.Elements.size();
+                Side.Elements.push_back(TDiffElement());
+                TDiffElement& element = Side.Elements.back();
+                element.Record = record.Element;
+                element.Content = 0;
+                if (record.Kind == nrSubCircuit) {
+                    content.str(std::string());
+                    depth = 1;
+                } else {
+                    FinishElement(element, line, lineWriter, CompareState);
+                }
+                break;
+            }
+            case nrNet:
+                for (size_t i = 1; i < record.Pins.size(); i++) {
+                    Side.Connections.push_back(std::make_pair(record.Pins[0], record.Pins[i]));
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        Error = reader.GetError();
+        Line = reader.GetLineNumber();
+        return Error == TNetlistReader::neNone;
+    }
+
+    // Сопоставление оставшихся элементов по ключу; при совпадении хеша
+    // ключи сверяются полностью
+    template <typename TKey, typename TEqual>
+    void MatchByKey(const TDiffSide& Old, const TDiffSide& New,
+                    std::vector<size_t>& OldMatch, std::vector<size_t>& NewMatch,
+                    TKey Key, TEqual Equal) {
+        std::unordered_map<uint64_t, std::vector<size_t>> candidates;
+        for (size_t j = New.Elements.size(); j-- > 0;) {
+            if (NewMatch[j] == Unmatched) candidates[Key(New.Elements[j])].push_back(j);
+        }
+
+        for (size_t i = 0; i < Old.Elements.size(); i++) {
+            if (OldMatch[i] != Unmatched) continue;
+
+            auto bucket = candidates.find(Key(Old.Elements[i]));
+            if (bucket == candidates.end()) continue;
+
+            // Кандидаты лежат в обратном порядке: первым берется более ранний
+            std::vector<size_t>& list = bucket->second;
+            for (size_t k = list.size(); k-- > 0;) {
+                size_t j = list[k];
+                if (Equal(Old.Elements[i], New.Elements[j])) {
+                    OldMatch[i] = j;
+                    NewMatch[j] = i;
+                    list.erase(list.begin() + k);
+                    break;
+                }
+            }
+        }
+    }
+
+    unsigned ChangedFields(const TDiffElement& Old, const TDiffElement& New, bool CompareState) {
+        const TNetlistElement& a = Old.Record;
+        const TNetlistElement& b = New.Record;
+        unsigned fields = 0;
+        if (a.Id != b.Id) fields |= dfId;
+        if (a.Left != b.Left || a.Top != b.Top) fields |= dfPosition;
+        if (a.Width != b.Width || a.Height != b.Height) fields |= dfSize;
+        if (CompareState && (a.State != b.State || a.StateParams != b.StateParams)) fields |= dfState;
+        if (a.Params != b.Params) fields |= dfParams;
+        if (a.HasName != b.HasName || a.Name != b.Name) fields |= dfName;
+        if (Old.Content != New.Content) fields |= dfContent;
+        return fields;
+    }
+}
+
+bool TSchemeDiff::Compare(std::istream& Old, std::istream& New) {
+    FElements.clear();
+    FConnections.clear();
+    FError = TNetlistReader::neNone;
+
+    TDiffSide oldSide;
+    TDiffSide newSide;
+    if (!ReadSide(Old, oldSide, FCompareState, FError, FErrorLine)) {
+        FErrorInNew = false;
+        return false;
+    }
+    if (!ReadSide(New, newSide, FCompareState, FError, FErrorLine)) {
+        FErrorInNew = true;
+        return false;
+    }
+
+    std::vector<size_t> oldMatch(oldSide.Elements.size(), Unmatched);
+    std::vector<size_t> newMatch(newSide.Elements.size(), Unmatched);
+
+    // Сначала по Id при том же классе
+    for (size_t i = 0; i < oldSide.Elements.size(); i++) {
+        const TNetlistElement& record = oldSide.Elements[i].Record;
+        auto it = newSide.ById.find(record.Id);
+        if (it != newSide.ById.end() && newMatch[it->second] == Unmatched &&
+            newSide.Elements[it->second].Record.ClassName == record.ClassName) {
+            oldMatch[i] = it->second;
+            newMatch[it->second] = i;
+        }
+    }
+
+    // Затем перенумерованные: тот же класс на том же месте, потом тот же
+    // элемент целиком на другом месте
+    MatchByKey(oldSide, newSide, oldMatch, newMatch,
+        [](const TDiffElement& Element) { return Element.Place; },
+        [](const TDiffElement& A, const TDiffElement& B) {
+            return A.Record.ClassName == B.Record.ClassName &&
+                   A.Record.Left == B.Record.Left && A.Record.Top == B.Record.Top;
+        });
+    MatchByKey(oldSide, newSide, oldMatch, newMatch,
+        [](const TDiffElement& Element) { return Element.Shape; },
+        [this](const TDiffElement& A, const TDiffElement& B) {
+            return A.Record.ClassName == B.Record.ClassName &&
+                   (ChangedFields(A, B, FCompareState) & ~(dfId | dfPosition)) == 0;
+        });
+
+    for (size_t i = 0; i < oldSide.Elements.size(); i++) {
+        TElementDiff diff;
+        diff.Old = oldSide.Elements[i].Record;
+        diff.Fields = 0;
+        if (oldMatch[i] == Unmatched) {
+            diff.Kind = dkRemoved;
+        } else {
+            diff.Fields = ChangedFields(oldSide.Elements[i], newSide.Elements[oldMatch[i]], FCompareState);
+            if (!diff.Fields) continue;
+            diff.Kind = dkModified;
+            diff.New = newSide.Elements[oldMatch[i]].Record;
+        }
+        FElements.push_back(diff);
+    }
+    for (size_t j = 0; j < newSide.Elements.size(); j++) {
+        if (newMatch[j] != Unmatched) continue;
+        TElementDiff diff;
+        diff.Kind = dkAdded;
+        diff.New = newSide.Elements[j].Record;
+        diff.Fields = 0;
+        FElements.push_back(diff);
+    }
+
+    // Общая нумерация: сопоставленные элементы - индекс в старой версии,
+    // остальные новые - за концом старой
+    auto oldKey = [&](const std::pair<TNetlistPin, TNetlistPin>& Connection, TConnectionKey& Key) {
+        auto from = oldSide.ById.find(Connection.first.Element);
+        auto to = oldSide.ById.find(Connection.second.Element);
+        if (from == oldSide.ById.end() || to == oldSide.ById.end()) return false;
+        Key.From = from->second;
+        Key.To = to->second;
+        Key.FromPort = Connection.first.Port;
+        Key.ToPort = Connection.second.Port;
+        Key.FromInput = Connection.first.IsInput;
+        Key.ToInput = Connection.second.IsInput;
+        return true;
+    };
+    auto newKey = [&](const std::pair<TNetlistPin, TNetlistPin>& Connection, TConnectionKey& Key) {
+        auto from = newSide.ById.find(Connection.first.Element);
+        auto to = newSide.ById.find(Connection.second.Element);
+        if (from == newSide.ById.end() || to == newSide.ById.end()) return false;
+        size_t fromMatch = newMatch[from->second];
+        size_t toMatch = newMatch[to->second];
+        Key.From = fromMatch != Unmatched ? fromMatch : oldSide.Elements.size() + from->second;
+        Key.To = toMatch != Unmatched ? toMatch : oldSide.Elements.size() + to->second;
+        Key.FromPort = Connection.first.Port;
+        Key.ToPort = Connection.second.Port;
+        Key.FromInput = Connection.first.IsInput;
+        Key.ToInput = Connection.second.IsInput;
+        return true;
+    };
+
+    // Соединения считаются с кратностью: повтор одного соединения - тоже разница
+    // Ссылки на счетчики остаются верными при росте таблицы
+    std::unordered_map<TConnectionKey, size_t, TConnectionKeyHash> remaining;
+    remaining.reserve(oldSide.Connections.size());
+    std::vector<size_t*> oldCounts(oldSide.Connections.size(), nullptr);
+    TConnectionKey key;
+    for (size_t i = 0; i < oldSide.Connections.size(); i++) {
+        if (oldKey(oldSide.Connections[i], key)) {
+            oldCounts[i] = &remaining[key];
+            ++*oldCounts[i];
+        }
+    }
+
+    std::vector<TConnectionDiff> added;
+    for (const auto& connection : newSide.Connections) {
+        if (!newKey(connection, key)) continue;
+        auto it = remaining.find(key);
+        if (it != remaining.end() && it->second > 0) {
+            it->second--;
+            continue;
+        }
+        TConnectionDiff diff;
+        diff.Kind = dkAdded;
+        diff.From = connection.first;
+        diff.To = connection.second;
+        added.push_back(diff);
+    }
+
+    for (size_t i = 0; i < oldSide.Connections.size(); i++) {
+        if (!oldCounts[i] || *oldCounts[i] == 0) continue;
+        --*oldCounts[i];
+        TConnectionDiff diff;
+        diff.Kind = dkRemoved;
+        diff.From = oldSide.Connections[i].first;
+        diff.To = oldSide.Connections[i].second;
+        FConnections.push_back(diff);
+    }
+    FConnections.insert(FConnections.end(), added.begin(), added.end());
+    return true;
+}
+
+size_t TSchemeDiff::Count(TDiffKind Kind) const {
+    size_t count = 0;
+    for (const auto& element : FElements) {
+        if (element.Kind == Kind) count++;
+    }
+    return count;
+}
+
+size_t TSchemeDiff::CountConnections(TDiffKind Kind) const {
+    size_t count = 0;
+    for (const auto& connection : FConnections) {
+        if (connection.Kind == Kind) count++;
+    }
+    return count;
+}
+
+void TSchemeDiff::WriteReport(std::ostream& Stream) const {
+    Stream << "# elements +" << Count(dkAdded) << " -" << Count(dkRemoved) << " ~" << Count(dkModified)
+           << ", connections +" << CountConnections(dkAdded) << " -" << CountConnections(dkRemoved) << '\n';
+
+    for (const auto& element : FElements) {
+        if (element.Kind != dkModified) {
+            Stream << (element.Kind == dkAdded ? "+ " : "- ")
+                   << ElementLine(element.Kind == dkAdded ? element.New : element.Old) << '\n';
+            continue;
+        }
+
+        // Измененный: прежняя запись и список отличий
+        const TNetlistElement& a = element.Old;
+        const TNetlistElement& b = element.New;
+        Stream << "~ " << ElementLine(a) << " #";
+        if (element.Fields & dfId) Stream << " id=" << b.Id;
+        if (element.Fields & dfPosition) Stream << " position=" << b.Left << ',' << b.Top;
+        if (element.Fields & dfSize) Stream << " size=" << b.Width << 'x' << b.Height;
+        if (element.Fields & dfState) {
+            Stream << " state=" << b.State;
+            for (const auto& param : b.StateParams) {
+                Stream << " state." << param.first << '=' << param.second;
+            }
+        }
+        if (element.Fields & dfParams) Stream << " params";
+        if (element.Fields & dfName) Stream << " name";
+        if (element.Fields & dfContent) Stream << " content";
+        Stream << '\n';
+    }
+
+    for (const auto& connection : FConnections) {
+        Stream << (connection.Kind == dkAdded ? "+ " : "- ") << NetLine(connection.From, connection.To) << '\n';
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef SchemeDiffH
+#define SchemeDiffH
+
+#include "NetlistFile.h"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Структурное сравнение двух версий схемы по их спискам соединений.
+// Элементы сопоставляются по Id, оставшиеся - по классу и положению, затем
+// по классу и содержимому. Каждый элемент и каждое соединение сводятся к хешу
+// канонической строки, поэтому время линейно по размеру схем, а нумерация
+// секций и порядок элементов в файлах на результат не влияют.
+// Подсхема сравнивается с содержимым целиком: любое изменение внутри - это
+// изменение подсхемы. Состояния элементов (state и параметры state.*) -
+// результат моделирования, а не структура схемы: по умолчанию они не сравниваются
+
+enum TDiffKind { dkAdded, dkRemoved, dkModified };
+
+// Что изменилось у сопоставленного элемента
+enum TDiffField {
+    dfId = 1,
+    dfPosition = 2,
+    dfSize = 4,
+    dfState = 8,                // только при SetCompareState(true)
+    dfParams = 16,
+    dfName = 32,
+    dfContent = 64
+};
+
+struct TElementDiff {
+    TDiffKind Kind;
+    TNetlistElement Old;        // у добавленного не заполнен
+    TNetlistElement New;        // у удаленного не заполнен
+    unsigned Fields;            // TDiffField, только у измененного
+};
+
+// Соединение от вывода From к выводу To; Id элементов - из той версии,
+// где соединение есть
+struct TConnectionDiff {
+    TDiffKind Kind;             // dkAdded или dkRemoved
+    TNetlistPin From;
+    TNetlistPin To;
+};
+
+class TSchemeDiff {
+private:
+    std::vector<TElementDiff> FElements;
+    std::vector<TConnectionDiff> FConnections;
+    TNetlistReader::TError FError;
+    bool FErrorInNew;
+    size_t FErrorLine;
+    bool FCompareState;
+
+public:
+    TSchemeDiff() : FError(TNetlistReader::neNone), FErrorInNew(false), FErrorLine(0), FCompareState(false) {}
+
+    // Учитывать состояния элементов и содержимого подсхем; задается до Compare
+    void SetCompareState(bool Value) { FCompareState = Value; }
+    bool GetCompareState() const { return FCompareState; }
+
+    // false - один из списков не читается (GetError)
+    bool Compare(std::istream& Old, std::istream& New);
+
+    const std::vector<TElementDiff>& GetElements() const { return FElements; }
+    const std::vector<TConnectionDiff>& GetConnections() const { return FConnections; }
+    bool IsEmpty() const { return FElements.empty() && FConnections.empty(); }
+    size_t Count(TDiffKind Kind) const;
+    size_t CountConnections(TDiffKind Kind) const;
+
+    TNetlistReader::TError GetError() const { return FError; }
+    bool IsErrorInNew() const { return FErrorInNew; }
+    size_t GetErrorLine() const { return FErrorLine; }
+
+    // Отчет в синтаксисе списка соединений, UTF-8: строки "-" - удалено,
+    // "+" - добавлено, "~" - изменено; первая строка - итог
+    void WriteReport(std::ostream& Stream) const;
+};
+
+#endif
@@ -0,0 +1,579 @@
+#include "SchemeFile.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include "NarrowPath.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#pragma package(smart_init)
+
+namespace {
+    const char SchemeMagic[8] = { 'S', 'E', 'T', 'U', 'N', 'B', 'I', 'N' };
+
+    // Таблицы выравниваются на 8 байт, чтобы записи читались из отображения напрямую
+    const uint32_t TableAlignment = 8;
+
+    static_assert(sizeof(TSchemeFileHeader) == 72, "TSchemeFileHeader layout");
+    static_assert(sizeof(TSchemeElementRecord) == 56, "TSchemeElementRecord layout");
+    static_assert(sizeof(TSchemePortRecord) == 24, "TSchemePortRecord layout");
+    static_assert(sizeof(TSchemeConnectionRecord) == 20, "TSchemeConnectionRecord layout");
+    static_assert(sizeof(TSchemeParamRecord) == 8, "TSchemeParamRecord layout");
+
+    uint64_t Align(uint64_t Offset) {
+        return (Offset + TableAlignment - 1) & ~(uint64_t)(TableAlignment - 1);
+    }
+
+    void WritePadding(std::ostream& Stream, uint32_t& Position, uint32_t Target) {
+        static const char zeros[TableAlignment] = { 0 };
+        Stream.write(zeros, Target - Position);
+        Position = Target;
+    }
+
+    template <typename T>
+    void WriteTable(std::ostream& Stream, uint32_t& Position, const std::vector<T>& Table) {
+        if (!Table.empty()) {
+            Stream.write(reinterpret_cast<const char*>(Table.data()), Table.size() * sizeof(T));
+        }
+        Position += (uint32_t)(Table.size() * sizeof(T));
+    }
+
+    bool TableFits(uint32_t Offset, uint32_t Count, size_t RecordSize, size_t FileSize) {
+        if (Offset % TableAlignment != 0 || Offset > FileSize) return false;
+        return (unsigned long long)Count * RecordSize <= FileSize - Offset;
+    }
+}
+
+TSchemeFileBuilder::TSchemeFileBuilder() {
+    FStringOffsets.push_back(0);
+}
+
+uint32_t TSchemeFileBuilder::AddString(const std::string& Utf8) {
+    auto it = FStringIndex.find(Utf8);
+    if (it != FStringIndex.end()) return it->second;
+
+    uint32_t index = (uint32_t)FStringOffsets.size() - 1;
+    FStringData += Utf8;
+    FStringOffsets.push_back((uint32_t)FStringData.size());
+    FStringIndex[Utf8] = index;
+    return index;
+}
+
+uint32_t TSchemeFileBuilder::AddElement(const TSchemeElementRecord& Record) {
+    FElements.push_back(Record);
+    return (uint32_t)FElements.size() - 1;
+}
+
+uint32_t TSchemeFileBuilder::AddPort(const TSchemePortRecord& Record) {
+    FPorts.push_back(Record);
+    return (uint32_t)FPorts.size() - 1;
+}
+
+uint32_t TSchemeFileBuilder::AddParam(const TSchemeParamRecord& Record) {
+    FParams.push_back(Record);
+    return (uint32_t)FParams.size() - 1;
+}
+
+void TSchemeFileBuilder::AddConnection(const TSchemeConnectionRecord& Record) {
+    FConnections.push_back(Record);
+}
+
+bool TSchemeFileBuilder::Write(std::ostream& Stream, int NextElementId) const {
+    TSchemeFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.Magic, SchemeMagic, sizeof(header.Magic));
+    header.Version = SchemeFileVersion;
+    header.HeaderSize = sizeof(TSchemeFileHeader);
+    header.NextElementId = NextElementId;
+
+    // Раскладка таблиц: заголовок, элементы, порты, соединения, параметры, строки.
+    // Считается в 64 битах и проверяется до записи: переполнение 32-битных
+    // смещений дало бы файл, который нельзя открыть
+    uint64_t elementOffset = Align(sizeof(TSchemeFileHeader));
+    uint64_t portOffset = Align(elementOffset + (uint64_t)FElements.size() * sizeof(TSchemeElementRecord));
+    uint64_t connectionOffset = Align(portOffset + (uint64_t)FPorts.size() * sizeof(TSchemePortRecord));
+    uint64_t paramOffset = Align(connectionOffset + (uint64_t)FConnections.size() * sizeof(TSchemeConnectionRecord));
+    uint64_t stringOffset = Align(paramOffset + (uint64_t)FParams.size() * sizeof(TSchemeParamRecord));
+    uint64_t stringDataOffset = Align(stringOffset + (uint64_t)FStringOffsets.size() * sizeof(uint32_t));
+    uint64_t fileSize = stringDataOffset + (uint64_t)FStringData.size();
+    if (fileSize > SchemeFileMaxSize) return false;
+
+    header.ElementCount = (uint32_t)FElements.size();
+    header.ElementOffset = (uint32_t)elementOffset;
+    header.PortCount = (uint32_t)FPorts.size();
+    header.PortOffset = (uint32_t)portOffset;
+    header.ConnectionCount = (uint32_t)FConnections.size();
+    header.ConnectionOffset = (uint32_t)connectionOffset;
+    header.ParamCount = (uint32_t)FParams.size();
+    header.ParamOffset = (uint32_t)paramOffset;
+    header.StringCount = (uint32_t)FStringOffsets.size() - 1;
+    header.StringOffset = (uint32_t)stringOffset;
+    header.StringDataSize = (uint32_t)FStringData.size();
+    header.StringDataOffset = (uint32_t)stringDataOffset;
+    header.FileSize = (uint32_t)fileSize;
+
+    uint32_t position = 0;
+    Stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    position += sizeof(header);
+
+    WritePadding(Stream, position, header.ElementOffset);
+    WriteTable(Stream, position, FElements);
+    WritePadding(Stream, position, header.PortOffset);
+    WriteTable(Stream, position, FPorts);
+    WritePadding(Stream, position, header.ConnectionOffset);
+    WriteTable(Stream, position, FConnections);
+    WritePadding(Stream, position, header.ParamOffset);
+    WriteTable(Stream, position, FParams);
+    WritePadding(Stream, position, header.StringOffset);
+    WriteTable(Stream, position, FStringOffsets);
+    WritePadding(Stream, position, header.StringDataOffset);
+    Stream.write(FStringData.data(), FStringData.size());
+
+    return !Stream.fail();
+}
+
+TSchemeFileView::TSchemeFileView()
+#ifdef _WIN32
+    : FFile(INVALID_HANDLE_VALUE), FMapping(nullptr),
+#else
+    : FFile(-1),
+#endif
+      FData(nullptr), FSize(0), FHeader(nullptr), FElements(nullptr), FPorts(nullptr),
+      FConnections(nullptr), FParams(nullptr), FStringOffsets(nullptr), FStringData(nullptr) {
+}
+
+TSchemeFileView::~TSchemeFileView() {
+    Close();
+}
+
+bool TSchemeFileView::Map(const wchar_t* FileName) {
+#ifdef _WIN32
+    FFile = CreateFileW(FileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (FFile == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(FFile, &size) || size.QuadPart < (LONGLONG)sizeof(TSchemeFileHeader) ||
+        (uint64_t)size.QuadPart > SchemeFileMaxSize) {
+        return false;
+    }
+    FSize = (size_t)size.QuadPart;
+
+    FMapping = CreateFileMappingW(FFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!FMapping) return false;
+
+    FData = static_cast<const unsigned char*>(MapViewOfFile(FMapping, FILE_MAP_READ, 0, 0, 0));
+    return FData != nullptr;
+#else
+    std::string path;
+    if (!NarrowPath(FileName, path)) return false;
+
+    FFile = open(path.c_str(), O_RDONLY);
+    if (FFile < 0) return false;
+
+    struct stat info;
+    if (fstat(FFile, &info) != 0 || info.st_size < (off_t)sizeof(TSchemeFileHeader) || (uint64_t)info.st_size > SchemeFileMaxSize) {
+        return false;
+    }
+    FSize = (size_t)info.st_size;
+
+    void* data = mmap(nullptr, FSize, PROT_READ, MAP_PRIVATE, FFile, 0);
+    if (data == MAP_FAILED) return false;
+    FData = static_cast<const unsigned char*>(data);
+    return true;
+#endif
+}
+
+bool TSchemeFileView::FixUp() {
+    FHeader = reinterpret_cast<const TSchemeFileHeader*>(FData);
+    const TSchemeFileHeader& h = *FHeader;
+
+    if (memcmp(h.Magic, SchemeMagic, sizeof(h.Magic)) != 0) return false;
+    if (h.Version < 1 || h.Version > SchemeFileVersion || h.HeaderSize != sizeof(TSchemeFileHeader)) return false;
+    if (h.FileSize != FSize) return false;
+
+    if (!TableFits(h.ElementOffset, h.ElementCount, sizeof(TSchemeElementRecord), FSize) ||
+        !TableFits(h.PortOffset, h.PortCount, sizeof(TSchemePortRecord), FSize) ||
+        !TableFits(h.ConnectionOffset, h.ConnectionCount, sizeof(TSchemeConnectionRecord), FSize) ||
+        !TableFits(h.ParamOffset, h.ParamCount, sizeof(TSchemeParamRecord), FSize) ||
+        h.StringCount == 0xFFFFFFFF ||
+        !TableFits(h.StringOffset, h.StringCount + 1, sizeof(uint32_t), FSize) ||
+        h.StringDataOffset > FSize || h.StringDataSize > FSize - h.StringDataOffset) {
+        return false;
+    }
+
+    SetTables();
+
+    // Проверка ссылок между таблицами - дальше записям можно доверять без проверок
+    for (uint32_t i = 0; i < h.StringCount; i++) {
+        if (FStringOffsets[i] > FStringOffsets[i + 1]) return false;
+    }
+    if (FStringOffsets[0] != 0 || FStringOffsets[h.StringCount] > h.StringDataSize) return false;
+
+    for (uint32_t i = 0; i < h.ElementCount; i++) {
+        const TSchemeElementRecord& e = FElements[i];
+        if (e.ClassName >= h.StringCount || e.Name >= h.StringCount) return false;
+        if (e.Parent != -1 && (e.Parent < 0 || (uint32_t)e.Parent >= i)) return false;
+        if ((unsigned long long)e.FirstPort + e.InputCount + e.OutputCount > h.PortCount) return false;
+        if ((unsigned long long)e.FirstParam + e.ParamCount > h.ParamCount) return false;
+    }
+
+    for (uint32_t i = 0; i < h.ParamCount; i++) {
+        if (FParams[i].Key >= h.StringCount) return false;
+    }
+
+    for (uint32_t i = 0; i < h.ConnectionCount; i++) {
+        const TSchemeConnectionRecord& c = FConnections[i];
+        if (c.Parent != -1 && (c.Parent < 0 || (uint32_t)c.Parent >= h.ElementCount)) return false;
+        if (c.FromElement >= h.ElementCount || c.ToElement >= h.ElementCount) return false;
+
+        const TSchemeElementRecord& from = FElements[c.FromElement];
+        const TSchemeElementRecord& to = FElements[c.ToElement];
+        if (c.FromPort < from.FirstPort || c.FromPort >= from.FirstPort + from.InputCount + from.OutputCount) return false;
+        if (c.ToPort < to.FirstPort || c.ToPort >= to.FirstPort + to.InputCount + to.OutputCount) return false;
+    }
+
+    return true;
+}
+
+void TSchemeFileView::SetTables() {
+    FHeader = reinterpret_cast<const TSchemeFileHeader*>(FData);
+    const TSchemeFileHeader& h = *FHeader;
+
+    FElements = reinterpret_cast<const TSchemeElementRecord*>(FData + h.ElementOffset);
+    FPorts = reinterpret_cast<const TSchemePortRecord*>(FData + h.PortOffset);
+    FConnections = reinterpret_cast<const TSchemeConnectionRecord*>(FData + h.ConnectionOffset);
+    FParams = reinterpret_cast<const TSchemeParamRecord*>(FData + h.ParamOffset);
+    FStringOffsets = reinterpret_cast<const uint32_t*>(FData + h.StringOffset);
+    FStringData = reinterpret_cast<const char*>(FData + h.StringDataOffset);
+}
+
+bool TSchemeFileView::Open(const wchar_t* FileName) {
+    Close();
+    if (Map(FileName) && FixUp()) return true;
+    Close();
+    return false;
+}
+
+bool TSchemeFileView::Open(std::vector<unsigned char>&& Data) {
+    Close();
+    if (Data.size() < sizeof(TSchemeFileHeader) || Data.size() > SchemeFileMaxSize) return false;
+
+    FOwned.swap(Data);
+    FData = FOwned.data();
+    FSize = FOwned.size();
+    if (FixUp()) return true;
+    Close();
+    return false;
+}
+
+void TSchemeFileView::Detach() {
+    if (!FData || !FOwned.empty()) return;
+
+    // Таблицы выровнены относительно начала файла, копия выделяется с тем же выравниванием
+    std::vector<unsigned char> copy(FData, FData + FSize);
+    size_t size = FSize;
+    Unmap();
+
+    FOwned.swap(copy);
+    FData = FOwned.data();
+    FSize = size;
+    SetTables();
+}
+
+void TSchemeFileView::Unmap() {
+#ifdef _WIN32
+    if (FData && FOwned.empty()) UnmapViewOfFile(FData);
+    if (FMapping) CloseHandle(FMapping);
+    if (FFile != INVALID_HANDLE_VALUE) CloseHandle(FFile);
+    FMapping = nullptr;
+    FFile = INVALID_HANDLE_VALUE;
+#else
+    if (FData && FOwned.empty()) munmap(const_cast<unsigned char*>(FData), FSize);
+    if (FFile >= 0) close(FFile);
+    FFile = -1;
+#endif
+    FData = nullptr;
+}
+
+void TSchemeFileView::Close() {
+    Unmap();
+    FOwned.clear();
+    FData = nullptr;
+    FSize = 0;
+    FHeader = nullptr;
+    FElements = nullptr;
+    FPorts = nullptr;
+    FConnections = nullptr;
+    FParams = nullptr;
+    FStringOffsets = nullptr;
+    FStringData = nullptr;
+}
+
+bool TSchemeFileView::HasSchemeMagic(const wchar_t* FileName) {
+    TSchemeFileView view;
+    return view.Map(FileName) && memcmp(view.FData, SchemeMagic, sizeof(SchemeMagic)) == 0;
+}
+
+const char* TSchemeFileView::GetString(uint32_t Index, size_t& Length) const {
+    Length = FStringOffsets[Index + 1] - FStringOffsets[Index];
+    return FStringData + FStringOffsets[Index];
+}
+
+bool TSchemeFileView::StringEquals(uint32_t Index, const char* Value) const {
+    size_t length;
+    const char* data = GetString(Index, length);
+    return strlen(Value) == length && memcmp(data, Value, length) == 0;
+}
+
+TSchemeImageEditor::TSchemeImageEditor(const std::vector<std::string>& StringParams)
+    : FStringParams(StringParams), FNextElementId(1) {
+}
+
+uint64_t TSchemeImageEditor::PortKey(const TPortRef& Port) {
+    return ((uint64_t)(uint32_t)Port.ElementId << 32) | ((uint64_t)(Port.IsInput ? 1 : 0) << 31) |
+           ((uint32_t)Port.Port & 0x7FFFFFFF);
+}
+
+bool TSchemeImageEditor::ReadElements(const std::string& Image, std::vector<TElement>& Elements,
+                                      std::vector<std::pair<TPortRef, TPortRef>>& Connections,
+                                      int32_t& NextElementId) const {
+    TSchemeFileView view;
+    if (!view.Open(std::vector<unsigned char>(Image.begin(), Image.end()))) return false;
+
+    const TSchemeFileHeader& header = view.GetHeader();
+    NextElementId = header.NextElementId;
+
+    auto readString = [&view](uint32_t Index) {
+        size_t length;
+        const char* data = view.GetString(Index, length);
+        return std::string(data, length);
+    };
+
+    Elements.reserve(header.ElementCount);
+    for (uint32_t i = 0; i < header.ElementCount; i++) {
+        const TSchemeElementRecord& record = view.GetElement(i);
+        // Образы прежней версии с содержимым подсхем в записях элементов
+        if (record.Parent != -1) return false;
+
+        TElement element;
+        element.Record = record;
+        element.ClassName = readString(record.ClassName);
+        element.Name = readString(record.Name);
+        element.Removed = false;
+
+        for (uint32_t p = 0; p < record.InputCount + record.OutputCount; p++) {
+            element.Ports.push_back(view.GetPort(record.FirstPort + p));
+        }
+        for (uint32_t p = 0; p < record.ParamCount; p++) {
+            const TSchemeParamRecord& source = view.GetParam(record.FirstParam + p);
+            TParam param;
+            param.Key = readString(source.Key);
+            param.Value = source.Value;
+            param.IsString = std::find(FStringParams.begin(), FStringParams.end(), param.Key) != FStringParams.end();
+            if (param.IsString) {
+                if (source.Value < 0 || (uint32_t)source.Value >= header.StringCount) return false;
+                param.Text = readString((uint32_t)source.Value);
+            }
+            element.Params.push_back(param);
+        }
+        Elements.push_back(element);
+    }
+
+    // Номер порта в файле сквозной, в ссылке - среди входов или выходов элемента
+    auto portRef = [&view](uint32_t Element, uint32_t Port) {
+        const TSchemeElementRecord& record = view.GetElement(Element);
+        uint32_t local = Port - record.FirstPort;
+        TPortRef ref;
+        ref.ElementId = record.Id;
+        ref.IsInput = local < record.InputCount;
+        ref.Port = (int32_t)(ref.IsInput ? local : local - record.InputCount);
+        return ref;
+    };
+
+    for (uint32_t i = 0; i < header.ConnectionCount; i++) {
+        const TSchemeConnectionRecord& record = view.GetConnection(i);
+        if (record.Parent != -1) return false;
+        Connections.push_back(std::make_pair(portRef(record.FromElement, record.FromPort),
+                                             portRef(record.ToElement, record.ToPort)));
+    }
+    return true;
+}
+
+bool TSchemeImageEditor::HasPort(const TPortRef& Port) const {
+    auto it = FIndex.find(Port.ElementId);
+    if (it == FIndex.end() || Port.Port < 0) return false;
+
+    const TSchemeElementRecord& record = FElements[it->second].Record;
+    return (uint32_t)Port.Port < (Port.IsInput ? record.InputCount : record.OutputCount);
+}
+
+void TSchemeImageEditor::RemoveConnection(size_t Index) {
+    TConnection& connection = FConnections[Index];
+    if (connection.Removed) return;
+
+    FConnectionIndex.erase(TConnectionKey(PortKey(connection.From), PortKey(connection.To)));
+    connection.Removed = true;
+}
+
+bool TSchemeImageEditor::Load(const std::string& Image) {
+    Clear();
+    return Image.empty() || Put(Image);
+}
+
+bool TSchemeImageEditor::Put(const std::string& Image) {
+    std::vector<TElement> elements;
+    std::vector<std::pair<TPortRef, TPortRef>> connections;
+    int32_t nextElementId;
+    if (!ReadElements(Image, elements, connections, nextElementId)) return false;
+
+    FNextElementId = std::max(FNextElementId, nextElementId);
+
+    for (TElement& element : elements) {
+        int32_t id = element.Record.Id;
+        auto existing = FIndex.find(id);
+        if (existing == FIndex.end()) {
+            FIndex[id] = FElements.size();
+            FElements.push_back(std::move(element));
+            continue;
+        }
+
+        FElements[existing->second] = std::move(element);
+
+        // Соединения с выводами, которых у нового элемента нет, удаляются
+        auto owned = FElementConnections.find(id);
+        if (owned == FElementConnections.end()) continue;
+        for (size_t index : owned->second) {
+            const TConnection& connection = FConnections[index];
+            if (!connection.Removed && (!HasPort(connection.From) || !HasPort(connection.To))) {
+                RemoveConnection(index);
+            }
+        }
+    }
+
+    for (const auto& connection : connections) {
+        Connect(connection.first, connection.second);
+    }
+    return true;
+}
+
+void TSchemeImageEditor::Remove(int32_t Id) {
+    auto it = FIndex.find(Id);
+    if (it == FIndex.end()) return;
+
+    auto owned = FElementConnections.find(Id);
+    if (owned != FElementConnections.end()) {
+        for (size_t index : owned->second) {
+            RemoveConnection(index);
+        }
+        FElementConnections.erase(owned);
+    }
+
+    FElements[it->second].Removed = true;
+    FIndex.erase(it);
+}
+
+void TSchemeImageEditor::Connect(const TPortRef& From, const TPortRef& To) {
+    if (!HasPort(From) || !HasPort(To)) return;
+
+    size_t index = FConnections.size();
+    if (!FConnectionIndex.emplace(TConnectionKey(PortKey(From), PortKey(To)), index).second) return;
+
+    TConnection connection = { From, To, false };
+    FConnections.push_back(connection);
+    FElementConnections[From.ElementId].push_back(index);
+    if (To.ElementId != From.ElementId) {
+        FElementConnections[To.ElementId].push_back(index);
+    }
+}
+
+void TSchemeImageEditor::Disconnect(const TPortRef& From, const TPortRef& To) {
+    auto it = FConnectionIndex.find(TConnectionKey(PortKey(From), PortKey(To)));
+    if (it != FConnectionIndex.end()) RemoveConnection(it->second);
+}
+
+void TSchemeImageEditor::Move(int32_t Id, int32_t Left, int32_t Top, int32_t Width, int32_t Height,
+                              const std::vector<std::pair<double, double>>& Ports) {
+    auto it = FIndex.find(Id);
+    if (it == FIndex.end()) return;
+
+    TElement& element = FElements[it->second];
+    element.Record.Left = Left;
+    element.Record.Top = Top;
+    element.Record.Width = Width;
+    element.Record.Height = Height;
+    for (size_t i = 0; i < Ports.size() && i < element.Ports.size(); i++) {
+        element.Ports[i].RelX = Ports[i].first;
+        element.Ports[i].RelY = Ports[i].second;
+    }
+}
+
+void TSchemeImageEditor::Clear() {
+    FNextElementId = 1;
+    FElements.clear();
+    FIndex.clear();
+    FConnections.clear();
+    FConnectionIndex.clear();
+    FElementConnections.clear();
+}
+
+bool TSchemeImageEditor::Write(std::string& Image) const {
+    TSchemeFileBuilder builder;
+    std::unordered_map<int32_t, uint32_t> elementIndex;
+
+    for (const TElement& element : FElements) {
+        if (element.Removed) continue;
+
+        TSchemeElementRecord record = element.Record;
+        record.ClassName = builder.AddString(element.ClassName);
+        record.Name = builder.AddString(element.Name);
+        record.Parent = -1;
+
+        record.FirstPort = builder.GetPortCount();
+        for (const TSchemePortRecord& port : element.Ports) {
+            builder.AddPort(port);
+        }
+
+        record.FirstParam = builder.GetParamCount();
+        for (const TParam& param : element.Params) {
+            TSchemeParamRecord target;
+            target.Key = builder.AddString(param.Key);
+            target.Value = param.IsString ? (int32_t)builder.AddString(param.Text) : param.Value;
+            builder.AddParam(target);
+        }
+        record.ParamCount = builder.GetParamCount() - record.FirstParam;
+
+        elementIndex[record.Id] = builder.AddElement(record);
+    }
+
+    for (const TConnection& connection : FConnections) {
+        if (connection.Removed) continue;
+
+        uint32_t from = elementIndex[connection.From.ElementId];
+        uint32_t to = elementIndex[connection.To.ElementId];
+        const TSchemeElementRecord& fromRecord = builder.GetElement(from);
+        const TSchemeElementRecord& toRecord = builder.GetElement(to);
+
+        TSchemeConnectionRecord record;
+        record.Parent = -1;
+        record.FromElement = from;
+        record.FromPort = fromRecord.FirstPort + (connection.From.IsInput ? 0 : fromRecord.InputCount) +
+                          (uint32_t)connection.From.Port;
+        record.ToElement = to;
+        record.ToPort = toRecord.FirstPort + (connection.To.IsInput ? 0 : toRecord.InputCount) +
+                        (uint32_t)connection.To.Port;
+        builder.AddConnection(record);
+    }
+
+    std::ostringstream stream;
+    if (!builder.Write(stream, FNextElementId)) return false;
+    Image = stream.str();
+    return true;
+}
@@ -0,0 +1,255 @@
+#ifndef SchemeFileH
+#define SchemeFileH
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Двоичный контейнер схемы. Все таблицы - массивы записей фиксированного
+// размера, поэтому файл читается прямо из отображения в память: при открытии
+// только проверяются границы и вычисляются указатели на таблицы.
+// Порядок байт - little-endian, смещения отсчитываются от начала файла
+
+// Версия 2: содержимое одинаковых подсхем хранится один раз, в таблице строк
+const uint32_t SchemeFileVersion = 2;
+
+// Смещения в файле 32-битные, отображение читается через size_t и int:
+// больший файл не записывается и не открывается
+const uint64_t SchemeFileMaxSize = 0x7FFFFFFF;
+
+struct TSchemeFileHeader {
+    char Magic[8];              // "SETUNBIN"
+    uint32_t Version;
+    uint32_t HeaderSize;
+    int32_t NextElementId;
+    uint32_t ElementCount;
+    uint32_t ElementOffset;
+    uint32_t PortCount;
+    uint32_t PortOffset;
+    uint32_t ConnectionCount;
+    uint32_t ConnectionOffset;
+    uint32_t ParamCount;
+    uint32_t ParamOffset;
+    uint32_t StringCount;
+    uint32_t StringOffset;      // StringCount + 1 смещений в области строк
+    uint32_t StringDataSize;
+    uint32_t StringDataOffset;  // строки UTF-8 без завершающего нуля
+    uint32_t FileSize;
+};
+
+// Элемент; внутренние элементы подсхемы ссылаются на нее через Parent
+struct TSchemeElementRecord {
+    int32_t Id;
+    uint32_t ClassName;
+    uint32_t Name;
+    int32_t Left;
+    int32_t Top;
+    int32_t Width;
+    int32_t Height;
+    int32_t State;
+    int32_t Parent;             // индекс записи подсхемы или -1
+    uint32_t FirstPort;         // сначала входы, за ними выходы
+    uint32_t InputCount;
+    uint32_t OutputCount;
+    uint32_t FirstParam;
+    uint32_t ParamCount;
+};
+
+struct TSchemePortRecord {
+    double RelX;
+    double RelY;
+    int32_t LineStyle;
+    int32_t Reserved;
+};
+
+// Соединение задается индексами элементов и портов, без поиска по координатам
+struct TSchemeConnectionRecord {
+    int32_t Parent;             // подсхема, которой принадлежит соединение, или -1
+    uint32_t FromElement;
+    uint32_t FromPort;
+    uint32_t ToElement;
+    uint32_t ToPort;
+};
+
+// Целочисленный параметр конкретного типа элемента
+struct TSchemeParamRecord {
+    uint32_t Key;
+    int32_t Value;
+};
+
+// Сборка файла в памяти и запись одним проходом
+class TSchemeFileBuilder {
+private:
+    std::vector<TSchemeElementRecord> FElements;
+    std::vector<TSchemePortRecord> FPorts;
+    std::vector<TSchemeConnectionRecord> FConnections;
+    std::vector<TSchemeParamRecord> FParams;
+    std::vector<uint32_t> FStringOffsets;
+    std::string FStringData;
+    std::unordered_map<std::string, uint32_t> FStringIndex;
+
+public:
+    TSchemeFileBuilder();
+
+    // Одинаковые строки (имена классов, ключи параметров) хранятся один раз
+    uint32_t AddString(const std::string& Utf8);
+
+    uint32_t AddElement(const TSchemeElementRecord& Record);
+    uint32_t AddPort(const TSchemePortRecord& Record);
+    uint32_t AddParam(const TSchemeParamRecord& Record);
+    void AddConnection(const TSchemeConnectionRecord& Record);
+
+    uint32_t GetPortCount() const { return (uint32_t)FPorts.size(); }
+    uint32_t GetParamCount() const { return (uint32_t)FParams.size(); }
+    TSchemeElementRecord& GetElement(uint32_t Index) { return FElements[Index]; }
+
+    // false - ошибка потока или образ больше SchemeFileMaxSize; во втором
+    // случае в поток ничего не пишется
+    bool Write(std::ostream& Stream, int NextElementId) const;
+};
+
+// Файл схемы, отображенный в память только для чтения
+class TSchemeFileView {
+private:
+#ifdef _WIN32
+    void* FFile;
+    void* FMapping;
+#else
+    int FFile;
+#endif
+    const unsigned char* FData;
+    size_t FSize;
+    // Копия файла после Detach; пока пуста, FData указывает в отображение
+    std::vector<unsigned char> FOwned;
+
+    const TSchemeFileHeader* FHeader;
+    const TSchemeElementRecord* FElements;
+    const TSchemePortRecord* FPorts;
+    const TSchemeConnectionRecord* FConnections;
+    const TSchemeParamRecord* FParams;
+    const uint32_t* FStringOffsets;
+    const char* FStringData;
+
+    bool Map(const wchar_t* FileName);
+    void Unmap();
+    bool FixUp();
+    void SetTables();
+
+    TSchemeFileView(const TSchemeFileView&);
+    TSchemeFileView& operator=(const TSchemeFileView&);
+
+public:
+    TSchemeFileView();
+    ~TSchemeFileView();
+
+    // false - файл не открылся, это не двоичная схема (например, INI) или она повреждена
+    bool Open(const wchar_t* FileName);
+    // То же для образа схемы, уже прочитанного в память
+    bool Open(std::vector<unsigned char>&& Data);
+    void Close();
+
+    // Переносит данные в память и закрывает файл: записи остаются доступны,
+    // а файл можно перезаписать. Для данных, которые читаются после загрузки
+    void Detach();
+
+    // Файл начинается с сигнатуры двоичной схемы, целостность не проверяется
+    static bool HasSchemeMagic(const wchar_t* FileName);
+
+    const TSchemeFileHeader& GetHeader() const { return *FHeader; }
+    const TSchemeElementRecord& GetElement(uint32_t Index) const { return FElements[Index]; }
+    const TSchemePortRecord& GetPort(uint32_t Index) const { return FPorts[Index]; }
+    const TSchemeConnectionRecord& GetConnection(uint32_t Index) const { return FConnections[Index]; }
+    const TSchemeParamRecord& GetParam(uint32_t Index) const { return FParams[Index]; }
+
+    // Строка из таблицы: указатель внутрь отображения и длина в байтах
+    const char* GetString(uint32_t Index, size_t& Length) const;
+    bool StringEquals(uint32_t Index, const char* Value) const;
+};
+
+// Правка образа схемы на уровне записей, без создания элементов: так журнал
+// автосохранения сворачивается в снимок вне потока интерфейса. Поддерживаются
+// образы без вложенных элементов - такие пишет текущая версия
+class TSchemeImageEditor {
+public:
+    // Вывод элемента: номер среди входов или выходов
+    struct TPortRef {
+        int32_t ElementId;
+        bool IsInput;
+        int32_t Port;
+    };
+
+private:
+    struct TParam {
+        std::string Key;
+        int32_t Value;
+        // Значение - номер строки в таблице, при записи строка переносится
+        bool IsString;
+        std::string Text;
+    };
+
+    struct TElement {
+        TSchemeElementRecord Record;
+        std::string ClassName;
+        std::string Name;
+        std::vector<TSchemePortRecord> Ports;
+        std::vector<TParam> Params;
+        bool Removed;
+    };
+
+    struct TConnection {
+        TPortRef From;
+        TPortRef To;
+        bool Removed;
+    };
+
+    typedef std::pair<uint64_t, uint64_t> TConnectionKey;
+
+    struct TConnectionKeyHash {
+        size_t operator()(const TConnectionKey& Key) const {
+            return std::hash<uint64_t>()(Key.first) * 31 + std::hash<uint64_t>()(Key.second);
+        }
+    };
+
+    std::vector<std::string> FStringParams;
+    int32_t FNextElementId;
+
+    // Элементы в порядке схемы; удаленные остаются до записи
+    std::vector<TElement> FElements;
+    std::unordered_map<int32_t, size_t> FIndex;
+    // Соединения в порядке появления, повторы не добавляются
+    std::vector<TConnection> FConnections;
+    std::unordered_map<TConnectionKey, size_t, TConnectionKeyHash> FConnectionIndex;
+    std::unordered_map<int32_t, std::vector<size_t>> FElementConnections;
+
+    static uint64_t PortKey(const TPortRef& Port);
+    bool ReadElements(const std::string& Image, std::vector<TElement>& Elements,
+                      std::vector<std::pair<TPortRef, TPortRef>>& Connections, int32_t& NextElementId) const;
+    bool HasPort(const TPortRef& Port) const;
+    void RemoveConnection(size_t Index);
+
+public:
+    // StringParams - ключи параметров, значения которых ссылаются на таблицу строк
+    explicit TSchemeImageEditor(const std::vector<std::string>& StringParams);
+
+    // Пустой образ - пустая схема. false - образ поврежден или не поддерживается
+    bool Load(const std::string& Image);
+
+    // Элементы образа заменяют элементы с теми же Id, остальные добавляются.
+    // Соединения замененного элемента переходят на выводы с теми же номерами
+    bool Put(const std::string& Image);
+    void Remove(int32_t Id);
+    void Connect(const TPortRef& From, const TPortRef& To);
+    void Disconnect(const TPortRef& From, const TPortRef& To);
+    // Положения выводов по порядку: сначала входы, затем выходы
+    void Move(int32_t Id, int32_t Left, int32_t Top, int32_t Width, int32_t Height,
+              const std::vector<std::pair<double, double>>& Ports);
+    void Clear();
+
+    bool Write(std::string& Image) const;
+};
+
+#endif
@@ -0,0 +1,425 @@
+#include "SchemeJournal.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include "NarrowPath.h"
+#include <unistd.h>
+#endif
+
+#pragma package(smart_init)
+
+namespace {
+    const char JournalMagic[8] = { 'S', 'E', 'T', 'U', 'N', 'J', 'N', 'L' };
+    const uint32_t JournalVersion = 1;
+    const size_t JournalHeaderSize = sizeof(JournalMagic) + sizeof(uint32_t);
+
+    // Запись: длина данных, контрольная сумма типа и данных, тип, данные
+    const size_t RecordHeaderSize = 2 * sizeof(uint32_t) + 1;
+
+    uint32_t Checksum(uint8_t Kind, const char* Data, size_t Length) {
+        // FNV-1a: оборванную или недописанную запись видно по несовпадению суммы
+        uint32_t hash = 2166136261u;
+        hash = (hash ^ Kind) * 16777619u;
+        for (size_t i = 0; i < Length; i++) {
+            hash = (hash ^ (unsigned char)Data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    void AppendUInt32(std::string& Data, uint32_t Value) {
+        char bytes[4] = { (char)Value, (char)(Value >> 8), (char)(Value >> 16), (char)(Value >> 24) };
+        Data.append(bytes, sizeof(bytes));
+    }
+
+    uint32_t ReadUInt32(const char* Data) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(Data);
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    }
+
+    std::string JournalHeader() {
+        std::string header(JournalMagic, sizeof(JournalMagic));
+        AppendUInt32(header, JournalVersion);
+        return header;
+    }
+
+    FILE* OpenFile(const std::wstring& FileName, const wchar_t* Mode) {
+#ifdef _WIN32
+        return _wfopen(FileName.c_str(), Mode);
+#else
+        std::string mode;
+        for (const wchar_t* m = Mode; *m; m++) mode += (char)*m;
+        std::string path;
+        return NarrowPath(FileName.c_str(), path) ? fopen(path.c_str(), mode.c_str()) : nullptr;
+#endif
+    }
+
+    bool ReadFile(const std::wstring& FileName, std::string& Data) {
+        FILE* file = OpenFile(FileName, L"rb");
+        if (!file) return false;
+
+        Data.clear();
+        char block[65536];
+        size_t read;
+        while ((read = fread(block, 1, sizeof(block), file)) > 0) {
+            Data.append(block, read);
+        }
+        bool ok = !ferror(file);
+        fclose(file);
+        return ok;
+    }
+
+    // Данные на диске, а не в кэше системы: снимок заменяет журнал только целиком записанным
+    bool SyncFile(FILE* File) {
+        if (fflush(File) != 0) return false;
+#ifdef _WIN32
+        return _commit(_fileno(File)) == 0;
+#else
+        return fsync(fileno(File)) == 0;
+#endif
+    }
+
+    bool ReplaceFile(const std::wstring& Source, const std::wstring& Target) {
+#ifdef _WIN32
+        return MoveFileExW(Source.c_str(), Target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        std::string source, target;
+        return NarrowPath(Source.c_str(), source) && NarrowPath(Target.c_str(), target) &&
+               rename(source.c_str(), target.c_str()) == 0;
+#endif
+    }
+
+    void RemoveFile(const std::wstring& FileName) {
+#ifdef _WIN32
+        DeleteFileW(FileName.c_str());
+#else
+        std::string path;
+        if (NarrowPath(FileName.c_str(), path)) unlink(path.c_str());
+#endif
+    }
+
+    // Длина неповрежденного начала журнала; Records - прочитанные записи
+    size_t ScanRecords(const std::string& Data, std::vector<TSchemeJournal::TRecord>* Records) {
+        if (Data.size() < JournalHeaderSize || memcmp(Data.data(), JournalMagic, sizeof(JournalMagic)) != 0 ||
+            ReadUInt32(Data.data() + sizeof(JournalMagic)) != JournalVersion) {
+            return 0;
+        }
+
+        size_t position = JournalHeaderSize;
+        while (Data.size() - position >= RecordHeaderSize) {
+            const char* record = Data.data() + position;
+            uint32_t length = ReadUInt32(record);
+            uint32_t checksum = ReadUInt32(record + 4);
+            uint8_t kind = (uint8_t)record[8];
+
+            if (length > Data.size() - position - RecordHeaderSize) break;
+            if (Checksum(kind, record + RecordHeaderSize, length) != checksum) break;
+
+            if (Records) {
+                TSchemeJournal::TRecord r;
+                r.Kind = kind;
+                r.Payload.assign(record + RecordHeaderSize, length);
+                Records->push_back(std::move(r));
+            }
+            position += RecordHeaderSize + length;
+        }
+        return position;
+    }
+}
+
+TSchemeJournal::TSchemeJournal(const std::wstring& BasePath, const TCompactor& Compactor, size_t MinCompactSize)
+    : FBasePath(BasePath), FSnapshotPath(GetSnapshotPath(BasePath)), FJournalPath(GetJournalPath(BasePath)),
+      FCompactor(Compactor), FMinCompactSize(MinCompactSize),
+      FBusy(false), FStopping(false), FJournalSize(0), FFailed(false), FNeedsSnapshot(false),
+      FImageLoaded(false), FWrittenSize(0) {
+    FThread = std::thread(&TSchemeJournal::Run, this);
+}
+
+TSchemeJournal::~TSchemeJournal() {
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        FStopping = true;
+    }
+    FWake.notify_one();
+    FThread.join();
+}
+
+void TSchemeJournal::Append(uint8_t Kind, const std::string& Payload) {
+    TTask task;
+    task.Type = ttJournal;
+    task.Data.reserve(RecordHeaderSize + Payload.size());
+    AppendUInt32(task.Data, (uint32_t)Payload.size());
+    AppendUInt32(task.Data, Checksum(Kind, Payload.data(), Payload.size()));
+    task.Data += (char)Kind;
+    task.Data += Payload;
+
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        FJournalSize += task.Data.size();
+        FQueue.push_back(std::move(task));
+    }
+    FWake.notify_one();
+}
+
+void TSchemeJournal::WriteSnapshot(std::string&& Image) {
+    TTask task;
+    task.Type = ttSnapshot;
+    task.Data = std::move(Image);
+
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        FJournalSize = 0;
+        FNeedsSnapshot = false;
+        FQueue.push_back(std::move(task));
+    }
+    FWake.notify_one();
+}
+
+void TSchemeJournal::Compact() {
+    TTask task;
+    task.Type = ttCompact;
+
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        FQueue.push_back(std::move(task));
+    }
+    FWake.notify_one();
+}
+
+bool TSchemeJournal::NeedsSnapshot() const {
+    std::lock_guard<std::mutex> lock(FMutex);
+    return FNeedsSnapshot;
+}
+
+size_t TSchemeJournal::GetJournalSize() const {
+    std::lock_guard<std::mutex> lock(FMutex);
+    return FJournalSize;
+}
+
+bool TSchemeJournal::IsHealthy() const {
+    std::lock_guard<std::mutex> lock(FMutex);
+    return !FFailed;
+}
+
+void TSchemeJournal::Flush() {
+    std::unique_lock<std::mutex> lock(FMutex);
+    FIdle.wait(lock, [this]() { return FQueue.empty() && !FBusy; });
+}
+
+void TSchemeJournal::Discard() {
+    {
+        // Несделанная запись больше не нужна
+        std::lock_guard<std::mutex> lock(FMutex);
+        FQueue.clear();
+        TTask task;
+        task.Type = ttDiscard;
+        FQueue.push_back(std::move(task));
+        FJournalSize = 0;
+        FFailed = false;
+    }
+    FWake.notify_one();
+    Flush();
+}
+
+void TSchemeJournal::Run() {
+    FILE* journal = nullptr;
+
+    for (;;) {
+        std::deque<TTask> tasks;
+        {
+            std::unique_lock<std::mutex> lock(FMutex);
+            FBusy = false;
+            if (FQueue.empty()) FIdle.notify_all();
+            FWake.wait(lock, [this]() { return FStopping || !FQueue.empty(); });
+            if (FQueue.empty()) break;
+            tasks.swap(FQueue);
+            FBusy = true;
+        }
+
+        bool ok = true;
+        std::string records;
+        for (size_t i = 0; i < tasks.size(); i++) {
+            TTask& task = tasks[i];
+            if (task.Type == ttJournal) {
+                // Подряд идущие записи уходят в файл одним вызовом
+                records += task.Data;
+                continue;
+            }
+
+            if (!records.empty()) {
+                ok = WriteJournal(journal, records) && ok;
+                records.clear();
+            }
+            if (task.Type == ttSnapshot) {
+                if (WriteSnapshot(journal, task.Data)) {
+                    FImage.swap(task.Data);
+                    FImageLoaded = true;
+                } else {
+                    ok = false;
+                }
+            } else if (task.Type == ttCompact) {
+                ok = Compact(journal) && ok;
+            } else {
+                if (journal) fclose(journal);
+                journal = nullptr;
+                RemoveFile(FJournalPath);
+                RemoveFile(FSnapshotPath);
+                FImage.clear();
+                FImageLoaded = false;
+                FWrittenSize = 0;
+            }
+        }
+        if (!records.empty()) ok = WriteJournal(journal, records) && ok;
+
+        // Журнал, переросший снимок, сворачивается здесь же: вызывающий поток
+        // не собирает образ всей схемы
+        if (ok && FCompactor && FWrittenSize > FMinCompactSize) {
+            bool needsSnapshot;
+            {
+                std::lock_guard<std::mutex> lock(FMutex);
+                needsSnapshot = FNeedsSnapshot;
+            }
+            // Непрочитанную основу Compact отметит как требующую снимка
+            if (!needsSnapshot && (!LoadImage() || FWrittenSize > FImage.size())) {
+                ok = Compact(journal);
+            }
+        }
+
+        if (!ok) {
+            std::lock_guard<std::mutex> lock(FMutex);
+            FFailed = true;
+        }
+    }
+
+    if (journal) fclose(journal);
+    std::lock_guard<std::mutex> lock(FMutex);
+    FBusy = false;
+    FIdle.notify_all();
+}
+
+bool TSchemeJournal::WriteJournal(FILE*& File, const std::string& Data) {
+    if (!File) {
+        // Журнал прошлой сессии продолжается; оборванный хвост отрезается,
+        // иначе записи после него не прочитались бы
+        std::string existing;
+        size_t valid = ReadFile(FJournalPath, existing) ? ScanRecords(existing, nullptr) : 0;
+        FWrittenSize = valid > JournalHeaderSize ? valid - JournalHeaderSize : 0;
+        if (valid == existing.size() && valid > 0) {
+            File = OpenFile(FJournalPath, L"ab");
+        } else {
+            File = OpenFile(FJournalPath, L"wb");
+            if (File) {
+                std::string prefix = valid > 0 ? existing.substr(0, valid) : JournalHeader();
+                if (fwrite(prefix.data(), 1, prefix.size(), File) != prefix.size()) {
+                    fclose(File);
+                    File = nullptr;
+                }
+            }
+        }
+        if (!File) return false;
+    }
+
+    // Без fflush запись осталась бы в буфере процесса и пропала бы при его падении
+    if (fwrite(Data.data(), 1, Data.size(), File) != Data.size() || fflush(File) != 0) return false;
+    FWrittenSize += Data.size();
+    return true;
+}
+
+bool TSchemeJournal::WriteSnapshot(FILE*& File, const std::string& Image) {
+    // Снимок пишется во временный файл и подменяет прежний целиком, так что
+    // при сбое на диске остается либо старый снимок, либо новый
+    std::wstring temp = FSnapshotPath + L".tmp";
+    FILE* file = OpenFile(temp, L"wb");
+    if (!file) return false;
+
+    bool ok = fwrite(Image.data(), 1, Image.size(), file) == Image.size() && SyncFile(file);
+    fclose(file);
+    if (!ok || !ReplaceFile(temp, FSnapshotPath)) {
+        RemoveFile(temp);
+        return false;
+    }
+
+    // Записи журнала вошли в снимок. Сбой до этой точки безопасен: повтор
+    // записей поверх снимка, который их уже содержит, ничего не меняет
+    if (File) fclose(File);
+    File = OpenFile(FJournalPath, L"wb");
+    if (!File) return false;
+
+    FWrittenSize = 0;
+    std::string header = JournalHeader();
+    return fwrite(header.data(), 1, header.size(), File) == header.size() && fflush(File) == 0;
+}
+
+bool TSchemeJournal::LoadImage() {
+    if (FImageLoaded) return true;
+
+    // Основа журнала: снимок, до первого снимка - файл схемы; нет файла - схема пуста
+    FImage.clear();
+    if (FileExists(FSnapshotPath)) {
+        if (!ReadFile(FSnapshotPath, FImage)) return false;
+    } else if (FileExists(FBasePath)) {
+        if (!ReadFile(FBasePath, FImage)) return false;
+    }
+    FImageLoaded = true;
+    return true;
+}
+
+bool TSchemeJournal::Compact(FILE*& File) {
+    if (!FCompactor) return true;
+
+    std::string image;
+    bool compacted = LoadImage();
+    if (compacted) {
+        // Журнала на диске еще может не быть - тогда снимок равен основе
+        std::vector<TRecord> records;
+        ReadRecords(FJournalPath, records);
+        try {
+            compacted = FCompactor(FImage, records, image);
+        } catch (...) {
+            compacted = false;
+        }
+    }
+    if (!compacted) {
+        // Основа не прочиталась, не двоичная (INI) или повреждена: журнал растет дальше, пока
+        // вызывающий поток не передаст снимок
+        std::lock_guard<std::mutex> lock(FMutex);
+        FNeedsSnapshot = true;
+        return true;
+    }
+
+    size_t written = FWrittenSize;
+    if (!WriteSnapshot(File, image)) return false;
+    FImage.swap(image);
+
+    std::lock_guard<std::mutex> lock(FMutex);
+    FJournalSize -= std::min(FJournalSize, written);
+    return true;
+}
+
+bool TSchemeJournal::ReadRecords(const std::wstring& JournalPath, std::vector<TRecord>& Records) {
+    Records.clear();
+    std::string data;
+    if (!ReadFile(JournalPath, data)) return false;
+    ScanRecords(data, &Records);
+    return true;
+}
+
+bool TSchemeJournal::FileExists(const std::wstring& FileName) {
+#ifdef _WIN32
+    DWORD attributes = GetFileAttributesW(FileName.c_str());
+    return attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+    std::string path;
+    return NarrowPath(FileName.c_str(), path) && access(path.c_str(), F_OK) == 0;
+#endif
+}
+
+void TSchemeJournal::DeleteFiles(const std::wstring& BasePath) {
+    RemoveFile(GetJournalPath(BasePath));
+    RemoveFile(GetSnapshotPath(BasePath));
+}
@@ -0,0 +1,107 @@
+#ifndef SchemeJournalH
+#define SchemeJournalH
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Автосохранение вкладки: каждое изменение дописывается в журнал короткой
+// записью, время от времени журнал сворачивается в полный снимок схемы.
+// Файлы пишет и журнал сворачивает фоновый поток, вызывающий поток только
+// ставит данные в очередь.
+// Состояние схемы = снимок (или исходный файл) + записи журнала по порядку
+class TSchemeJournal {
+public:
+    struct TRecord {
+        uint8_t Kind;
+        std::string Payload;
+    };
+
+    // Свертка в потоке журнала: образ схемы (пустой - схема пуста) и записи
+    // после него дают новый образ. false - образ не поддерживается
+    typedef std::function<bool(const std::string& Image, const std::vector<TRecord>& Records,
+                               std::string& Result)> TCompactor;
+
+private:
+    enum TTaskType { ttJournal, ttSnapshot, ttCompact, ttDiscard };
+
+    struct TTask {
+        TTaskType Type;
+        std::string Data;
+    };
+
+    std::wstring FBasePath;
+    std::wstring FSnapshotPath;
+    std::wstring FJournalPath;
+
+    TCompactor FCompactor;
+    size_t FMinCompactSize;
+
+    std::thread FThread;
+    mutable std::mutex FMutex;
+    std::condition_variable FWake;
+    std::condition_variable FIdle;
+    std::deque<TTask> FQueue;
+    bool FBusy;
+    bool FStopping;
+    size_t FJournalSize;
+    bool FFailed;
+    // Свертка в потоке не удалась - снимок должен построить вызывающий поток
+    bool FNeedsSnapshot;
+
+    // Данные потока журнала: последний снимок и объем записей после него
+    std::string FImage;
+    bool FImageLoaded;
+    size_t FWrittenSize;
+
+    void Run();
+    bool WriteJournal(FILE*& File, const std::string& Data);
+    bool WriteSnapshot(FILE*& File, const std::string& Image);
+    bool LoadImage();
+    bool Compact(FILE*& File);
+
+    TSchemeJournal(const TSchemeJournal&);
+    TSchemeJournal& operator=(const TSchemeJournal&);
+
+public:
+    // Журнал и снимок лежат рядом с BasePath; существующий журнал продолжается.
+    // Основа журнала - снимок, иначе двоичный файл BasePath, иначе пустая схема.
+    // Журнал больше MinCompactSize и снимка сворачивается через Compactor
+    TSchemeJournal(const std::wstring& BasePath, const TCompactor& Compactor, size_t MinCompactSize);
+    ~TSchemeJournal();
+
+    static std::wstring GetSnapshotPath(const std::wstring& BasePath) { return BasePath + L".autosave"; }
+    static std::wstring GetJournalPath(const std::wstring& BasePath) { return BasePath + L".autosave.journal"; }
+
+    void Append(uint8_t Kind, const std::string& Payload);
+    // Снимок заменяет журнал: записи, добавленные позже, попадут в новый журнал
+    void WriteSnapshot(std::string&& Image);
+    // Свернуть журнал в снимок в потоке журнала, не дожидаясь его роста
+    void Compact();
+    // Основу журнала поток прочитать не смог - нужен снимок через WriteSnapshot
+    bool NeedsSnapshot() const;
+
+    // Размер записей журнала после последнего снимка, включая очередь
+    size_t GetJournalSize() const;
+    // false - запись на диск не удалась, автосохранение не работает
+    bool IsHealthy() const;
+
+    // Дождаться записи всей очереди
+    void Flush();
+    // Остановить запись и удалить файлы автосохранения
+    void Discard();
+
+    // Записи журнала по порядку; оборванная при сбое последняя запись отбрасывается
+    static bool ReadRecords(const std::wstring& JournalPath, std::vector<TRecord>& Records);
+    static bool FileExists(const std::wstring& FileName);
+    static void DeleteFiles(const std::wstring& BasePath);
+};
+
+#endif
@@ -1,202 +1,2002 @@
-﻿#include "MainForm.h"
-#include "SerializationManager.h"
-
-#pragma package(smart_init)
-
-TSerializationManager::TSerializationManager(TMainForm* MainForm) 
-    : FMainForm(MainForm) {
-}
-
-void TSerializationManager::SaveSchemeToFile(const String& FileName, TTabData* TabData) {
-    if (!TabData) return;
-
-    std::unique_ptr<TIniFile> iniFile(new TIniFile(FileName));
-
-    // Сохраняем основную информацию
-    iniFile->WriteInteger("Scheme", "ElementCount", static_cast<int>(TabData->Elements.size()));
-    iniFile->WriteInteger("Scheme", "ConnectionCount", static_cast<int>(TabData->Connections.size()));
-    iniFile->WriteInteger("Scheme", "NextElementId", TabData->NextElementId);
-    iniFile->WriteString("Scheme", "Version", "3.0");
-
-    // Сохраняем элементы
-    for (int i = 0; i < TabData->Elements.size(); i++) {
-        String section = "Element_" + IntToStr(i);
-        SaveElementToIni(TabData->Elements[i].get(), iniFile.get(), section);
-    }
-
-    // Сохраняем соединения
-    for (int i = 0; i < TabData->Connections.size(); i++) {
-        String section = "Connection_" + IntToStr(i);
-        auto& connection = TabData->Connections[i];
-
-        if (connection.first && connection.second) {
-            SaveConnectionPoint(connection.first, iniFile.get(), section, "From");
-            SaveConnectionPoint(connection.second, iniFile.get(), section, "To");
-        }
-    }
-
-    iniFile->UpdateFile();
-}
-
-void TSerializationManager::LoadSchemeFromFile(const String& FileName, TTabData* TabData) {
-    if (!TabData) return;
-
-    std::unique_ptr<TIniFile> iniFile(new TIniFile(FileName));
-
-    String version = iniFile->ReadString("Scheme", "Version", "1.0");
-    if (version == "1.0") {
-        throw Exception("Формат файла устарел. Используйте новую версию для сохранения схем.");
-    }
-
-    int elementCount = iniFile->ReadInteger("Scheme", "ElementCount", 0);
-    int connectionCount = iniFile->ReadInteger("Scheme", "ConnectionCount", 0);
-    TabData->NextElementId = iniFile->ReadInteger("Scheme", "NextElementId", 1);
-
-    // Загружаем элементы
-    std::map<int, TCircuitElement*> idToElementMap;
-
-    for (int i = 0; i < elementCount; i++) {
-        String section = "Element_" + IntToStr(i);
-        auto element = LoadElementFromIni(iniFile.get(), section);
-
-        if (element) {
-            idToElementMap[element->Id] = element.get();
-            TabData->Elements.push_back(std::move(element));
-        }
-    }
-
-    // Загружаем соединения
-    for (int i = 0; i < connectionCount; i++) {
-        String section = "Connection_" + IntToStr(i);
-
-        TConnectionPoint* fromPoint = LoadConnectionPoint(iniFile.get(), section, "From", nullptr);
-        TConnectionPoint* toPoint = LoadConnectionPoint(iniFile.get(), section, "To", nullptr);
-
-        if (fromPoint && toPoint) {
-            // Находим реальные точки соединения в загруженных элементах
-            TCircuitElement* fromElement = idToElementMap[fromPoint->Owner->Id];
-            TCircuitElement* toElement = idToElementMap[toPoint->Owner->Id];
-
-            TConnectionPoint* realFromPoint = FindConnectionPointInElement(fromElement, fromPoint);
-            TConnectionPoint* realToPoint = FindConnectionPointInElement(toElement, toPoint);
-
-            if (realFromPoint && realToPoint) {
-                TabData->Connections.push_back(std::make_pair(realFromPoint, realToPoint));
-            }
-
-            delete fromPoint;
-            delete toPoint;
-        }
-    }
-}
-
-void TSerializationManager::SaveElementToIni(TCircuitElement* Element, TIniFile* IniFile, const String& Section) {
-    if (Element) {
-        Element->SaveToIni(IniFile, Section);
-    }
-}
-
-std::unique_ptr<TCircuitElement> TSerializationManager::LoadElementFromIni(TIniFile* IniFile, const String& Section) {
-    String className = IniFile->ReadString(Section, "ClassName", "");
-    int id = IniFile->ReadInteger(Section, "Id", 0);
-    int x = IniFile->ReadInteger(Section, "X", 0);
-    int y = IniFile->ReadInteger(Section, "Y", 0);
-
-    auto element = CreateElementByClassName(className, id, x, y);
-    if (element) {
-        element->LoadFromIni(IniFile, Section);
-    }
-
-    return element;
-}
-
-void TSerializationManager::SaveConnectionPoint(const TConnectionPoint* Point, TIniFile* IniFile,
-                                               const String& Section, const String& Prefix) {
-    if (!Point || !Point->Owner) return;
-
-    IniFile->WriteInteger(Section, Prefix + "ElementId", Point->Owner->Id);
-    IniFile->WriteFloat(Section, Prefix + "RelX", Point->RelX);
-    IniFile->WriteFloat(Section, Prefix + "RelY", Point->RelY);
-    IniFile->WriteBool(Section, Prefix + "IsInput", Point->IsInput);
-}
-
-TConnectionPoint* TSerializationManager::LoadConnectionPoint(TIniFile* IniFile, const String& Section,
-                                                            const String& Prefix, TCircuitElement* Owner) {
-    int elementId = IniFile->ReadInteger(Section, Prefix + "ElementId", -1);
-    if (elementId == -1) return nullptr;
-
-    // Создаем временный элемент-заглушку для точки соединения
-    auto tempElement = std::make_unique<TTempCircuitElement>(elementId);
-
-    auto point = new TConnectionPoint(
-        tempElement.get(),
-        0, 0,
-        TTernary::ZERO,
-        IniFile->ReadBool(Section, Prefix + "IsInput", true),
-        TLineStyle::POSITIVE_CONTROL
-    );
-
-    point->RelX = IniFile->ReadFloat(Section, Prefix + "RelX", 0);
-    point->RelY = IniFile->ReadFloat(Section, Prefix + "RelY", 0);
-
-    // Сохраняем временный элемент, чтобы избежать его уничтожения
-    static std::vector<std::unique_ptr<TCircuitElement>> tempElements;
-    tempElements.push_back(std::move(tempElement));
-
-    return point;
-}
-
-TConnectionPoint* TSerializationManager::FindConnectionPointInElement(TCircuitElement* element, 
-                                                                     const TConnectionPoint* pointTemplate) {
-    if (!element) return nullptr;
-
-    auto& points = pointTemplate->IsInput ? element->Inputs : element->Outputs;
-
-    for (auto& point : points) {
-        if (fabs(point.RelX - pointTemplate->RelX) < 0.001 &&
-            fabs(point.RelY - pointTemplate->RelY) < 0.001) {
-            return &point;
-        }
-    }
-
-    return nullptr;
-}
-
-std::unique_ptr<TCircuitElement> TSerializationManager::CreateElementByClassName(const String& ClassName, 
-                                                                                int Id, int X, int Y) {
-    if (ClassName == "TMagneticAmplifier") {
-        return std::make_unique<TMagneticAmplifier>(Id, X, Y, false);
-    } else if (ClassName == "TTernaryElement") {
-        return std::make_unique<TTernaryElement>(Id, X, Y);
-    } else if (ClassName == "TShiftRegister") {
-        return std::make_unique<TShiftRegister>(Id, X, Y, 4);
-    } else if (ClassName == "TTernaryTrigger") {
-        return std::make_unique<TTernaryTrigger>(Id, X, Y);
-    } else if (ClassName == "THalfAdder") {
-        return std::make_unique<THalfAdder>(Id, X, Y);
-    } else if (ClassName == "TTernaryAdder") {
-        return std::make_unique<TTernaryAdder>(Id, X, Y);
-    } else if (ClassName == "TDecoder") {
-        return std::make_unique<TDecoder>(Id, X, Y, 2);
-    } else if (ClassName == "TCounter") {
-        return std::make_unique<TCounter>(Id, X, Y, 3);
-    } else if (ClassName == "TDistributor") {
-        return std::make_unique<TDistributor>(Id, X, Y, 8);
-    } else if (ClassName == "TSwitch") {
-        return std::make_unique<TSwitch>(Id, X, Y, 3);
-    } else if (ClassName == "TLogicAnd") {
-        return std::make_unique<TLogicAnd>(Id, X, Y);
-    } else if (ClassName == "TLogicOr") {
-        return std::make_unique<TLogicOr>(Id, X, Y);
-    } else if (ClassName == "TLogicInhibit") {
-        return std::make_unique<TLogicInhibit>(Id, X, Y);
-    } else if (ClassName == "TGenerator") {
-        return std::make_unique<TGenerator>(Id, X, Y);
-    } else if (ClassName == "TSubCircuit") {
-        return std::make_unique<TSubCircuit>(Id, X, Y,
-            std::vector<std::unique_ptr<TCircuitElement>>(),
-            std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>());
-    }
-
-    return nullptr;
+﻿#include "MainForm.h"
+#include "SerializationManager.h"
+#include "ParallelLoop.h"
+#include <System.IOUtils.hpp>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#pragma package(smart_init)
+
+// Содержимое подсхемы в каноническом виде: список соединений с координатами
+// от левого верхнего угла элементов и Id от наименьшего Id, без состояний.
+// У одинаковых подсхем текст совпадает, в файле он хранится один раз
+struct TSubCircuitDefinition {
+    std::string Text;
+    uint64_t Hash;
+    size_t ElementCount;    // элементы верхнего уровня содержимого
+};
+
+// Состояние восстановления по журналу. Удаления и соединения копятся здесь
+// и переносятся в схему одним проходом в конце: запись журнала обходится
+// в объем своих данных, а не в размер схемы
+struct TJournalReplay {
+    typedef std::pair<TConnectionPoint*, TConnectionPoint*> TConnection;
+
+    struct TConnectionHash {
+        size_t operator()(const TConnection& Connection) const {
+            return std::hash<const void*>()(Connection.first) * 31 + std::hash<const void*>()(Connection.second);
+        }
+    };
+
+    TElementIdMap Elements;
+    // Место элемента в TTabData::Elements; удаленные остаются там до конца
+    std::unordered_map<TCircuitElement*, size_t> Slots;
+    std::unordered_set<TCircuitElement*> Removed;
+    // Соединения в порядке появления, у удаленного обнулены оба вывода
+    std::vector<TConnection> Connections;
+    std::unordered_map<TConnection, size_t, TConnectionHash> ConnectionIndex;
+    // Номера соединений элемента в Connections, включая удаленные
+    std::unordered_map<TCircuitElement*, std::vector<size_t>> ElementConnections;
+};
+
+namespace {
+    // Порции параллельной загрузки: элементов и соединений на одну задачу
+    const size_t ElementGrain = 256;
+    const size_t ConnectionGrain = 2048;
+
+    typedef std::unordered_map<const TConnectionPoint*, uint32_t> TPortIndex;
+    typedef std::unordered_map<const TCircuitElement*, uint32_t> TElementIndex;
+
+    // Параметры элемента пишутся прямо в таблицу параметров файла
+    class TSchemeParamWriter : public TElementParams {
+    private:
+        TSchemeFileBuilder& FBuilder;
+
+    public:
+        TSchemeParamWriter(TSchemeFileBuilder& Builder) : FBuilder(Builder) {}
+
+        void WriteInteger(const char* Key, int Value) override {
+            TSchemeParamRecord record;
+            record.Key = FBuilder.AddString(Key);
+            record.Value = Value;
+            FBuilder.AddParam(record);
+        }
+
+        int ReadInteger(const char* Key, int Default) const override { return Default; }
+    };
+
+    // Чтение параметров элемента из отображенного файла без копирования ключей
+    class TSchemeParamReader : public TElementParams {
+    private:
+        const TSchemeFileView& FView;
+        uint32_t FFirst;
+        uint32_t FCount;
+
+    public:
+        TSchemeParamReader(const TSchemeFileView& View, uint32_t First, uint32_t Count)
+            : FView(View), FFirst(First), FCount(Count) {}
+
+        void WriteInteger(const char* Key, int Value) override {}
+
+        int ReadInteger(const char* Key, int Default) const override {
+            for (uint32_t i = FFirst; i < FFirst + FCount; i++) {
+                const TSchemeParamRecord& param = FView.GetParam(i);
+                if (FView.StringEquals(param.Key, Key)) return param.Value;
+            }
+            return Default;
+        }
+    };
+
+    // Номер вывода среди входов или выходов владельца, -1 - вывод не принадлежит элементу
+    int PortIndexOf(const TConnectionPoint* Point) {
+        if (!Point || !Point->Owner) return -1;
+
+        const auto& points = Point->IsInput ? Point->Owner->Inputs : Point->Owner->Outputs;
+        if (!points.empty() && Point >= &points.front() && Point <= &points.back()) {
+            return static_cast<int>(Point - &points.front());
+        }
+        return -1;
+    }
+
+    // Параметры элемента в записи списка соединений
+    class TNetlistParams : public TElementParams {
+    private:
+        const std::vector<std::pair<std::string, int32_t>>& FParams;
+        std::vector<std::pair<std::string, int32_t>>* FTarget;
+
+    public:
+        // Запись параметров элемента в Params
+        TNetlistParams(std::vector<std::pair<std::string, int32_t>>& Params) : FParams(Params), FTarget(&Params) {}
+        // Только чтение
+        TNetlistParams(const std::vector<std::pair<std::string, int32_t>>& Params) : FParams(Params), FTarget(nullptr) {}
+
+        void WriteInteger(const char* Key, int Value) override {
+            if (FTarget) FTarget->push_back(std::make_pair(std::string(Key), (int32_t)Value));
+        }
+
+        int ReadInteger(const char* Key, int Default) const override {
+            for (const auto& param : FParams) {
+                if (param.first == Key) return param.second;
+            }
+            return Default;
+        }
+    };
+
+    // Буфер std::iostream поверх TStream: список соединений читается и пишется
+    // блоками, не собираясь в памяти целиком
+    class TStreamBuffer : public std::streambuf {
+    private:
+        TStream* FStream;
+        std::vector<char> FBuffer;
+
+        bool WriteOut() {
+            NativeInt count = pptr() - pbase();
+            if (count > 0) FStream->WriteBuffer(pbase(), count);
+            setp(&FBuffer[0], &FBuffer[0] + FBuffer.size());
+            return true;
+        }
+
+    protected:
+        int_type underflow() override {
+            int count = FStream->Read(&FBuffer[0], (int)FBuffer.size());
+            if (count <= 0) return traits_type::eof();
+            setg(&FBuffer[0], &FBuffer[0], &FBuffer[0] + count);
+            return traits_type::to_int_type(*gptr());
+        }
+
+        int_type overflow(int_type C) override {
+            WriteOut();
+            if (!traits_type::eq_int_type(C, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(C);
+                pbump(1);
+            }
+            return traits_type::not_eof(C);
+        }
+
+        int sync() override {
+            return WriteOut() ? 0 : -1;
+        }
+
+    public:
+        TStreamBuffer(TStream* Stream) : FStream(Stream), FBuffer(65536) {
+            setg(&FBuffer[0], &FBuffer[0], &FBuffer[0]);
+            setp(&FBuffer[0], &FBuffer[0] + FBuffer.size());
+        }
+    };
+
+    std::string ToUtf8(const String& Value) {
+        UTF8String utf8(Value);
+        return std::string(utf8.c_str(), utf8.Length());
+    }
+
+    String FromUtf8(const std::string& Value) {
+        return String(UTF8String(Value.data(), (int)Value.size()));
+    }
+
+    String NetlistErrorText(TNetlistReader::TError Error) {
+        switch (Error) {
+        case TNetlistReader::neHeader: return "это не список соединений";
+        case TNetlistReader::neVersion: return "неподдерживаемая версия формата";
+        case TNetlistReader::neNumber: return "неверное число";
+        case TNetlistReader::neUnexpectedEnd: return "end без subcircuit";
+        case TNetlistReader::neUnclosed: return "подсхема не закрыта строкой end";
+        default: return "синтаксическая ошибка";
+        }
+    }
+
+    // WriteStates = false - только структура: CurrentState пишется нулевым,
+    // параметры SaveState не пишутся
+    void WriteNetlistLevel(TNetlistWriter& Writer, const std::vector<TCircuitElement*>& Elements,
+                           const std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections,
+                           const TNetlistOffset& Offset, bool WriteStates) {
+        std::unordered_set<const TCircuitElement*> level(Elements.begin(), Elements.end());
+
+        TNetlistElement record;
+        for (auto element : Elements) {
+            record.Id = element->Id - Offset.Id;
+            record.ClassName = ToUtf8(element->GetClassName());
+            record.Name = ToUtf8(element->Name);
+            record.HasName = true;
+            record.Left = element->Bounds.Left - Offset.X;
+            record.Top = element->Bounds.Top - Offset.Y;
+            record.Width = element->Bounds.Width();
+            record.Height = element->Bounds.Height();
+            record.State = WriteStates ? static_cast<int32_t>(element->CurrentState) : 0;
+            record.Params.clear();
+            TNetlistParams params(record.Params);
+            element->SaveParams(params);
+            record.StateParams.clear();
+            if (WriteStates) {
+                TNetlistParams state(record.StateParams);
+                element->SaveState(state);
+            }
+
+            TSubCircuit* subCircuit = dynamic_cast<TSubCircuit*>(element);
+            if (!subCircuit) {
+                Writer.WriteElement(record);
+                continue;
+            }
+
+            // Содержимое подсхемы - вложенный уровень со своими Id
+            std::vector<TCircuitElement*> internals;
+            for (const auto& internal : subCircuit->GetInternalElements()) {
+                internals.push_back(internal.get());
+            }
+            Writer.BeginSubCircuit(record);
+            WriteNetlistLevel(Writer, internals, subCircuit->GetInternalConnections(), Offset, WriteStates);
+            Writer.EndSubCircuit();
+        }
+
+        // Соединения с общим первым выводом записываются одной цепью, в порядке
+        // первого появления. Промежуточные точки проводов без владельца не пишутся
+        std::unordered_map<const TConnectionPoint*, size_t> netIndex;
+        std::vector<std::vector<TNetlistPin>> nets;
+        auto pinOf = [&Offset](const TConnectionPoint* Point) {
+            TNetlistPin pin;
+            pin.Element = Point->Owner->Id - Offset.Id;
+            pin.IsInput = Point->IsInput;
+            pin.Port = (uint32_t)PortIndexOf(Point);
+            return pin;
+        };
+
+        for (const auto& connection : Connections) {
+            if (PortIndexOf(connection.first) < 0 || PortIndexOf(connection.second) < 0 ||
+                !level.count(connection.first->Owner) || !level.count(connection.second->Owner)) {
+                continue;
+            }
+
+            auto it = netIndex.find(connection.first);
+            if (it == netIndex.end()) {
+                it = netIndex.insert(std::make_pair(connection.first, nets.size())).first;
+                nets.push_back(std::vector<TNetlistPin>(1, pinOf(connection.first)));
+            }
+            nets[it->second].push_back(pinOf(connection.second));
+        }
+
+        for (const auto& net : nets) {
+            Writer.WriteNet(net);
+        }
+    }
+
+    std::shared_ptr<const TSubCircuitDefinition> MakeDefinition(std::string&& Text) {
+        std::shared_ptr<TSubCircuitDefinition> definition = std::make_shared<TSubCircuitDefinition>();
+        definition->Text = std::move(Text);
+        definition->Hash = NetlistHash(definition->Text);
+        definition->ElementCount = 0;
+
+        // Число элементов нужно до загрузки содержимого, считается один раз на определение
+        std::istringstream stream(definition->Text);
+        TNetlistReader reader(stream);
+        TNetlistRecord record;
+        int depth = 0;
+        while (reader.Next(record)) {
+            if (record.Kind == nrSubCircuit) {
+                if (depth++ == 0) definition->ElementCount++;
+            } else if (record.Kind == nrEnd) {
+                depth--;
+            } else if (record.Kind == nrElement && depth == 0) {
+                definition->ElementCount++;
+            }
+        }
+        return definition;
+    }
+
+    typedef std::vector<std::pair<std::string, int32_t>> TParamList;
+
+    // Состояние содержимого экземпляра подсхемы хранится отдельно от определения.
+    // Элементы нумеруются в порядке обхода: элемент, затем его содержимое.
+    // States - символ '-', '0' или '+' на элемент, без нулей в конце;
+    // Params - ненулевые параметры состояния: "номер:Ключ=значение,...;..."
+    struct TInstanceState {
+        std::string States;
+        std::string Params;
+    };
+
+    void AppendInternalState(const TSubCircuit* SubCircuit, TInstanceState& State) {
+        TParamList params;
+        for (const auto& internal : SubCircuit->GetInternalElements()) {
+            TTernary state = internal->CurrentState;
+            State.States += state == TTernary::NEG ? '-' : state == TTernary::POS ? '+' : '0';
+            size_t index = State.States.size() - 1;
+
+            params.clear();
+            TNetlistParams writer(params);
+            internal->SaveState(writer);
+            bool first = true;
+            for (const auto& param : params) {
+                if (!param.second) continue;
+                if (first) {
+                    if (!State.Params.empty()) State.Params += ';';
+                    State.Params += std::to_string(index) + ':';
+                    first = false;
+                } else {
+                    State.Params += ',';
+                }
+                State.Params += param.first + '=' + std::to_string(param.second);
+            }
+
+            const TSubCircuit* nested = dynamic_cast<const TSubCircuit*>(internal.get());
+            if (nested) AppendInternalState(nested, State);
+        }
+    }
+
+    // Разбор TInstanceState::Params; испорченные записи пропускаются
+    std::unordered_map<size_t, TParamList> ParseStateParams(const std::string& Text) {
+        std::unordered_map<size_t, TParamList> result;
+        size_t start = 0;
+        while (start < Text.size()) {
+            size_t end = Text.find(';', start);
+            if (end == std::string::npos) end = Text.size();
+
+            size_t colon = Text.find(':', start);
+            if (colon < end) {
+                TParamList& params = result[(size_t)strtoul(Text.c_str() + start, nullptr, 10)];
+                size_t item = colon + 1;
+                while (item < end) {
+                    size_t next = std::min(Text.find(',', item), end);
+                    size_t equal = Text.find('=', item);
+                    if (equal < next) {
+                        params.push_back(std::make_pair(Text.substr(item, equal - item),
+                                                        (int32_t)strtol(Text.c_str() + equal + 1, nullptr, 10)));
+                    }
+                    item = next + 1;
+                }
+            }
+            start = end + 1;
+        }
+        return result;
+    }
+
+    void ApplyInternalState(const std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                            const std::string& States, const std::unordered_map<size_t, TParamList>& Params,
+                            size_t& Index) {
+        for (const auto& element : Elements) {
+            char state = Index < States.size() ? States[Index] : '0';
+            element->SetCurrentState(state == '-' ? TTernary::NEG : state == '+' ? TTernary::POS : TTernary::ZERO);
+
+            auto params = Params.find(Index);
+            if (params != Params.end()) {
+                element->LoadState(TNetlistParams(params->second));
+            }
+            Index++;
+
+            const TSubCircuit* nested = dynamic_cast<const TSubCircuit*>(element.get());
+            if (nested) ApplyInternalState(nested->GetInternalElements(), States, Params, Index);
+        }
+    }
+
+    // Содержимое подсхемы из общего определения, загружается по требованию
+    class TNetlistSubCircuitSource : public TSubCircuitSource {
+    private:
+        TSerializationManager* FManager;
+        std::shared_ptr<const TSubCircuitDefinition> FDefinition;
+        TNetlistOffset FOffset;
+        TInstanceState FState;
+
+    public:
+        TNetlistSubCircuitSource(TSerializationManager* Manager,
+                                 const std::shared_ptr<const TSubCircuitDefinition>& Definition,
+                                 const TNetlistOffset& Offset, TInstanceState&& State)
+            : FManager(Manager), FDefinition(Definition), FOffset(Offset), FState(std::move(State)) {}
+
+        const std::shared_ptr<const TSubCircuitDefinition>& GetDefinition() const { return FDefinition; }
+        const TNetlistOffset& GetOffset() const { return FOffset; }
+        const TInstanceState& GetState() const { return FState; }
+
+        size_t GetElementCount() const override { return FDefinition->ElementCount; }
+
+        void Load(std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                  std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections) override {
+            std::istringstream stream(FDefinition->Text);
+            TNetlistReader reader(stream);
+            int nextElementId;
+            FManager->ReadNetlist(reader, FOffset, Elements, Connections, nextElementId);
+
+            // Определение несет только структуру, состояние - у экземпляра
+            if (!FState.States.empty() || !FState.Params.empty()) {
+                size_t index = 0;
+                ApplyInternalState(Elements, FState.States, ParseStateParams(FState.Params), index);
+            }
+        }
+    };
+
+    // Канонический вид содержимого подсхемы: координаты от левого верхнего
+    // угла содержимого, Id от наименьшего. Offset - сдвиг экземпляра,
+    // State - состояние его содержимого.
+    // Незагруженное содержимое берется из определения как есть
+    std::shared_ptr<const TSubCircuitDefinition> GetSubCircuitDefinition(TSubCircuit* SubCircuit,
+                                                                         TNetlistOffset& Offset, TInstanceState& State) {
+        const TNetlistSubCircuitSource* source = dynamic_cast<const TNetlistSubCircuitSource*>(SubCircuit->GetSource());
+        if (source) {
+            Offset = source->GetOffset();
+            State = source->GetState();
+            return source->GetDefinition();
+        }
+
+        State = TInstanceState();
+        AppendInternalState(SubCircuit, State);
+        State.States.erase(State.States.find_last_not_of('0') + 1);
+
+        const auto& internals = SubCircuit->GetInternalElements();
+        std::vector<TCircuitElement*> elements;
+        elements.reserve(internals.size());
+        Offset = TNetlistOffset();
+        for (const auto& internal : internals) {
+            if (elements.empty()) {
+                Offset.X = internal->Bounds.Left;
+                Offset.Y = internal->Bounds.Top;
+                Offset.Id = internal->Id;
+            } else {
+                Offset.X = std::min(Offset.X, (int)internal->Bounds.Left);
+                Offset.Y = std::min(Offset.Y, (int)internal->Bounds.Top);
+                Offset.Id = std::min(Offset.Id, internal->Id);
+            }
+            elements.push_back(internal.get());
+        }
+
+        std::ostringstream stream;
+        TNetlistWriter writer(stream);
+        writer.WriteHeader(0);
+        WriteNetlistLevel(writer, elements, SubCircuit->GetInternalConnections(), Offset, false);
+        return MakeDefinition(stream.str());
+    }
+
+    uint32_t AddUtf8String(TSchemeFileBuilder& Builder, const String& Value) {
+        UTF8String utf8(Value);
+        return Builder.AddString(std::string(utf8.c_str(), utf8.Length()));
+    }
+
+    String ReadUtf8String(const TSchemeFileView& View, uint32_t Index) {
+        size_t length;
+        const char* data = View.GetString(Index, length);
+        return String(UTF8String(data, (int)length));
+    }
+
+    void AddPortRecords(TSchemeFileBuilder& Builder, const std::vector<TConnectionPoint>& Points,
+                        TPortIndex& PortIndex) {
+        for (const auto& point : Points) {
+            TSchemePortRecord record;
+            record.RelX = point.RelX;
+            record.RelY = point.RelY;
+            record.LineStyle = static_cast<int32_t>(point.LineStyle);
+            record.Reserved = 0;
+            PortIndex[&point] = Builder.AddPort(record);
+        }
+    }
+
+    // Содержимое подсхемы не записывается элементами: подсхема ссылается на
+    // строку с определением, а таблица строк хранит одинаковые строки один раз
+    uint32_t AddElementRecords(TSchemeFileBuilder& Builder, TCircuitElement* Element,
+                               TPortIndex& PortIndex, TElementIndex& ElementIndex) {
+        TSchemeElementRecord record;
+        record.Id = Element->Id;
+        record.ClassName = AddUtf8String(Builder, Element->GetClassName());
+        record.Name = AddUtf8String(Builder, Element->Name);
+        record.Left = Element->Bounds.Left;
+        record.Top = Element->Bounds.Top;
+        record.Width = Element->Bounds.Width();
+        record.Height = Element->Bounds.Height();
+        record.State = static_cast<int32_t>(Element->CurrentState);
+        record.Parent = -1;
+
+        record.FirstPort = Builder.GetPortCount();
+        record.InputCount = (uint32_t)Element->Inputs.size();
+        record.OutputCount = (uint32_t)Element->Outputs.size();
+        AddPortRecords(Builder, Element->Inputs, PortIndex);
+        AddPortRecords(Builder, Element->Outputs, PortIndex);
+
+        record.FirstParam = Builder.GetParamCount();
+        TSchemeParamWriter params(Builder);
+        Element->SaveParams(params);
+        Element->SaveState(params);
+
+        TSubCircuit* subCircuit = dynamic_cast<TSubCircuit*>(Element);
+        if (subCircuit) {
+            TNetlistOffset offset;
+            TInstanceState state;
+            std::shared_ptr<const TSubCircuitDefinition> definition = GetSubCircuitDefinition(subCircuit, offset, state);
+            params.WriteInteger("Definition", (int)Builder.AddString(definition->Text));
+            params.WriteInteger("DefinitionX", offset.X);
+            params.WriteInteger("DefinitionY", offset.Y);
+            params.WriteInteger("DefinitionIdBase", offset.Id);
+            if (!state.States.empty()) {
+                params.WriteInteger("DefinitionStates", (int)Builder.AddString(state.States));
+            }
+            if (!state.Params.empty()) {
+                params.WriteInteger("DefinitionStateParams", (int)Builder.AddString(state.Params));
+            }
+        }
+        record.ParamCount = Builder.GetParamCount() - record.FirstParam;
+
+        uint32_t index = Builder.AddElement(record);
+        ElementIndex[Element] = index;
+        return index;
+    }
+
+    void AddConnectionRecords(TSchemeFileBuilder& Builder,
+                              const std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections,
+                              int32_t Parent, const TPortIndex& PortIndex, const TElementIndex& ElementIndex) {
+        for (const auto& connection : Connections) {
+            if (!connection.first || !connection.second) continue;
+
+            auto fromPort = PortIndex.find(connection.first);
+            auto toPort = PortIndex.find(connection.second);
+            auto fromElement = ElementIndex.find(connection.first->Owner);
+            auto toElement = ElementIndex.find(connection.second->Owner);
+            if (fromPort == PortIndex.end() || toPort == PortIndex.end() ||
+                fromElement == ElementIndex.end() || toElement == ElementIndex.end()) {
+                continue;
+            }
+
+            TSchemeConnectionRecord record;
+            record.Parent = Parent;
+            record.FromElement = fromElement->second;
+            record.FromPort = fromPort->second;
+            record.ToElement = toElement->second;
+            record.ToPort = toPort->second;
+            Builder.AddConnection(record);
+        }
+    }
+
+    // Вывод загруженного элемента по абсолютному индексу порта в файле
+    TConnectionPoint* ResolvePort(const TSchemeFileView& View, TCircuitElement* Element,
+                                  uint32_t ElementIndex, uint32_t Port) {
+        if (!Element) return nullptr;
+
+        const TSchemeElementRecord& record = View.GetElement(ElementIndex);
+        uint32_t local = Port - record.FirstPort;
+
+        auto& inputs = Element->Inputs;
+        auto& outputs = Element->Outputs;
+        if (local < record.InputCount) {
+            return local < inputs.size() ? &inputs[local] : nullptr;
+        }
+        local -= record.InputCount;
+        return local < outputs.size() ? &outputs[local] : nullptr;
+    }
+
+    // Элементы с содержимым подсхем и соединения между ними одним образом файла схемы
+    bool BuildSchemeImage(const std::vector<TCircuitElement*>& Elements,
+                          const std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections,
+                          int NextElementId, std::string& Image) {
+        TSchemeFileBuilder builder;
+        TPortIndex portIndex;
+        TElementIndex elementIndex;
+
+        for (auto element : Elements) {
+            AddElementRecords(builder, element, portIndex, elementIndex);
+        }
+        AddConnectionRecords(builder, Connections, -1, portIndex, elementIndex);
+
+        std::ostringstream stream;
+        if (!builder.Write(stream, NextElementId)) return false;
+        Image = stream.str();
+        return true;
+    }
+
+    // Записи журнала автосохранения
+    enum TJournalRecordKind {
+        rkPutElements = 1,      // образ элементов, заменяет элементы с теми же Id
+        rkRemoveElements = 2,   // Id удаленных элементов
+        rkConnect = 3,          // оба вывода: Id элемента, вход или выход, номер вывода
+        rkClear = 4,
+        rkMoveElement = 5,      // Id, границы и положения выводов
+        rkDisconnect = 6        // выводы удаленного соединения, как в rkConnect
+    };
+
+    // Журнал сворачивается в снимок, когда перерастает его: сборка полного
+    // образа приходится на объем записей не меньше самого образа
+    const size_t MinJournalCompactSize = 256 * 1024;
+
+    void AppendInt32(std::string& Data, int32_t Value) {
+        Data.append(reinterpret_cast<const char*>(&Value), sizeof(Value));
+    }
+
+    void AppendDouble(std::string& Data, double Value) {
+        Data.append(reinterpret_cast<const char*>(&Value), sizeof(Value));
+    }
+
+    template <typename T>
+    bool ReadValue(const std::string& Data, size_t& Position, T& Value) {
+        if (Data.size() - Position < sizeof(Value)) return false;
+        memcpy(&Value, Data.data() + Position, sizeof(Value));
+        Position += sizeof(Value);
+        return true;
+    }
+
+    bool ReadInt32(const std::string& Data, size_t& Position, int32_t& Value) {
+        return ReadValue(Data, Position, Value);
+    }
+
+    // Свертка журнала в потоке журнала: записи применяются к образу схемы так же,
+    // как ApplyJournalRecord применяет их к вкладке, но без создания элементов
+    bool CompactSchemeImage(const std::string& Image, const std::vector<TSchemeJournal::TRecord>& Records,
+                            std::string& Result) {
+        // Параметры подсхем, значения которых - номера строк образа
+        std::vector<std::string> stringParams;
+        stringParams.push_back("Definition");
+        stringParams.push_back("DefinitionStates");
+        stringParams.push_back("DefinitionStateParams");
+
+        TSchemeImageEditor editor(stringParams);
+        if (!editor.Load(Image)) return false;
+
+        for (const auto& record : Records) {
+            switch (record.Kind) {
+                case rkPutElements:
+                    // Поврежденный образ пропускается, как и при восстановлении
+                    editor.Put(record.Payload);
+                    break;
+
+                case rkRemoveElements: {
+                    size_t position = 0;
+                    int32_t id;
+                    while (ReadInt32(record.Payload, position, id)) {
+                        editor.Remove(id);
+                    }
+                    break;
+                }
+
+                case rkConnect:
+                case rkDisconnect: {
+                    size_t position = 0;
+                    TSchemeImageEditor::TPortRef refs[2];
+                    bool complete = true;
+                    for (auto& ref : refs) {
+                        int32_t id, isInput, port;
+                        complete = complete && ReadInt32(record.Payload, position, id) &&
+                                   ReadInt32(record.Payload, position, isInput) &&
+                                   ReadInt32(record.Payload, position, port);
+                        ref.ElementId = id;
+                        ref.IsInput = isInput != 0;
+                        ref.Port = port;
+                    }
+                    if (!complete) break;
+
+                    if (record.Kind == rkDisconnect) {
+                        editor.Disconnect(refs[0], refs[1]);
+                    } else {
+                        editor.Connect(refs[0], refs[1]);
+                    }
+                    break;
+                }
+
+                case rkMoveElement: {
+                    size_t position = 0;
+                    int32_t id, left, top, width, height, portCount;
+                    if (!ReadInt32(record.Payload, position, id) || !ReadInt32(record.Payload, position, left) ||
+                        !ReadInt32(record.Payload, position, top) || !ReadInt32(record.Payload, position, width) ||
+                        !ReadInt32(record.Payload, position, height) || !ReadInt32(record.Payload, position, portCount)) {
+                        break;
+                    }
+
+                    std::vector<std::pair<double, double>> ports;
+                    for (int32_t p = 0; p < portCount; p++) {
+                        double relX, relY;
+                        if (!ReadValue(record.Payload, position, relX) || !ReadValue(record.Payload, position, relY)) break;
+                        ports.push_back(std::make_pair(relX, relY));
+                    }
+                    editor.Move(id, left, top, width, height, ports);
+                    break;
+                }
+
+                case rkClear:
+                    editor.Clear();
+                    break;
+            }
+        }
+
+        return editor.Write(Result);
+    }
+
+    // Повторное соединение тех же выводов не добавляется
+    void AddReplayConnection(TJournalReplay& Replay, const TJournalReplay::TConnection& Connection) {
+        size_t index = Replay.Connections.size();
+        if (!Replay.ConnectionIndex.emplace(Connection, index).second) return;
+
+        Replay.Connections.push_back(Connection);
+        Replay.ElementConnections[Connection.first->Owner].push_back(index);
+        if (Connection.second->Owner != Connection.first->Owner) {
+            Replay.ElementConnections[Connection.second->Owner].push_back(index);
+        }
+    }
+
+    void RemoveReplayConnection(TJournalReplay& Replay, size_t Index) {
+        TJournalReplay::TConnection& connection = Replay.Connections[Index];
+        if (!connection.first) return;
+
+        Replay.ConnectionIndex.erase(connection);
+        connection = TJournalReplay::TConnection(nullptr, nullptr);
+    }
+
+    void BeginJournalReplay(TTabData* TabData, TJournalReplay& Replay) {
+        for (size_t i = 0; i < TabData->Elements.size(); i++) {
+            TCircuitElement* element = TabData->Elements[i].get();
+            Replay.Elements[element->Id] = element;
+            Replay.Slots[element] = i;
+        }
+        for (const auto& connection : TabData->Connections) {
+            AddReplayConnection(Replay, connection);
+        }
+        TabData->Connections.clear();
+    }
+
+    void FinishJournalReplay(TTabData* TabData, TJournalReplay& Replay) {
+        auto& elements = TabData->Elements;
+        if (!Replay.Removed.empty()) {
+            elements.erase(std::remove_if(elements.begin(), elements.end(),
+                [&Replay](const std::unique_ptr<TCircuitElement>& Item) {
+                    return Replay.Removed.count(Item.get()) != 0;
+                }), elements.end());
+        }
+
+        TabData->Connections.clear();
+        for (const auto& connection : Replay.Connections) {
+            if (connection.first) TabData->Connections.push_back(connection);
+        }
+    }
+
+    void AddReplayElement(TTabData* TabData, TJournalReplay& Replay, std::unique_ptr<TCircuitElement> Element) {
+        TCircuitElement* element = Element.get();
+        Replay.Elements[element->Id] = element;
+        Replay.Slots[element] = TabData->Elements.size();
+        TabData->Elements.push_back(std::move(Element));
+    }
+
+    // Элемент заменяется новым с тем же Id; соединения переходят на выводы
+    // с теми же номерами, соединения с исчезнувшими выводами удаляются
+    void ReplaceElement(TTabData* TabData, TJournalReplay& Replay, TCircuitElement* Element,
+                        std::unique_ptr<TCircuitElement> Replacement) {
+        TCircuitElement* replacement = Replacement.get();
+        auto remap = [&](TConnectionPoint*& Point) {
+            if (Point->Owner != Element) return;
+
+            int index = PortIndexOf(Point);
+            auto& points = Point->IsInput ? replacement->Inputs : replacement->Outputs;
+            Point = index >= 0 && index < static_cast<int>(points.size()) ? &points[index] : nullptr;
+        };
+
+        auto owned = Replay.ElementConnections.find(Element);
+        if (owned != Replay.ElementConnections.end()) {
+            std::vector<size_t> indices = std::move(owned->second);
+            Replay.ElementConnections.erase(owned);
+
+            auto& moved = Replay.ElementConnections[replacement];
+            for (size_t index : indices) {
+                TJournalReplay::TConnection connection = Replay.Connections[index];
+                if (!connection.first) continue;
+
+                RemoveReplayConnection(Replay, index);
+                remap(connection.first);
+                remap(connection.second);
+                if (connection.first && connection.second &&
+                    Replay.ConnectionIndex.emplace(connection, index).second) {
+                    Replay.Connections[index] = connection;
+                    moved.push_back(index);
+                }
+            }
+        }
+
+        size_t slot = Replay.Slots[Element];
+        Replay.Slots.erase(Element);
+        Replay.Slots[replacement] = slot;
+        Replay.Elements[replacement->Id] = replacement;
+        TabData->Elements[slot] = std::move(Replacement);
+    }
+
+    // Сам элемент убирается из схемы в FinishJournalReplay
+    void RemoveElement(TJournalReplay& Replay, TCircuitElement* Element) {
+        auto owned = Replay.ElementConnections.find(Element);
+        if (owned != Replay.ElementConnections.end()) {
+            for (size_t index : owned->second) {
+                RemoveReplayConnection(Replay, index);
+            }
+            Replay.ElementConnections.erase(owned);
+        }
+
+        Replay.Elements.erase(Element->Id);
+        Replay.Slots.erase(Element);
+        Replay.Removed.insert(Element);
+    }
+}
+
+__fastcall TIndexedIniFile::TIndexedIniFile(const String& FileName)
+    : TCustomIniFile(FileName) {
+    if (!FIndex.LoadFromFile(FileName.c_str())) {
+        throw Exception("Не удалось прочитать файл " + FileName);
+    }
+}
+
+String TIndexedIniFile::SpanToString(const TIniIndex::TSpan& Span) const {
+    if (FIndex.IsUtf8()) {
+        return String(UTF8String(Span.Data, (int)Span.Length));
+    }
+    return String(AnsiString(Span.Data, (int)Span.Length));
+}
+
+std::string TIndexedIniFile::ToIndexString(const String& Value) const {
+    if (FIndex.IsUtf8()) {
+        UTF8String utf8(Value);
+        return std::string(utf8.c_str(), utf8.Length());
+    }
+    AnsiString ansi(Value);
+    return std::string(ansi.c_str(), ansi.Length());
+}
+
+String __fastcall TIndexedIniFile::ReadString(const String Section, const String Ident, const String Default) {
+    TIniIndex::TSpan value;
+    if (!FIndex.Find(ToIndexString(Section).c_str(), ToIndexString(Ident).c_str(), value)) {
+        return Default;
+    }
+    return SpanToString(value);
+}
+
+int __fastcall TIndexedIniFile::ReadInteger(const String Section, const String Ident, int Default) {
+    return FIndex.ReadInteger(ToIndexString(Section).c_str(), ToIndexString(Ident).c_str(), Default);
+}
+
+double __fastcall TIndexedIniFile::ReadFloat(const String Section, const String Name, double Default) {
+    return FIndex.ReadFloat(ToIndexString(Section).c_str(), ToIndexString(Name).c_str(), Default);
+}
+
+bool __fastcall TIndexedIniFile::ReadBool(const String Section, const String Ident, bool Default) {
+    return FIndex.ReadBool(ToIndexString(Section).c_str(), ToIndexString(Ident).c_str(), Default);
+}
+
+bool __fastcall TIndexedIniFile::SectionExists(const String Section) {
+    return FIndex.FindSection(ToIndexString(Section).c_str()) >= 0;
+}
+
+bool __fastcall TIndexedIniFile::ValueExists(const String Section, const String Ident) {
+    TIniIndex::TSpan value;
+    return FIndex.Find(ToIndexString(Section).c_str(), ToIndexString(Ident).c_str(), value);
+}
+
+void __fastcall TIndexedIniFile::ReadSection(const String Section, TStrings* Strings) {
+    Strings->BeginUpdate();
+    try {
+        Strings->Clear();
+        int section = FIndex.FindSection(ToIndexString(Section).c_str());
+        if (section >= 0) {
+            for (size_t i = 0; i < FIndex.GetKeyCount(section); i++) {
+                Strings->Add(SpanToString(FIndex.GetKey(section, i)));
+            }
+        }
+    }
+    __finally {
+        Strings->EndUpdate();
+    }
+}
+
+void __fastcall TIndexedIniFile::ReadSections(TStrings* Strings) {
+    Strings->BeginUpdate();
+    try {
+        Strings->Clear();
+        for (size_t i = 0; i < FIndex.GetSectionCount(); i++) {
+            Strings->Add(SpanToString(FIndex.GetSectionName(i)));
+        }
+    }
+    __finally {
+        Strings->EndUpdate();
+    }
+}
+
+void __fastcall TIndexedIniFile::ReadSectionValues(const String Section, TStrings* Strings) {
+    Strings->BeginUpdate();
+    try {
+        Strings->Clear();
+        int section = FIndex.FindSection(ToIndexString(Section).c_str());
+        if (section >= 0) {
+            for (size_t i = 0; i < FIndex.GetKeyCount(section); i++) {
+                Strings->Add(SpanToString(FIndex.GetKey(section, i)) + "=" +
+                             SpanToString(FIndex.GetValue(section, i)));
+            }
+        }
+    }
+    __finally {
+        Strings->EndUpdate();
+    }
+}
+
+void __fastcall TIndexedIniFile::WriteString(const String Section, const String Ident, const String Value) {
+    throw EIniFileException("Файл открыт только для чтения");
+}
+
+void __fastcall TIndexedIniFile::EraseSection(const String Section) {
+    throw EIniFileException("Файл открыт только для чтения");
+}
+
+void __fastcall TIndexedIniFile::DeleteKey(const String Section, const String Ident) {
+    throw EIniFileException("Файл открыт только для чтения");
+}
+
+void __fastcall TIndexedIniFile::UpdateFile() {
+}
+
+// Двоичный файл схемы и индексы его записей по владельцам. Живет, пока есть
+// подсхемы с незагруженным содержимым
+struct TSchemeLoadContext {
+    TSchemeFileView View;
+    std::unordered_map<int32_t, std::vector<uint32_t>> Children;
+    std::unordered_map<int32_t, std::vector<uint32_t>> Connections;
+
+    // Определения подсхем по индексу строки: одинаковые тексты в файле - одна
+    // строка, поэтому экземпляры одного определения делят его разбор
+    std::mutex DefinitionLock;
+    std::unordered_map<uint32_t, std::shared_ptr<const TSubCircuitDefinition>> Definitions;
+};
+
+// Содержимое подсхемы из двоичного файла, загружается по требованию
+class TBinarySubCircuitSource : public TSubCircuitSource {
+private:
+    TSerializationManager* FManager;
+    std::shared_ptr<TSchemeLoadContext> FContext;
+    int32_t FRecord;
+    size_t FElementCount;
+
+public:
+    TBinarySubCircuitSource(TSerializationManager* Manager,
+                            const std::shared_ptr<TSchemeLoadContext>& Context, uint32_t Record)
+        : FManager(Manager), FContext(Context), FRecord((int32_t)Record), FElementCount(0) {
+        auto children = FContext->Children.find(FRecord);
+        if (children != FContext->Children.end()) {
+            FElementCount = children->second.size();
+        }
+    }
+
+    size_t GetElementCount() const override { return FElementCount; }
+
+    void Load(std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+              std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections) override {
+        FManager->LoadSchemeLevel(FContext, FRecord, Elements, Connections);
+    }
+};
+
+TSerializationManager::TSerializationManager(TMainForm* MainForm) 
+    : FMainForm(MainForm) {
+}
+
+std::unique_ptr<TCircuitElement> TSerializationManager::LoadElementFromRecord(const TSchemeFileView& View,
+                                                                             uint32_t Index) {
+    const TSchemeElementRecord& record = View.GetElement(Index);
+    auto element = CreateElementByClassName(ReadUtf8String(View, record.ClassName),
+                                            record.Id, record.Left, record.Top);
+    if (!element) return element;
+
+    element->RestoreState(record.Id, ReadUtf8String(View, record.Name),
+                          TRect(record.Left, record.Top, record.Left + record.Width, record.Top + record.Height),
+                          static_cast<TTernary>(record.State));
+
+    for (uint32_t p = 0; p < record.InputCount + record.OutputCount; p++) {
+        const TSchemePortRecord& port = View.GetPort(record.FirstPort + p);
+        element->RestorePort(p < record.InputCount, port.RelX, port.RelY,
+                             static_cast<TLineStyle>(port.LineStyle));
+    }
+
+    TSchemeParamReader params(View, record.FirstParam, record.ParamCount);
+    element->LoadParams(params);
+    element->LoadState(params);
+
+    return element;
+}
+
+void TSerializationManager::LoadSchemeLevel(const std::shared_ptr<TSchemeLoadContext>& Context, int32_t Parent,
+                                            std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                                            std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections) {
+    const TSchemeFileView& view = Context->View;
+    TParallelLoop loop;
+
+    auto children = Context->Children.find(Parent);
+    if (children == Context->Children.end()) return;
+    const std::vector<uint32_t>& records = children->second;
+
+    // Записи уровня независимы: потоки создают элементы своих порций прямо в
+    // ячейки заранее выделенного массива, порядок записей сохраняется.
+    // Неизвестные классы пропускаются вместе с их соединениями
+    std::vector<std::unique_ptr<TCircuitElement>> loaded(records.size());
+    loop.Run(records.size(), ElementGrain, [&](size_t Begin, size_t End) {
+        for (size_t k = Begin; k < End; k++) {
+            loaded[k] = LoadElementFromRecord(view, records[k]);
+
+            TSubCircuit* subCircuit = dynamic_cast<TSubCircuit*>(loaded[k].get());
+            if (!subCircuit) continue;
+
+            // Файлы первой версии хранят содержимое записями с владельцем
+            const TSchemeElementRecord& record = view.GetElement(records[k]);
+            TSchemeParamReader params(view, record.FirstParam, record.ParamCount);
+            int text = params.ReadInteger("Definition", -1);
+            if (text < 0) {
+                subCircuit->SetSource(std::unique_ptr<TSubCircuitSource>(
+                    new TBinarySubCircuitSource(this, Context, records[k])));
+                continue;
+            }
+
+            std::shared_ptr<const TSubCircuitDefinition> definition;
+            {
+                std::lock_guard<std::mutex> lock(Context->DefinitionLock);
+                auto& known = Context->Definitions[(uint32_t)text];
+                if (!known) {
+                    size_t length;
+                    const char* data = view.GetString((uint32_t)text, length);
+                    known = MakeDefinition(std::string(data, length));
+                }
+                definition = known;
+            }
+
+            TNetlistOffset offset;
+            offset.X = params.ReadInteger("DefinitionX", 0);
+            offset.Y = params.ReadInteger("DefinitionY", 0);
+            offset.Id = params.ReadInteger("DefinitionIdBase", 0);
+
+            auto readString = [&](const char* Key, std::string& Value) {
+                int index = params.ReadInteger(Key, -1);
+                if (index < 0) return;
+                size_t length;
+                const char* data = view.GetString((uint32_t)index, length);
+                Value.assign(data, length);
+            };
+            TInstanceState state;
+            readString("DefinitionStates", state.States);
+            readString("DefinitionStateParams", state.Params);
+            subCircuit->SetSource(std::unique_ptr<TSubCircuitSource>(
+                new TNetlistSubCircuitSource(this, definition, offset, std::move(state))));
+        }
+    });
+
+    // Индексы записей уровня возрастают, элемент записи ищется двоичным поиском
+    auto findElement = [&](uint32_t Record) -> TCircuitElement* {
+        auto it = std::lower_bound(records.begin(), records.end(), Record);
+        return it != records.end() && *it == Record ? loaded[it - records.begin()].get() : nullptr;
+    };
+
+    auto connections = Context->Connections.find(Parent);
+    if (connections != Context->Connections.end()) {
+        const std::vector<uint32_t>& indices = connections->second;
+        std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>> resolved(indices.size());
+
+        loop.Run(indices.size(), ConnectionGrain, [&](size_t Begin, size_t End) {
+            for (size_t k = Begin; k < End; k++) {
+                const TSchemeConnectionRecord& record = view.GetConnection(indices[k]);
+                resolved[k] = std::make_pair(
+                    ResolvePort(view, findElement(record.FromElement), record.FromElement, record.FromPort),
+                    ResolvePort(view, findElement(record.ToElement), record.ToElement, record.ToPort));
+            }
+        });
+
+        for (const auto& connection : resolved) {
+            if (connection.first && connection.second) {
+                Connections.push_back(connection);
+            }
+        }
+    }
+
+    for (auto& element : loaded) {
+        if (element) Elements.push_back(std::move(element));
+    }
+}
+
+void TSerializationManager::SaveSchemeToFile(const String& FileName, TTabData* TabData) {
+    if (!TabData) return;
+
+    String extension = ExtractFileExt(FileName);
+    if (SameText(extension, ".ini")) {
+        SaveSchemeToIni(FileName, TabData);
+    } else if (SameText(extension, ".net")) {
+        SaveSchemeToNetlist(FileName, TabData);
+    } else {
+        SaveSchemeToBinary(FileName, TabData);
+    }
+}
+
+void TSerializationManager::LoadSchemeFromFile(const String& FileName, TTabData* TabData) {
+    if (!TabData) return;
+
+    // Схемы прежних версий хранились в INI и загружаются как раньше
+    if (LoadSchemeFromBinary(FileName, TabData)) return;
+
+    if (IsNetlistFile(FileName)) {
+        LoadSchemeFromNetlist(FileName, TabData);
+    } else {
+        LoadSchemeFromIni(FileName, TabData);
+    }
+}
+
+void TSerializationManager::SaveSchemeToBinary(const String& FileName, TTabData* TabData) {
+    if (!TabData) return;
+
+    std::vector<TCircuitElement*> elements;
+    elements.reserve(TabData->Elements.size());
+    for (const auto& element : TabData->Elements) {
+        elements.push_back(element.get());
+    }
+
+    std::string data;
+    if (!BuildSchemeImage(elements, TabData->Connections, TabData->NextElementId, data)) {
+        throw Exception("Схема слишком велика для сохранения.");
+    }
+
+    std::unique_ptr<TFileStream> file(new TFileStream(FileName, fmCreate));
+    file->WriteBuffer(data.data(), (NativeInt)data.size());
+}
+
+bool TSerializationManager::LoadSchemeFromBinary(const String& FileName, TTabData* TabData) {
+    if (!TabData) return false;
+
+    std::shared_ptr<TSchemeLoadContext> context = std::make_shared<TSchemeLoadContext>();
+    TSchemeFileView& view = context->View;
+    if (!view.Open(FileName.c_str())) {
+        if (TSchemeFileView::HasSchemeMagic(FileName.c_str())) {
+            throw Exception("Файл схемы поврежден.");
+        }
+        return false;
+    }
+
+    TabData->NextElementId = view.GetHeader().NextElementId;
+    LoadSchemeImage(context, TabData->Elements, TabData->Connections);
+    return true;
+}
+
+void TSerializationManager::LoadSchemeImage(const std::shared_ptr<TSchemeLoadContext>& Context,
+                                            std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                                            std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections) {
+    TSchemeFileView& view = Context->View;
+    const TSchemeFileHeader& header = view.GetHeader();
+
+    // Индексы записей по владельцам строятся один раз для всего файла. Соединения
+    // связывают элементы одного владельца, остальные отбрасываются
+    for (uint32_t i = 0; i < header.ElementCount; i++) {
+        Context->Children[view.GetElement(i).Parent].push_back(i);
+    }
+    for (uint32_t i = 0; i < header.ConnectionCount; i++) {
+        const TSchemeConnectionRecord& record = view.GetConnection(i);
+        if (view.GetElement(record.FromElement).Parent == record.Parent &&
+            view.GetElement(record.ToElement).Parent == record.Parent) {
+            Context->Connections[record.Parent].push_back(i);
+        }
+    }
+
+    // Загружается только верхний уровень, подсхемы получают ссылку на файл
+    LoadSchemeLevel(Context, -1, Elements, Connections);
+
+    // Файл копируется в память, чтобы не держать его открытым до загрузки подсхем
+    if (Context.use_count() > 1) {
+        view.Detach();
+    }
+}
+
+void TSerializationManager::SaveSchemeToIni(const String& FileName, TTabData* TabData) {
+    if (!TabData) return;
+
+    // Файл собирается в памяти и записывается один раз в UpdateFile
+    std::unique_ptr<TMemIniFile> iniFile(new TMemIniFile(FileName));
+    iniFile->Clear();
+    FIniDefinitionNames.clear();
+
+    // Сохраняем основную информацию
+    iniFile->WriteInteger("Scheme", "ElementCount", static_cast<int>(TabData->Elements.size()));
+    iniFile->WriteInteger("Scheme", "ConnectionCount", static_cast<int>(TabData->Connections.size()));
+    iniFile->WriteInteger("Scheme", "NextElementId", TabData->NextElementId);
+    iniFile->WriteString("Scheme", "Version", "3.1");
+
+    // Сохраняем элементы
+    for (int i = 0; i < TabData->Elements.size(); i++) {
+        String section = "Element_" + IntToStr(i);
+        SaveElementToIni(TabData->Elements[i].get(), iniFile.get(), section);
+    }
+
+    // Сохраняем соединения
+    for (int i = 0; i < TabData->Connections.size(); i++) {
+        String section = "Connection_" + IntToStr(i);
+        auto& connection = TabData->Connections[i];
+
+        if (connection.first && connection.second) {
+            SaveConnectionPoint(connection.first, iniFile.get(), section, "From");
+            SaveConnectionPoint(connection.second, iniFile.get(), section, "To");
+        }
+    }
+
+    FIniDefinitionNames.clear();
+    iniFile->UpdateFile();
+}
+
+void TSerializationManager::LoadSchemeFromIni(const String& FileName, TTabData* TabData) {
+    if (!TabData) return;
+
+    std::unique_ptr<TIndexedIniFile> iniFile(new TIndexedIniFile(FileName));
+
+    String version = iniFile->ReadString("Scheme", "Version", "1.0");
+    if (version == "1.0") {
+        throw Exception("Формат файла устарел. Используйте новую версию для сохранения схем.");
+    }
+
+    int elementCount = iniFile->ReadInteger("Scheme", "ElementCount", 0);
+    int connectionCount = iniFile->ReadInteger("Scheme", "ConnectionCount", 0);
+    TabData->NextElementId = iniFile->ReadInteger("Scheme", "NextElementId", 1);
+    FIniDefinitions.clear();
+
+    // Загружаем элементы
+    TElementIdMap idToElementMap;
+
+    for (int i = 0; i < elementCount; i++) {
+        String section = "Element_" + IntToStr(i);
+        auto element = LoadElementFromIni(iniFile.get(), section);
+
+        if (element) {
+            idToElementMap[element->Id] = element.get();
+            TabData->Elements.push_back(std::move(element));
+        }
+    }
+
+    // Загружаем соединения
+    for (int i = 0; i < connectionCount; i++) {
+        String section = "Connection_" + IntToStr(i);
+
+        std::pair<TConnectionPoint*, TConnectionPoint*> connection;
+        if (LoadConnection(iniFile.get(), section, idToElementMap, connection)) {
+            TabData->Connections.push_back(connection);
+        }
+    }
+
+    // Подсхемы держат свои определения сами
+    FIniDefinitions.clear();
+}
+
+void TSerializationManager::SaveSchemeToNetlist(const String& FileName, TTabData* TabData) {
+    if (!TabData) return;
+
+    std::unique_ptr<TFileStream> file(new TFileStream(FileName, fmCreate));
+    TStreamBuffer buffer(file.get());
+    std::ostream stream(&buffer);
+    WriteNetlist(stream, TabData);
+    stream.flush();
+}
+
+void TSerializationManager::WriteNetlist(std::ostream& Stream, TTabData* TabData) {
+    std::vector<TCircuitElement*> elements;
+    elements.reserve(TabData->Elements.size());
+    for (const auto& element : TabData->Elements) {
+        elements.push_back(element.get());
+    }
+
+    TNetlistWriter writer(Stream);
+    writer.WriteHeader(TabData->NextElementId);
+    WriteNetlistLevel(writer, elements, TabData->Connections, TNetlistOffset(), true);
+}
+
+std::unique_ptr<TCircuitElement> TSerializationManager::CreateNetlistElement(const TNetlistElement& Record,
+                                                                             const TNetlistOffset& Offset) {
+    const TNetlistParams params(Record.Params);
+    int left = Record.Left + Offset.X;
+    int top = Record.Top + Offset.Y;
+    auto element = CreateElementByClassName(FromUtf8(Record.ClassName), Record.Id + Offset.Id, left, top, &params);
+    if (!element) return element;
+
+    // Размер не задан - остается размер класса; выводы расставляет конструктор
+    if (Record.Width > 0 && Record.Height > 0) {
+        element->SetBounds(TRect(left, top, left + Record.Width, top + Record.Height));
+    }
+    if (Record.HasName) {
+        element->SetName(FromUtf8(Record.Name));
+    }
+    element->SetCurrentState(static_cast<TTernary>(Record.State));
+    element->LoadParams(params);
+    // В списках, записанных до разделения параметров, состояние лежит среди
+    // обычных параметров
+    element->LoadState(Record.StateParams.empty() ? params : TNetlistParams(Record.StateParams));
+    return element;
+}
+
+void TSerializationManager::LoadSchemeFromNetlist(const String& FileName, TTabData* TabData) {
+    if (!TabData) return;
+
+    std::unique_ptr<TFileStream> file(new TFileStream(FileName, fmOpenRead | fmShareDenyWrite));
+    TStreamBuffer buffer(file.get());
+    std::istream stream(&buffer);
+    TNetlistReader reader(stream);
+
+    ReadNetlist(reader, TNetlistOffset(), TabData->Elements, TabData->Connections, TabData->NextElementId);
+}
+
+void TSerializationManager::ReadNetlist(TNetlistReader& Reader, const TNetlistOffset& Offset,
+                                        std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                                        std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections,
+                                        int& NextElementId) {
+    // Уровень схемы: верхний или содержимое открытой подсхемы
+    struct TLevel {
+        TNetlistElement Header;
+        std::vector<std::unique_ptr<TCircuitElement>> Elements;
+        std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>> Connections;
+        TElementIdMap Ids;      // по Id из файла, без сдвига
+    };
+    std::vector<TLevel> levels(1);
+
+    auto fail = [&](const String& Message) {
+        throw Exception("Список соединений, строка " + IntToStr((int)Reader.GetLineNumber()) + ": " + Message);
+    };
+
+    auto addElement = [&](int32_t Id, std::unique_ptr<TCircuitElement> Element) {
+        TLevel& level = levels.back();
+        if (!level.Ids.insert(std::make_pair(Id, Element.get())).second) {
+            fail("повторяется Id " + IntToStr(Id));
+        }
+        level.Elements.push_back(std::move(Element));
+    };
+
+    auto resolvePin = [&](const TNetlistPin& Pin) -> TConnectionPoint* {
+        const TElementIdMap& ids = levels.back().Ids;
+        auto it = ids.find(Pin.Element);
+        if (it == ids.end()) fail("нет элемента " + IntToStr(Pin.Element));
+
+        auto& points = Pin.IsInput ? it->second->Inputs : it->second->Outputs;
+        if (Pin.Port >= points.size()) {
+            fail("у элемента " + IntToStr(Pin.Element) + " нет вывода " +
+                 (Pin.IsInput ? "in" : "out") + IntToStr((int)Pin.Port));
+        }
+        return &points[Pin.Port];
+    };
+
+    int nextElementId = 0;
+    TNetlistRecord record;
+    while (Reader.Next(record)) {
+        switch (record.Kind) {
+        case nrNextId:
+            nextElementId = record.NextElementId;
+            break;
+
+        case nrElement: {
+            auto element = CreateNetlistElement(record.Element, Offset);
+            if (!element) fail("неизвестный класс " + FromUtf8(record.Element.ClassName));
+            addElement(record.Element.Id, std::move(element));
+            break;
+        }
+
+        case nrSubCircuit:
+            levels.push_back(TLevel());
+            levels.back().Header = record.Element;
+            break;
+
+        case nrEnd: {
+            // Внешние выводы подсхемы строятся по ее содержимому
+            TLevel level = std::move(levels.back());
+            levels.pop_back();
+            const TNetlistElement& header = level.Header;
+            int left = header.Left + Offset.X;
+            int top = header.Top + Offset.Y;
+            std::unique_ptr<TCircuitElement> subCircuit(new TSubCircuit(header.Id + Offset.Id, left, top,
+                std::move(level.Elements), level.Connections));
+            if (header.Width > 0 && header.Height > 0) {
+                subCircuit->SetBounds(TRect(left, top, left + header.Width, top + header.Height));
+            }
+            if (header.HasName) subCircuit->SetName(FromUtf8(header.Name));
+            subCircuit->SetCurrentState(static_cast<TTernary>(header.State));
+            addElement(header.Id, std::move(subCircuit));
+            break;
+        }
+
+        case nrNet: {
+            TConnectionPoint* source = resolvePin(record.Pins[0]);
+            for (size_t i = 1; i < record.Pins.size(); i++) {
+                levels.back().Connections.push_back(std::make_pair(source, resolvePin(record.Pins[i])));
+            }
+            break;
+        }
+        }
+    }
+    if (Reader.GetError() != TNetlistReader::neNone) {
+        fail(NetlistErrorText(Reader.GetError()));
+    }
+
+    // Без строки next Id продолжаются после наибольшего
+    TLevel& top = levels.front();
+    if (nextElementId <= 0) {
+        nextElementId = 1;
+        for (const auto& element : top.Elements) {
+            nextElementId = std::max(nextElementId, element->Id + 1);
+        }
+    }
+
+    NextElementId = nextElementId;
+    for (auto& element : top.Elements) {
+        Elements.push_back(std::move(element));
+    }
+    Connections.insert(Connections.end(), top.Connections.begin(), top.Connections.end());
+}
+
+bool TSerializationManager::IsNetlistFile(const String& FileName) {
+    char data[16];
+    int count = 0;
+    try {
+        std::unique_ptr<TFileStream> file(new TFileStream(FileName, fmOpenRead | fmShareDenyWrite));
+        count = file->Read(data, (int)sizeof(data));
+    }
+    catch (Exception&) {
+        return false;
+    }
+    return count > 0 && TNetlistReader::HasNetlistMagic(data, (size_t)count);
+}
+
+void TSerializationManager::ConvertSchemeFile(const String& Source, const String& Target) {
+    // Вкладка без окна: только элементы и соединения
+    TTabData tabData;
+    LoadSchemeFromFile(Source, &tabData);
+    SaveSchemeToFile(Target, &tabData);
+}
+
+void TSerializationManager::CompareSchemes(TTabData* Old, TTabData* New, TSchemeDiff& Diff) {
+    std::ostringstream oldText;
+    std::ostringstream newText;
+    WriteNetlist(oldText, Old);
+    WriteNetlist(newText, New);
+
+    std::istringstream oldStream(oldText.str());
+    std::istringstream newStream(newText.str());
+    if (!Diff.Compare(oldStream, newStream)) {
+        throw Exception("Сравнение схем: " + NetlistErrorText(Diff.GetError()));
+    }
+}
+
+void TSerializationManager::CompareSchemeFiles(const String& Old, const String& New, TSchemeDiff& Diff) {
+    TTabData oldData;
+    TTabData newData;
+    LoadSchemeFromFile(Old, &oldData);
+    LoadSchemeFromFile(New, &newData);
+    CompareSchemes(&oldData, &newData, Diff);
+}
+
+void TSerializationManager::SaveDiffReport(const String& FileName, const TSchemeDiff& Diff) {
+    std::unique_ptr<TFileStream> file(new TFileStream(FileName, fmCreate));
+    TStreamBuffer buffer(file.get());
+    std::ostream stream(&buffer);
+    Diff.WriteReport(stream);
+    stream.flush();
+}
+
+String TSerializationManager::GetUntitledFolder() {
+    return TPath::Combine(TPath::GetTempPath(), "SetunIDE");
+}
+
+TSchemeJournal* TSerializationManager::GetJournal(TTabData* TabData) {
+    // Вкладки подсхем показывают копию содержимого и не сохраняются
+    if (!TabData || TabData->IsSubCircuit) return nullptr;
+
+    if (!TabData->Journal) {
+        // Схема, которая еще не сохранялась, пишет автосохранение во временную папку
+        static int untitledCount = 0;
+        String folder = GetUntitledFolder();
+        ForceDirectories(folder);
+        String baseName = TPath::Combine(folder, "Untitled-" + FormatDateTime("yyyymmdd-hhnnss", Now()) + "-" +
+                                                 IntToStr(++untitledCount) + ".setun");
+        AttachJournal(TabData, baseName, false);
+
+        // Снимок сразу, в потоке журнала: файл .autosave можно открыть для восстановления
+        TabData->Journal->Compact();
+    }
+    return TabData->Journal.get();
+}
+
+void TSerializationManager::AttachJournal(TTabData* TabData, const String& BaseName, bool KeepExisting) {
+    if (!TabData || TabData->IsSubCircuit) return;
+
+    // Прежнее автосохранение вкладки больше не нужно: схема сохранена или заменена
+    CloseJournal(TabData, true);
+    if (!KeepExisting) {
+        TSchemeJournal::DeleteFiles(BaseName.c_str());
+    }
+
+    TabData->JournalBaseName = BaseName;
+    TabData->JournalTemporary = SameFileName(ExtractFileDir(BaseName), GetUntitledFolder());
+    TabData->Journal.reset(new TSchemeJournal(BaseName.c_str(), &CompactSchemeImage, MinJournalCompactSize));
+
+    // До первого снимка основой журнала служит сам файл схемы. INI поток журнала
+    // не разбирает - снимок строится сразу, вместе с загрузкой, а не при правке
+    String snapshot = TSchemeJournal::GetSnapshotPath(BaseName.c_str()).c_str();
+    if (!FileExists(snapshot) && FileExists(BaseName) && !TSchemeFileView::HasSchemeMagic(BaseName.c_str())) {
+        CompactJournal(TabData);
+    }
+}
+
+void TSerializationManager::CloseJournal(TTabData* TabData, bool Discard) {
+    if (!TabData || !TabData->Journal) return;
+
+    if (Discard) {
+        TabData->Journal->Discard();
+    }
+    TabData->Journal.reset();
+    TabData->JournalBaseName = "";
+    TabData->JournalTemporary = false;
+}
+
+bool TSerializationManager::HasAutosave(const String& BaseName) {
+    std::wstring baseName = BaseName.c_str();
+    if (TSchemeJournal::FileExists(TSchemeJournal::GetSnapshotPath(baseName))) return true;
+
+    std::vector<TSchemeJournal::TRecord> records;
+    return TSchemeJournal::ReadRecords(TSchemeJournal::GetJournalPath(baseName), records) && !records.empty();
+}
+
+void TSerializationManager::RecoverScheme(const String& BaseName, TTabData* TabData) {
+    if (!TabData) return;
+
+    std::wstring baseName = BaseName.c_str();
+    String snapshot = TSchemeJournal::GetSnapshotPath(baseName).c_str();
+    if (FileExists(snapshot)) {
+        LoadSchemeFromFile(snapshot, TabData);
+    } else if (FileExists(BaseName)) {
+        LoadSchemeFromFile(BaseName, TabData);
+    }
+
+    std::vector<TSchemeJournal::TRecord> records;
+    TSchemeJournal::ReadRecords(TSchemeJournal::GetJournalPath(baseName), records);
+
+    TJournalReplay replay;
+    BeginJournalReplay(TabData, replay);
+    try {
+        for (const auto& record : records) {
+            ApplyJournalRecord(TabData, record, replay);
+        }
+    } catch (...) {
+        FinishJournalReplay(TabData, replay);
+        throw;
+    }
+    FinishJournalReplay(TabData, replay);
+}
+
+void TSerializationManager::ApplyJournalRecord(TTabData* TabData, const TSchemeJournal::TRecord& Record,
+                                               TJournalReplay& Replay) {
+    switch (Record.Kind) {
+        case rkPutElements: {
+            std::shared_ptr<TSchemeLoadContext> context = std::make_shared<TSchemeLoadContext>();
+            if (!context->View.Open(std::vector<unsigned char>(Record.Payload.begin(), Record.Payload.end()))) {
+                break;
+            }
+
+            std::vector<std::unique_ptr<TCircuitElement>> loaded;
+            std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>> connections;
+            LoadSchemeImage(context, loaded, connections);
+            TabData->NextElementId = std::max(TabData->NextElementId, (int)context->View.GetHeader().NextElementId);
+
+            for (auto& element : loaded) {
+                auto existing = Replay.Elements.find(element->Id);
+                if (existing != Replay.Elements.end()) {
+                    ReplaceElement(TabData, Replay, existing->second, std::move(element));
+                } else {
+                    AddReplayElement(TabData, Replay, std::move(element));
+                }
+            }
+
+            for (const auto& connection : connections) {
+                AddReplayConnection(Replay, connection);
+            }
+            break;
+        }
+
+        case rkRemoveElements: {
+            size_t position = 0;
+            int32_t id;
+            while (ReadInt32(Record.Payload, position, id)) {
+                auto existing = Replay.Elements.find(id);
+                if (existing != Replay.Elements.end()) {
+                    RemoveElement(Replay, existing->second);
+                }
+            }
+            break;
+        }
+
+        case rkConnect:
+        case rkDisconnect: {
+            size_t position = 0;
+            TConnectionPointRef refs[2];
+            bool complete = true;
+            for (auto& ref : refs) {
+                int32_t id, isInput, port;
+                complete = complete && ReadInt32(Record.Payload, position, id) &&
+                           ReadInt32(Record.Payload, position, isInput) &&
+                           ReadInt32(Record.Payload, position, port);
+                ref.ElementId = id;
+                ref.IsInput = isInput != 0;
+                ref.PortIndex = port;
+                ref.RelX = ref.RelY = 0;
+            }
+            if (!complete) break;
+
+            std::pair<TConnectionPoint*, TConnectionPoint*> connection(
+                FindConnectionPoint(Replay.Elements, refs[0]), FindConnectionPoint(Replay.Elements, refs[1]));
+            if (!connection.first || !connection.second) break;
+
+            if (Record.Kind == rkDisconnect) {
+                auto existing = Replay.ConnectionIndex.find(connection);
+                if (existing != Replay.ConnectionIndex.end()) {
+                    RemoveReplayConnection(Replay, existing->second);
+                }
+            } else {
+                AddReplayConnection(Replay, connection);
+            }
+            break;
+        }
+
+        case rkMoveElement: {
+            size_t position = 0;
+            int32_t id, left, top, width, height, portCount;
+            if (!ReadInt32(Record.Payload, position, id) || !ReadInt32(Record.Payload, position, left) ||
+                !ReadInt32(Record.Payload, position, top) || !ReadInt32(Record.Payload, position, width) ||
+                !ReadInt32(Record.Payload, position, height) || !ReadInt32(Record.Payload, position, portCount)) {
+                break;
+            }
+
+            auto existing = Replay.Elements.find(id);
+            if (existing == Replay.Elements.end()) break;
+            TCircuitElement* element = existing->second;
+
+            // Положения выводов задаются до границ: по ним SetBounds расставляет выводы
+            for (int32_t p = 0; p < portCount; p++) {
+                double relX, relY;
+                if (!ReadValue(Record.Payload, position, relX) || !ReadValue(Record.Payload, position, relY)) break;
+
+                size_t inputs = element->Inputs.size();
+                TConnectionPoint* point = (size_t)p < inputs ? &element->Inputs[p] :
+                    (size_t)p - inputs < element->Outputs.size() ? &element->Outputs[p - inputs] : nullptr;
+                if (point) {
+                    point->RelX = relX;
+                    point->RelY = relY;
+                }
+            }
+            element->SetBounds(TRect(left, top, left + width, top + height));
+            break;
+        }
+
+        case rkClear:
+            TabData->Elements.clear();
+            TabData->NextElementId = 1;
+            Replay = TJournalReplay();
+            break;
+    }
+}
+
+void TSerializationManager::AppendJournal(TTabData* TabData, uint8_t Kind, const std::string& Payload) {
+    TSchemeJournal* journal = GetJournal(TabData);
+    if (!journal) return;
+
+    journal->Append(Kind, Payload);
+    // Журнал сворачивает его поток; здесь снимок строится, только если поток
+    // не смог разобрать основу журнала
+    if (journal->NeedsSnapshot()) {
+        CompactJournal(TabData);
+    }
+}
+
+void TSerializationManager::JournalPut(TTabData* TabData, const std::vector<TCircuitElement*>& Elements) {
+    if (!TabData || TabData->IsSubCircuit || Elements.empty()) return;
+
+    // Соединения элементов сохраняются при замене, новые пишутся отдельными записями
+    std::string image;
+    if (BuildSchemeImage(Elements, std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>(),
+                         TabData->NextElementId, image)) {
+        AppendJournal(TabData, rkPutElements, image);
+    }
+}
+
+void TSerializationManager::JournalMove(TTabData* TabData, TCircuitElement* Element) {
+    if (!TabData || TabData->IsSubCircuit || !Element) return;
+
+    // Элемент не пересобирается целиком: у подсхемы это потребовало бы загрузить содержимое
+    std::string payload;
+    AppendInt32(payload, Element->Id);
+    AppendInt32(payload, Element->Bounds.Left);
+    AppendInt32(payload, Element->Bounds.Top);
+    AppendInt32(payload, Element->Bounds.Width());
+    AppendInt32(payload, Element->Bounds.Height());
+    AppendInt32(payload, (int32_t)(Element->Inputs.size() + Element->Outputs.size()));
+    for (const auto& point : Element->Inputs) {
+        AppendDouble(payload, point.RelX);
+        AppendDouble(payload, point.RelY);
+    }
+    for (const auto& point : Element->Outputs) {
+        AppendDouble(payload, point.RelX);
+        AppendDouble(payload, point.RelY);
+    }
+    AppendJournal(TabData, rkMoveElement, payload);
+}
+
+void TSerializationManager::JournalRemove(TTabData* TabData, const std::vector<int>& Ids) {
+    if (!TabData || TabData->IsSubCircuit || Ids.empty()) return;
+
+    std::string payload;
+    payload.reserve(Ids.size() * sizeof(int32_t));
+    for (int id : Ids) {
+        AppendInt32(payload, id);
+    }
+    AppendJournal(TabData, rkRemoveElements, payload);
+}
+
+void TSerializationManager::JournalConnect(TTabData* TabData,
+                                           const std::pair<TConnectionPoint*, TConnectionPoint*>& Connection) {
+    AppendConnectionRecord(TabData, rkConnect, Connection);
+}
+
+void TSerializationManager::JournalDisconnect(TTabData* TabData,
+                                              const std::pair<TConnectionPoint*, TConnectionPoint*>& Connection) {
+    AppendConnectionRecord(TabData, rkDisconnect, Connection);
+}
+
+void TSerializationManager::AppendConnectionRecord(TTabData* TabData, uint8_t Kind,
+                                                   const std::pair<TConnectionPoint*, TConnectionPoint*>& Connection) {
+    if (!TabData || TabData->IsSubCircuit) return;
+
+    // Промежуточные точки проводов не принадлежат элементам и не сохраняются
+    int fromPort = PortIndexOf(Connection.first);
+    int toPort = PortIndexOf(Connection.second);
+    if (fromPort < 0 || toPort < 0) return;
+
+    std::string payload;
+    AppendInt32(payload, Connection.first->Owner->Id);
+    AppendInt32(payload, Connection.first->IsInput ? 1 : 0);
+    AppendInt32(payload, fromPort);
+    AppendInt32(payload, Connection.second->Owner->Id);
+    AppendInt32(payload, Connection.second->IsInput ? 1 : 0);
+    AppendInt32(payload, toPort);
+    AppendJournal(TabData, Kind, payload);
+}
+
+void TSerializationManager::JournalClear(TTabData* TabData) {
+    // Пустую схему без журнала восстанавливать незачем
+    if (!TabData || !TabData->Journal) return;
+
+    TabData->Journal->Append(rkClear, std::string());
+    TabData->Journal->Compact();
+}
+
+void TSerializationManager::CompactJournal(TTabData* TabData) {
+    if (!TabData || !TabData->Journal) return;
+
+    // Образ собирается здесь, пока схема не меняется; на диск его пишет поток журнала.
+    // Нужен, только когда основу журнала нельзя свернуть в его потоке
+    std::vector<TCircuitElement*> elements;
+    elements.reserve(TabData->Elements.size());
+    for (const auto& element : TabData->Elements) {
+        elements.push_back(element.get());
+    }
+
+    std::string image;
+    if (BuildSchemeImage(elements, TabData->Connections, TabData->NextElementId, image)) {
+        TabData->Journal->WriteSnapshot(std::move(image));
+    }
+}
+
+void TSerializationManager::SaveElementToIni(TCircuitElement* Element, TCustomIniFile* IniFile, const String& Section) {
+    if (Element) {
+        Element->SaveToIni(IniFile, Section);
+
+        TSubCircuit* subCircuit = dynamic_cast<TSubCircuit*>(Element);
+        if (subCircuit) {
+            SaveSubCircuitToIni(subCircuit, IniFile, Section);
+        }
+    }
+}
+
+void TSerializationManager::SaveSubCircuitToIni(TSubCircuit* SubCircuit, TCustomIniFile* IniFile,
+                                                const String& Section) {
+    TNetlistOffset offset;
+    TInstanceState state;
+    std::shared_ptr<const TSubCircuitDefinition> definition = GetSubCircuitDefinition(SubCircuit, offset, state);
+
+    // Секция определения пишется при первом экземпляре с таким текстом
+    auto known = FIniDefinitionNames.find(definition->Text);
+    if (known == FIniDefinitionNames.end()) {
+        String name = "SubCircuit_" + IntToHex((__int64)definition->Hash, 16);
+        if (IniFile->SectionExists(name)) {
+            name += "_" + IntToStr((int)FIniDefinitionNames.size());
+        }
+        known = FIniDefinitionNames.insert(std::make_pair(definition->Text, name)).first;
+
+        int lineCount = 0;
+        size_t start = 0;
+        const std::string& text = definition->Text;
+        while (start < text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos) end = text.size();
+            IniFile->WriteString(name, "Line_" + IntToStr(lineCount++), FromUtf8(text.substr(start, end - start)));
+            start = end + 1;
+        }
+        IniFile->WriteInteger(name, "LineCount", lineCount);
+    }
+
+    IniFile->WriteString(Section, "Definition", known->second);
+    IniFile->WriteInteger(Section, "DefinitionX", offset.X);
+    IniFile->WriteInteger(Section, "DefinitionY", offset.Y);
+    IniFile->WriteInteger(Section, "DefinitionIdBase", offset.Id);
+    if (!state.States.empty()) {
+        IniFile->WriteString(Section, "DefinitionStates", String(state.States.c_str()));
+    }
+    if (!state.Params.empty()) {
+        IniFile->WriteString(Section, "DefinitionStateParams", String(state.Params.c_str()));
+    }
+}
+
+std::unique_ptr<TCircuitElement> TSerializationManager::LoadElementFromIni(TCustomIniFile* IniFile, const String& Section) {
+    String className = IniFile->ReadString(Section, "ClassName", "");
+    int id = IniFile->ReadInteger(Section, "Id", 0);
+    int x = IniFile->ReadInteger(Section, "X", 0);
+    int y = IniFile->ReadInteger(Section, "Y", 0);
+
+    auto element = CreateElementByClassName(className, id, x, y);
+    if (element) {
+        element->LoadFromIni(IniFile, Section);
+
+        TSubCircuit* subCircuit = dynamic_cast<TSubCircuit*>(element.get());
+        if (subCircuit) {
+            LoadSubCircuitFromIni(subCircuit, IniFile, Section);
+        }
+    }
+
+    return element;
+}
+
+void TSerializationManager::LoadSubCircuitFromIni(TSubCircuit* SubCircuit, TCustomIniFile* IniFile,
+                                                  const String& Section) {
+    String name = IniFile->ReadString(Section, "Definition", "");
+    if (!name.IsEmpty()) {
+        // Внешние выводы уже прочитаны из секции экземпляра, содержимое
+        // загружается при первом обращении
+        auto& definition = FIniDefinitions[std::wstring(name.c_str())];
+        if (!definition) {
+            std::string text;
+            int lineCount = IniFile->ReadInteger(name, "LineCount", 0);
+            for (int i = 0; i < lineCount; i++) {
+                text += ToUtf8(IniFile->ReadString(name, "Line_" + IntToStr(i), ""));
+                text += '\n';
+            }
+            definition = MakeDefinition(std::move(text));
+        }
+
+        TNetlistOffset offset;
+        offset.X = IniFile->ReadInteger(Section, "DefinitionX", 0);
+        offset.Y = IniFile->ReadInteger(Section, "DefinitionY", 0);
+        offset.Id = IniFile->ReadInteger(Section, "DefinitionIdBase", 0);
+        TInstanceState state;
+        state.States = ToUtf8(IniFile->ReadString(Section, "DefinitionStates", ""));
+        state.Params = ToUtf8(IniFile->ReadString(Section, "DefinitionStateParams", ""));
+        SubCircuit->SetSource(std::unique_ptr<TSubCircuitSource>(
+            new TNetlistSubCircuitSource(this, definition, offset, std::move(state))));
+        return;
+    }
+
+    // Файлы версии 3.0: содержимое каждого экземпляра в своих секциях
+    std::vector<std::unique_ptr<TCircuitElement>> elements;
+    int internalElementCount = IniFile->ReadInteger(Section, "InternalElementCount", 0);
+    for (int i = 0; i < internalElementCount; i++) {
+        auto element = LoadElementFromIni(IniFile, Section + "_Internal_" + IntToStr(i));
+        if (element) {
+            elements.push_back(std::move(element));
+        }
+    }
+
+    TElementIdMap internalById;
+    for (auto& element : elements) {
+        internalById[element->Id] = element.get();
+    }
+
+    std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>> connections;
+    int internalConnCount = IniFile->ReadInteger(Section, "InternalConnectionCount", 0);
+    for (int i = 0; i < internalConnCount; i++) {
+        std::pair<TConnectionPoint*, TConnectionPoint*> connection;
+        if (LoadConnection(IniFile, Section + "_InternalConn_" + IntToStr(i), internalById, connection)) {
+            connections.push_back(connection);
+        }
+    }
+
+    SubCircuit->SetInternals(std::move(elements), connections);
+}
+
+void TSerializationManager::SaveConnectionPoint(const TConnectionPoint* Point, TCustomIniFile* IniFile,
+                                               const String& Section, const String& Prefix) {
+    if (!Point || !Point->Owner) return;
+
+    IniFile->WriteInteger(Section, Prefix + "ElementId", Point->Owner->Id);
+    IniFile->WriteInteger(Section, Prefix + "PortIndex", PortIndexOf(Point));
+    // Координаты остаются для прежних версий программы
+    IniFile->WriteFloat(Section, Prefix + "RelX", Point->RelX);
+    IniFile->WriteFloat(Section, Prefix + "RelY", Point->RelY);
+    IniFile->WriteBool(Section, Prefix + "IsInput", Point->IsInput);
+}
+
+bool TSerializationManager::LoadConnectionPoint(TCustomIniFile* IniFile, const String& Section,
+                                                const String& Prefix, TConnectionPointRef& Ref) {
+    Ref.ElementId = IniFile->ReadInteger(Section, Prefix + "ElementId", -1);
+    if (Ref.ElementId == -1) return false;
+
+    Ref.IsInput = IniFile->ReadBool(Section, Prefix + "IsInput", true);
+    Ref.PortIndex = IniFile->ReadInteger(Section, Prefix + "PortIndex", -1);
+    Ref.RelX = IniFile->ReadFloat(Section, Prefix + "RelX", 0);
+    Ref.RelY = IniFile->ReadFloat(Section, Prefix + "RelY", 0);
+    return true;
+}
+
+bool TSerializationManager::LoadConnection(TCustomIniFile* IniFile, const String& Section,
+                                           const TElementIdMap& Elements,
+                                           std::pair<TConnectionPoint*, TConnectionPoint*>& Connection) {
+    TConnectionPointRef from, to;
+    if (!LoadConnectionPoint(IniFile, Section, "From", from) ||
+        !LoadConnectionPoint(IniFile, Section, "To", to)) {
+        return false;
+    }
+
+    Connection.first = FindConnectionPoint(Elements, from);
+    Connection.second = FindConnectionPoint(Elements, to);
+    return Connection.first && Connection.second;
+}
+
+TConnectionPoint* TSerializationManager::FindConnectionPoint(const TElementIdMap& Elements,
+                                                             const TConnectionPointRef& Ref) {
+    auto it = Elements.find(Ref.ElementId);
+    return it != Elements.end() ? FindConnectionPointInElement(it->second, Ref) : nullptr;
+}
+
+TConnectionPoint* TSerializationManager::FindConnectionPointInElement(TCircuitElement* Element,
+                                                                     const TConnectionPointRef& Ref) {
+    if (!Element) return nullptr;
+
+    auto& points = Ref.IsInput ? Element->Inputs : Element->Outputs;
+
+    if (Ref.PortIndex >= 0) {
+        return Ref.PortIndex < static_cast<int>(points.size()) ? &points[Ref.PortIndex] : nullptr;
+    }
+
+    // Схемы без номеров выводов: поиск по относительным координатам
+    for (auto& point : points) {
+        if (fabs(point.RelX - Ref.RelX) < 0.001 &&
+            fabs(point.RelY - Ref.RelY) < 0.001) {
+            return &point;
+        }
+    }
+
+    return nullptr;
+}
+
+std::unique_ptr<TCircuitElement> TSerializationManager::CreateElementByClassName(const String& ClassName, 
+                                                                                int Id, int X, int Y,
+                                                                                const TElementParams* Params) {
+    auto param = [Params](const char* Key, int Default) {
+        return Params ? Params->ReadInteger(Key, Default) : Default;
+    };
+
+    if (ClassName == "TMagneticAmplifier") {
+        return std::make_unique<TMagneticAmplifier>(Id, X, Y, false);
+    } else if (ClassName == "TTernaryElement") {
+        return std::make_unique<TTernaryElement>(Id, X, Y);
+    } else if (ClassName == "TShiftRegister") {
+        return std::make_unique<TShiftRegister>(Id, X, Y, param("BitCount", 4));
+    } else if (ClassName == "TTernaryTrigger") {
+        return std::make_unique<TTernaryTrigger>(Id, X, Y);
+    } else if (ClassName == "THalfAdder") {
+        return std::make_unique<THalfAdder>(Id, X, Y);
+    } else if (ClassName == "TTernaryAdder") {
+        return std::make_unique<TTernaryAdder>(Id, X, Y);
+    } else if (ClassName == "TDecoder") {
+        return std::make_unique<TDecoder>(Id, X, Y, param("InputBits", 2));
+    } else if (ClassName == "TCounter") {
+        return std::make_unique<TCounter>(Id, X, Y, 3);
+    } else if (ClassName == "TDistributor") {
+        return std::make_unique<TDistributor>(Id, X, Y, param("TotalSteps", 8));
+    } else if (ClassName == "TSwitch") {
+        return std::make_unique<TSwitch>(Id, X, Y, 3);
+    } else if (ClassName == "TLogicAnd") {
+        return std::make_unique<TLogicAnd>(Id, X, Y);
+    } else if (ClassName == "TLogicOr") {
+        return std::make_unique<TLogicOr>(Id, X, Y);
+    } else if (ClassName == "TLogicInhibit") {
+        return std::make_unique<TLogicInhibit>(Id, X, Y);
+    } else if (ClassName == "TGenerator") {
+        return std::make_unique<TGenerator>(Id, X, Y);
+    } else if (ClassName == "TSubCircuit") {
+        return std::make_unique<TSubCircuit>(Id, X, Y,
+            std::vector<std::unique_ptr<TCircuitElement>>(),
+            std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>());
+    }
+
+    return nullptr;
 }
\ No newline at end of file
@@ -1,47 +1,184 @@
-#ifndef SerializationManagerH
-#define SerializationManagerH
-
-#include "CircuitElement.h"
-#include "CircuitElements.h"
-#include "ComponentLibrary.h"
-#include <System.IniFiles.hpp>
-#include <memory>
-#include <map>
-
-// Временный класс для загрузки соединений
-class TTempCircuitElement : public TCircuitElement {
-public:
-    TTempCircuitElement(int AId) : TCircuitElement(AId, "Temp", 0, 0) {}
-    void Calculate() override {
-        // Пустая реализация для временного элемента
-    }
-};
-
-class TTabData;
-class TMainForm;
-
-class TSerializationManager {
-private:
-    TMainForm* FMainForm;
-
-public:
-    TSerializationManager(TMainForm* MainForm);
-
-    void SaveSchemeToFile(const String& FileName, TTabData* TabData);
-    void LoadSchemeFromFile(const String& FileName, TTabData* TabData);
-
-    void SaveElementToIni(TCircuitElement* Element, TIniFile* IniFile, const String& Section);
-    std::unique_ptr<TCircuitElement> LoadElementFromIni(TIniFile* IniFile, const String& Section);
-
-    void SaveConnectionPoint(const TConnectionPoint* Point, TIniFile* IniFile,
-                           const String& Section, const String& Prefix);
-    TConnectionPoint* LoadConnectionPoint(TIniFile* IniFile, const String& Section,
-                                        const String& Prefix, TCircuitElement* Owner);
-
-    TConnectionPoint* FindConnectionPointInElement(TCircuitElement* element,
-                                                 const TConnectionPoint* pointTemplate);
-    std::unique_ptr<TCircuitElement> CreateElementByClassName(const String& ClassName,
-                                                            int Id, int X, int Y);
-};
-
-#endif
+#ifndef SerializationManagerH
+#define SerializationManagerH
+
+#include "CircuitElement.h"
+#include "CircuitElements.h"
+#include "ComponentLibrary.h"
+#include "SchemeFile.h"
+#include "IniIndex.h"
+#include "SchemeJournal.h"
+#include "NetlistFile.h"
+#include "SchemeDiff.h"
+#include <System.IniFiles.hpp>
+#include <memory>
+#include <unordered_map>
+
+// Вывод, на который ссылается соединение в INI-файле: элемент, направление и
+// номер вывода. В схемах прежних версий номера нет, тогда вывод ищется по
+// относительным координатам
+struct TConnectionPointRef {
+    int ElementId;
+    bool IsInput;
+    int PortIndex;      // -1 - номер не сохранен
+    double RelX;
+    double RelY;
+};
+
+typedef std::unordered_map<int, TCircuitElement*> TElementIdMap;
+
+// Сдвиг координат и Id при записи в список соединений и чтении из него:
+// содержимое подсхемы хранится от левого верхнего угла своих элементов и наименьшего Id
+struct TNetlistOffset {
+    int X;
+    int Y;
+    int Id;
+
+    TNetlistOffset() : X(0), Y(0), Id(0) {}
+};
+
+// Только для чтения: файл разбирается один раз при создании, дальше ключи
+// ищутся в индексе без обращений к диску. Числа читаются одинаково при любых
+// региональных настройках
+class TIndexedIniFile : public TCustomIniFile {
+private:
+    TIniIndex FIndex;
+
+    String SpanToString(const TIniIndex::TSpan& Span) const;
+    std::string ToIndexString(const String& Value) const;
+
+public:
+    __fastcall TIndexedIniFile(const String& FileName);
+
+    virtual String __fastcall ReadString(const String Section, const String Ident, const String Default);
+    virtual int __fastcall ReadInteger(const String Section, const String Ident, int Default);
+    virtual double __fastcall ReadFloat(const String Section, const String Name, double Default);
+    virtual bool __fastcall ReadBool(const String Section, const String Ident, bool Default);
+    virtual bool __fastcall SectionExists(const String Section);
+    virtual bool __fastcall ValueExists(const String Section, const String Ident);
+
+    using TCustomIniFile::ReadSections;
+    virtual void __fastcall ReadSection(const String Section, TStrings* Strings);
+    virtual void __fastcall ReadSections(TStrings* Strings);
+    virtual void __fastcall ReadSectionValues(const String Section, TStrings* Strings);
+
+    virtual void __fastcall WriteString(const String Section, const String Ident, const String Value);
+    virtual void __fastcall EraseSection(const String Section);
+    virtual void __fastcall DeleteKey(const String Section, const String Ident);
+    virtual void __fastcall UpdateFile();
+};
+
+class TTabData;
+class TMainForm;
+class TSubCircuit;
+struct TSchemeLoadContext;
+struct TSubCircuitDefinition;
+struct TJournalReplay;
+
+class TSerializationManager {
+private:
+    TMainForm* FMainForm;
+
+    // Вызывается из рабочих потоков загрузки
+    std::unique_ptr<TCircuitElement> LoadElementFromRecord(const TSchemeFileView& View, uint32_t Index);
+    // Верхний уровень образа схемы, открытого в Context
+    void LoadSchemeImage(const std::shared_ptr<TSchemeLoadContext>& Context,
+                         std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                         std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections);
+
+    TSchemeJournal* GetJournal(TTabData* TabData);
+    void AppendJournal(TTabData* TabData, uint8_t Kind, const std::string& Payload);
+    void AppendConnectionRecord(TTabData* TabData, uint8_t Kind,
+                                const std::pair<TConnectionPoint*, TConnectionPoint*>& Connection);
+    void ApplyJournalRecord(TTabData* TabData, const TSchemeJournal::TRecord& Record, TJournalReplay& Replay);
+
+    std::unique_ptr<TCircuitElement> CreateNetlistElement(const TNetlistElement& Record, const TNetlistOffset& Offset);
+    void WriteNetlist(std::ostream& Stream, TTabData* TabData);
+
+    // Содержимое подсхем в INI: секция определения на каждый уникальный текст,
+    // экземпляры ссылаются на нее по имени. Заполняются на время сохранения и загрузки
+    std::unordered_map<std::string, String> FIniDefinitionNames;
+    std::unordered_map<std::wstring, std::shared_ptr<const TSubCircuitDefinition>> FIniDefinitions;
+    void SaveSubCircuitToIni(TSubCircuit* SubCircuit, TCustomIniFile* IniFile, const String& Section);
+    void LoadSubCircuitFromIni(TSubCircuit* SubCircuit, TCustomIniFile* IniFile, const String& Section);
+
+public:
+    TSerializationManager(TMainForm* MainForm);
+
+    // Схема сохраняется в двоичном формате; расширение .ini - экспорт в INI,
+    // .net - в список соединений. При загрузке формат определяется по содержимому файла
+    void SaveSchemeToFile(const String& FileName, TTabData* TabData);
+    void LoadSchemeFromFile(const String& FileName, TTabData* TabData);
+
+    void SaveSchemeToIni(const String& FileName, TTabData* TabData);
+    void LoadSchemeFromIni(const String& FileName, TTabData* TabData);
+    // Текстовый список соединений (NetlistFile.h), пишется и читается потоком
+    void SaveSchemeToNetlist(const String& FileName, TTabData* TabData);
+    void LoadSchemeFromNetlist(const String& FileName, TTabData* TabData);
+    static bool IsNetlistFile(const String& FileName);
+    // Элементы и соединения верхнего уровня списка соединений, сдвинутые на Offset
+    void ReadNetlist(TNetlistReader& Reader, const TNetlistOffset& Offset,
+                     std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                     std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections,
+                     int& NextElementId);
+    // Загрузка из Source и сохранение в Target, формат Target - по расширению
+    void ConvertSchemeFile(const String& Source, const String& Target);
+    // Структурная разница двух схем (SchemeDiff.h); схемы сравниваются в
+    // виде списков соединений, поэтому формат файлов не важен
+    void CompareSchemes(TTabData* Old, TTabData* New, TSchemeDiff& Diff);
+    void CompareSchemeFiles(const String& Old, const String& New, TSchemeDiff& Diff);
+    void SaveDiffReport(const String& FileName, const TSchemeDiff& Diff);
+    void SaveSchemeToBinary(const String& FileName, TTabData* TabData);
+    // false - файл не является двоичной схемой
+    bool LoadSchemeFromBinary(const String& FileName, TTabData* TabData);
+    // Элементы и соединения одного владельца (-1 - вкладка); содержимое
+    // вложенных подсхем загружается отдельно при первом обращении
+    void LoadSchemeLevel(const std::shared_ptr<TSchemeLoadContext>& Context, int32_t Parent,
+                         std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                         std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections);
+
+    // Автосохранение вкладки: изменения дописываются в журнал, запись на диск
+    // идет в фоне. Повтор записи не меняет схему, поэтому журнал можно
+    // применять поверх снимка, в который часть записей уже вошла
+    void JournalPut(TTabData* TabData, const std::vector<TCircuitElement*>& Elements);
+    // Новые границы элемента: перемещение и поворот
+    void JournalMove(TTabData* TabData, TCircuitElement* Element);
+    void JournalRemove(TTabData* TabData, const std::vector<int>& Ids);
+    void JournalConnect(TTabData* TabData, const std::pair<TConnectionPoint*, TConnectionPoint*>& Connection);
+    void JournalDisconnect(TTabData* TabData, const std::pair<TConnectionPoint*, TConnectionPoint*>& Connection);
+    void JournalClear(TTabData* TabData);
+    // Полный снимок вкладки вместо накопленного журнала. Обычно журнал
+    // сворачивает его поток, здесь - только основа, которую поток не разберет
+    void CompactJournal(TTabData* TabData);
+
+    // Автосохранение вкладки относится к файлу BaseName; без KeepExisting
+    // прежние файлы автосохранения удаляются
+    void AttachJournal(TTabData* TabData, const String& BaseName, bool KeepExisting);
+    // Остановить автосохранение вкладки; Discard - удалить его файлы
+    void CloseJournal(TTabData* TabData, bool Discard);
+    // Для файла есть несохраненные изменения
+    bool HasAutosave(const String& BaseName);
+    // Снимок автосохранения (или сам файл) и записи журнала поверх него
+    void RecoverScheme(const String& BaseName, TTabData* TabData);
+    // Папка автосохранения схем, которые еще не сохранялись
+    String GetUntitledFolder();
+
+    void SaveElementToIni(TCircuitElement* Element, TCustomIniFile* IniFile, const String& Section);
+    std::unique_ptr<TCircuitElement> LoadElementFromIni(TCustomIniFile* IniFile, const String& Section);
+
+    void SaveConnectionPoint(const TConnectionPoint* Point, TCustomIniFile* IniFile,
+                           const String& Section, const String& Prefix);
+    bool LoadConnectionPoint(TCustomIniFile* IniFile, const String& Section,
+                             const String& Prefix, TConnectionPointRef& Ref);
+    // Загружает соединение секции и находит оба вывода среди Elements
+    bool LoadConnection(TCustomIniFile* IniFile, const String& Section, const TElementIdMap& Elements,
+                        std::pair<TConnectionPoint*, TConnectionPoint*>& Connection);
+
+    TConnectionPoint* FindConnectionPoint(const TElementIdMap& Elements, const TConnectionPointRef& Ref);
+    TConnectionPoint* FindConnectionPointInElement(TCircuitElement* Element, const TConnectionPointRef& Ref);
+    // Params - параметры, от которых зависят размер и число выводов элемента
+    std::unique_ptr<TCircuitElement> CreateElementByClassName(const String& ClassName,
+                                                            int Id, int X, int Y,
+                                                            const TElementParams* Params = nullptr);
+};
+
+#endif
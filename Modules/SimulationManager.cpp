@@ -1,87 +1,128 @@
-#include "SimulationManager.h"
-#include "MainForm.h"
-
-#pragma package(smart_init)
-
-TSimulationManager::TSimulationManager() 
-    : FSimulationRunning(false), FSimulationStep(0), FCurrentTab(nullptr) {
-    
-    FSimulationTimer = new TTimer(nullptr);
-    FSimulationTimer->Interval = 500;
-    FSimulationTimer->OnTimer = &SimulationTimerTimer;
-    FSimulationTimer->Enabled = false;
-}
-
-TSimulationManager::~TSimulationManager() {
-    FSimulationTimer->Enabled = false;
-    delete FSimulationTimer;
-}
-
-void TSimulationManager::SetCurrentTab(TTabData* Tab) {
-    FCurrentTab = Tab;
-}
-
-void TSimulationManager::RunSimulationStep() {
-    if (!FCurrentTab) return;
-
-    // Передача значений через соединения
-    for (auto& connection : FCurrentTab->Connections) {
-        if (connection.first && connection.second) {
-            connection.second->Value = connection.first->Value;
-        }
-    }
-
-    // Вычисление состояний элементов
-    for (auto& element : FCurrentTab->Elements) {
-        element->Calculate();
-    }
-
-    FSimulationStep++;
-}
-
-void TSimulationManager::ResetSimulation() {
-    if (!FCurrentTab) return;
-
-    for (auto& element : FCurrentTab->Elements) {
-        // Сброс специальных элементов
-        TTernaryTrigger* trigger = dynamic_cast<TTernaryTrigger*>(element.get());
-        if (trigger) {
-            trigger->Reset();
-        }
-
-        TCounter* counter = dynamic_cast<TCounter*>(element.get());
-        if (counter) {
-            counter->Reset();
-        }
-
-        // Сброс состояний входов/выходов
-        for (auto& input : element->Inputs) {
-            input.Value = TTernary::ZERO;
-        }
-        for (auto& output : element->Outputs) {
-            output.Value = TTernary::ZERO;
-        }
-    }
-
-    // Сброс соединений
-    for (auto& connection : FCurrentTab->Connections) {
-        if (connection.first) connection.first->Value = TTernary::ZERO;
-        if (connection.second) connection.second->Value = TTernary::ZERO;
-    }
-
-    FSimulationStep = 0;
-}
-
-void TSimulationManager::StartSimulation() {
-    FSimulationRunning = true;
-    FSimulationTimer->Enabled = true;
-}
-
-void TSimulationManager::StopSimulation() {
-    FSimulationRunning = false;
-    FSimulationTimer->Enabled = false;
-}
-
-void __fastcall TSimulationManager::SimulationTimerTimer(TObject* Sender) {
-    RunSimulationStep();
+#include "SimulationManager.h"
+#include "MainForm.h"
+
+#pragma package(smart_init)
+
+TSimulationManager::TSimulationManager() 
+    : FSimulationRunning(false), FSimulationStep(0), FCurrentTab(nullptr), FOnStep(nullptr) {
+    
+    FSimulationTimer = new TTimer(nullptr);
+    FSimulationTimer->Interval = 500;
+    FSimulationTimer->OnTimer = &SimulationTimerTimer;
+    FSimulationTimer->Enabled = false;
+}
+
+TSimulationManager::~TSimulationManager() {
+    FSimulationTimer->Enabled = false;
+    delete FSimulationTimer;
+}
+
+void TSimulationManager::SetCurrentTab(TTabData* Tab) {
+    FCurrentTab = Tab;
+    SyncConnectionSnapshot();
+}
+
+void TSimulationManager::SyncConnectionSnapshot() {
+    FConnectionSnapshot.clear();
+    FChangedConnections.clear();
+    if (!FCurrentTab) return;
+
+    FConnectionSnapshot.reserve(FCurrentTab->Connections.size());
+    for (auto& connection : FCurrentTab->Connections) {
+        FConnectionSnapshot.push_back(connection.first ? connection.first->Value : TTernary::ZERO);
+    }
+}
+
+void TSimulationManager::CollectChangedConnections() {
+    FChangedConnections.clear();
+
+    auto& connections = FCurrentTab->Connections;
+    // Соединения, добавленные после последнего шага, считаем изменившимися
+    if (FConnectionSnapshot.size() != connections.size()) {
+        FConnectionSnapshot.resize(connections.size(), TTernary::ZERO);
+        for (int i = 0; i < static_cast<int>(connections.size()); i++) {
+            FChangedConnections.push_back(i);
+            FConnectionSnapshot[i] = connections[i].first ? connections[i].first->Value : TTernary::ZERO;
+        }
+        return;
+    }
+
+    for (int i = 0; i < static_cast<int>(connections.size()); i++) {
+        TTernary value = connections[i].first ? connections[i].first->Value : TTernary::ZERO;
+        if (value != FConnectionSnapshot[i]) {
+            FConnectionSnapshot[i] = value;
+            FChangedConnections.push_back(i);
+        }
+    }
+}
+
+void TSimulationManager::RunSimulationStep() {
+    if (!FCurrentTab) return;
+
+    // Передача значений через соединения
+    for (auto& connection : FCurrentTab->Connections) {
+        if (connection.first && connection.second) {
+            connection.second->Value = connection.first->Value;
+        }
+    }
+
+    // Вычисление состояний элементов
+    for (auto& element : FCurrentTab->Elements) {
+        element->Calculate();
+    }
+
+    CollectChangedConnections();
+    FSimulationStep++;
+
+    if (FOnStep) {
+        FOnStep(FCurrentTab, FChangedConnections);
+    }
+}
+
+void TSimulationManager::ResetSimulation() {
+    if (!FCurrentTab) return;
+
+    for (auto& element : FCurrentTab->Elements) {
+        // Сброс специальных элементов
+        TTernaryTrigger* trigger = dynamic_cast<TTernaryTrigger*>(element.get());
+        if (trigger) {
+            trigger->Reset();
+        }
+
+        TCounter* counter = dynamic_cast<TCounter*>(element.get());
+        if (counter) {
+            counter->Reset();
+        }
+
+        // Сброс состояний входов/выходов
+        for (auto& input : element->Inputs) {
+            input.Value = TTernary::ZERO;
+        }
+        for (auto& output : element->Outputs) {
+            output.Value = TTernary::ZERO;
+        }
+    }
+
+    // Сброс соединений
+    for (auto& connection : FCurrentTab->Connections) {
+        if (connection.first) connection.first->Value = TTernary::ZERO;
+        if (connection.second) connection.second->Value = TTernary::ZERO;
+    }
+
+    FSimulationStep = 0;
+    SyncConnectionSnapshot();
+}
+
+void TSimulationManager::StartSimulation() {
+    FSimulationRunning = true;
+    FSimulationTimer->Enabled = true;
+}
+
+void TSimulationManager::StopSimulation() {
+    FSimulationRunning = false;
+    FSimulationTimer->Enabled = false;
+}
+
+void __fastcall TSimulationManager::SimulationTimerTimer(TObject* Sender) {
+    RunSimulationStep();
 }
\ No newline at end of file
@@ -1,33 +1,50 @@
-#ifndef SimulationManagerH
-#define SimulationManagerH
-
-#include "CircuitElement.h"
-#include "CircuitElements.h"
-#include <System.Classes.hpp>
-#include <Vcl.ExtCtrls.hpp>
-
-class TTabData;
-
-class TSimulationManager {
-private:
-    bool FSimulationRunning;
-    int FSimulationStep;
-    TTimer* FSimulationTimer;
-    TTabData* FCurrentTab;
-
-public:
-    TSimulationManager();
-    ~TSimulationManager();
-
-    void SetCurrentTab(TTabData* Tab);
-    void RunSimulationStep();
-    void ResetSimulation();
-    void StartSimulation();
-    void StopSimulation();
-    bool IsRunning() const { return FSimulationRunning; }
-    int GetSimulationStep() const { return FSimulationStep; }
-
-    void __fastcall SimulationTimerTimer(TObject* Sender);
-};
-
+#ifndef SimulationManagerH
+#define SimulationManagerH
+
+#include "CircuitElement.h"
+#include "CircuitElements.h"
+#include <System.Classes.hpp>
+#include <Vcl.ExtCtrls.hpp>
+#include <vector>
+
+class TTabData;
+
+// Уведомление о завершении шага: вкладка, которую считал менеджер, и индексы
+// соединений, значение которых изменилось
+typedef void __fastcall (__closure *TSimulationStepEvent)(TTabData* Tab, const std::vector<int>& ChangedConnections);
+
+class TSimulationManager {
+private:
+    bool FSimulationRunning;
+    int FSimulationStep;
+    TTimer* FSimulationTimer;
+    TTabData* FCurrentTab;
+    TSimulationStepEvent FOnStep;
+
+    // Значения соединений на момент предыдущего шага
+    std::vector<TTernary> FConnectionSnapshot;
+    std::vector<int> FChangedConnections;
+
+    void SyncConnectionSnapshot();
+    void CollectChangedConnections();
+
+public:
+    TSimulationManager();
+    ~TSimulationManager();
+
+    void SetCurrentTab(TTabData* Tab);
+    TTabData* GetCurrentTab() const { return FCurrentTab; }
+    void RunSimulationStep();
+    void ResetSimulation();
+    void StartSimulation();
+    void StopSimulation();
+    bool IsRunning() const { return FSimulationRunning; }
+    int GetSimulationStep() const { return FSimulationStep; }
+    const std::vector<int>& GetChangedConnections() const { return FChangedConnections; }
+
+    void SetOnStep(TSimulationStepEvent Handler) { FOnStep = Handler; }
+
+    void __fastcall SimulationTimerTimer(TObject* Sender);
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "SvgRenderTarget.h"
+#include <cstdio>
+
+#pragma package(smart_init)
+
+static std::string FormatNumber(double Value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.2f", Value);
+
+    // Без лишних нулей - документ заметно короче
+    std::string result(buffer);
+    size_t last = result.find_last_not_of('0');
+    if (result[last] == '.') last--;
+    result.erase(last + 1);
+    return result == "-0" ? "0" : result;
+}
+
+static std::string FormatColor(TRenderColor Color) {
+    char buffer[8];
+    snprintf(buffer, sizeof(buffer), "#%02X%02X%02X",
+             Color & 0xFF, (Color >> 8) & 0xFF, (Color >> 16) & 0xFF);
+    return buffer;
+}
+
+// UTF-16 -> UTF-8 с экранированием спецсимволов XML
+static std::string EscapeText(const wchar_t* Text) {
+    std::string result;
+    for (const wchar_t* p = Text; *p; p++) {
+        unsigned long code = static_cast<unsigned long>(*p);
+        if (code >= 0xD800 && code <= 0xDBFF && p[1] >= 0xDC00 && p[1] <= 0xDFFF) {
+            code = 0x10000 + ((code - 0xD800) << 10) + (static_cast<unsigned long>(p[1]) - 0xDC00);
+            p++;
+        }
+
+        switch (code) {
+            case '&': result += "&amp;"; continue;
+            case '<': result += "&lt;"; continue;
+            case '>': result += "&gt;"; continue;
+            case '"': result += "&quot;"; continue;
+        }
+
+        if (code < 0x80) {
+            result += static_cast<char>(code);
+        } else if (code < 0x800) {
+            result += static_cast<char>(0xC0 | (code >> 6));
+            result += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            result += static_cast<char>(0xE0 | (code >> 12));
+            result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            result += static_cast<char>(0xF0 | (code >> 18));
+            result += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+    return result;
+}
+
+TSvgRenderTarget::TSvgRenderTarget() : FPenX(0), FPenY(0) {
+}
+
+std::string TSvgRenderTarget::StrokeAttributes() const {
+    double width = FPenWidth * FZoom;
+    std::string result = " stroke=\"" + FormatColor(FPenColor) + "\" stroke-width=\"" + FormatNumber(width) + "\"";
+    if (FPenStyle == rpsDash) {
+        result += " stroke-dasharray=\"" + FormatNumber(6 * width) + " " + FormatNumber(3 * width) + "\"";
+    } else if (FPenStyle == rpsDot) {
+        result += " stroke-dasharray=\"" + FormatNumber(width) + " " + FormatNumber(2 * width) + "\"";
+    }
+    return result;
+}
+
+std::string TSvgRenderTarget::FillAttribute() const {
+    return FBrushClear ? " fill=\"none\"" : " fill=\"" + FormatColor(FBrushColor) + "\"";
+}
+
+void TSvgRenderTarget::AppendPoints(const TRenderPoint* Points, int Count) {
+    for (int i = 0; i < Count; i++) {
+        if (i > 0) FBody += ' ';
+        FBody += FormatNumber(DeviceX(Points[i].X)) + "," + FormatNumber(DeviceY(Points[i].Y));
+    }
+}
+
+std::string TSvgRenderTarget::GetDocument(int Width, int Height) const {
+    std::string header = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" + std::to_string(Width) +
+        "\" height=\"" + std::to_string(Height) + "\" viewBox=\"0 0 " + std::to_string(Width) + " " +
+        std::to_string(Height) + "\" stroke-linecap=\"square\" font-family=\"Tahoma, sans-serif\">\n";
+    return header + FBody + "</svg>\n";
+}
+
+void TSvgRenderTarget::MoveTo(int X, int Y) {
+    FPenX = X;
+    FPenY = Y;
+}
+
+void TSvgRenderTarget::LineTo(int X, int Y) {
+    FBody += "<line x1=\"" + FormatNumber(DeviceX(FPenX)) + "\" y1=\"" + FormatNumber(DeviceY(FPenY)) +
+             "\" x2=\"" + FormatNumber(DeviceX(X)) + "\" y2=\"" + FormatNumber(DeviceY(Y)) + "\"" +
+             StrokeAttributes() + "/>\n";
+    FPenX = X;
+    FPenY = Y;
+}
+
+void TSvgRenderTarget::Polyline(const TRenderPoint* Points, int Count) {
+    if (Count < 2) return;
+
+    FBody += "<polyline points=\"";
+    AppendPoints(Points, Count);
+    FBody += "\" fill=\"none\"" + StrokeAttributes() + "/>\n";
+}
+
+void TSvgRenderTarget::Rectangle(int Left, int Top, int Right, int Bottom) {
+    // Контур GDI лежит внутри прямоугольника - сдвигаем на полпикселя
+    double inset = 0.5 * FZoom;
+    FBody += "<rect x=\"" + FormatNumber(DeviceX(Left) + inset) + "\" y=\"" + FormatNumber(DeviceY(Top) + inset) +
+             "\" width=\"" + FormatNumber((Right - Left - 1) * FZoom) + "\" height=\"" +
+             FormatNumber((Bottom - Top - 1) * FZoom) + "\"" + FillAttribute() + StrokeAttributes() + "/>\n";
+}
+
+void TSvgRenderTarget::Ellipse(int Left, int Top, int Right, int Bottom) {
+    FBody += "<ellipse cx=\"" + FormatNumber((DeviceX(Left) + DeviceX(Right)) / 2) +
+             "\" cy=\"" + FormatNumber((DeviceY(Top) + DeviceY(Bottom)) / 2) +
+             "\" rx=\"" + FormatNumber((Right - Left) * FZoom / 2) +
+             "\" ry=\"" + FormatNumber((Bottom - Top) * FZoom / 2) + "\"" +
+             FillAttribute() + StrokeAttributes() + "/>\n";
+}
+
+void TSvgRenderTarget::FillRect(int Left, int Top, int Right, int Bottom) {
+    FBody += "<rect x=\"" + FormatNumber(DeviceX(Left)) + "\" y=\"" + FormatNumber(DeviceY(Top)) +
+             "\" width=\"" + FormatNumber((Right - Left) * FZoom) + "\" height=\"" +
+             FormatNumber((Bottom - Top) * FZoom) + "\" fill=\"" + FormatColor(FBrushColor) + "\"/>\n";
+}
+
+void TSvgRenderTarget::TextOut(int X, int Y, const wchar_t* Text) {
+    if (!Text || !*Text) return;
+
+    // Размер шрифта в пунктах при 96 dpi, Y - верхний край строки, как у GDI
+    double size = FFontSize * 96.0 / 72.0 * FZoom;
+    FBody += "<text x=\"" + FormatNumber(DeviceX(X)) + "\" y=\"" + FormatNumber(DeviceY(Y)) +
+             "\" font-size=\"" + FormatNumber(size) + "\" dominant-baseline=\"text-before-edge\" fill=\"" +
+             FormatColor(FFontColor) + "\">" + EscapeText(Text) + "</text>\n";
+}
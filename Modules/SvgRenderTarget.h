@@ -0,0 +1,38 @@
+#ifndef SvgRenderTargetH
+#define SvgRenderTargetH
+
+#include "RenderTarget.h"
+#include <string>
+
+// Переносимый бэкенд: векторный документ SVG, преобразование вида
+// применяется к координатам при записи
+class TSvgRenderTarget : public TRenderTarget {
+private:
+    std::string FBody;
+    int FPenX;
+    int FPenY;
+
+    double DeviceX(int X) const { return X * FZoom - FOffsetX; }
+    double DeviceY(int Y) const { return Y * FZoom - FOffsetY; }
+
+    std::string StrokeAttributes() const;
+    std::string FillAttribute() const;
+    void AppendPoints(const TRenderPoint* Points, int Count);
+
+public:
+    TSvgRenderTarget();
+
+    void Clear() { FBody.clear(); }
+    // Готовый документ с заданным размером области рисования
+    std::string GetDocument(int Width, int Height) const;
+
+    void MoveTo(int X, int Y) override;
+    void LineTo(int X, int Y) override;
+    void Polyline(const TRenderPoint* Points, int Count) override;
+    void Rectangle(int Left, int Top, int Right, int Bottom) override;
+    void Ellipse(int Left, int Top, int Right, int Bottom) override;
+    void FillRect(int Left, int Top, int Right, int Bottom) override;
+    void TextOut(int X, int Y, const wchar_t* Text) override;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#include "TileRenderer.h"
+#include <algorithm>
+#include <mutex>
+
+#pragma package(smart_init)
+
+std::vector<TRenderTile> TTileRenderer::SplitIntoTiles(int X, int Y, int Width, int Height, int TileSize) {
+    std::vector<TRenderTile> tiles;
+    for (int top = 0; top < Height; top += TileSize) {
+        for (int left = 0; left < Width; left += TileSize) {
+            TRenderTile tile;
+            tile.X = X + left;
+            tile.Y = Y + top;
+            tile.Width = std::min(TileSize, Width - left);
+            tile.Height = std::min(TileSize, Height - top);
+            tiles.push_back(tile);
+        }
+    }
+    return tiles;
+}
+
+void TTileRenderer::Render(const std::vector<TRenderTile>& Tiles, const TRenderFunc& RenderFunc,
+                           const TDoneFunc& DoneFunc) {
+    std::mutex mutex;
+
+    // Порция в одну плитку: потоки, попавшие на пустые области, берут следующие
+    FLoop.Run(Tiles.size(), 1, [&](size_t Begin, size_t End) {
+        TRasterRenderTarget target;
+        for (size_t i = Begin; i < End; i++) {
+            const TRenderTile& tile = Tiles[i];
+            target.Resize(tile.Width, tile.Height);
+            RenderFunc(target, tile);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            DoneFunc(target, tile);
+        }
+    });
+}
@@ -0,0 +1,41 @@
+#ifndef TileRendererH
+#define TileRendererH
+
+#include "RasterRenderTarget.h"
+#include "ParallelLoop.h"
+#include <functional>
+#include <vector>
+
+// Плитка изображения в пикселях результата
+struct TRenderTile {
+    int X;
+    int Y;
+    int Width;
+    int Height;
+};
+
+// Параллельная отрисовка плиток в растры в памяти поверх TParallelLoop.
+// Плитки раздаются по одной, каждая порция рисует в свой растр, готовые
+// плитки передаются обработчику по одной
+class TTileRenderer {
+public:
+    typedef std::function<void(TRasterRenderTarget& Target, const TRenderTile& Tile)> TRenderFunc;
+    typedef std::function<void(const TRasterRenderTarget& Target, const TRenderTile& Tile)> TDoneFunc;
+
+private:
+    TParallelLoop FLoop;
+
+public:
+    // 0 - по числу аппаратных потоков
+    explicit TTileRenderer(unsigned ThreadCount = 0) : FLoop(ThreadCount) {}
+
+    unsigned GetThreadCount() const { return FLoop.GetThreadCount(); }
+
+    static std::vector<TRenderTile> SplitIntoTiles(int X, int Y, int Width, int Height, int TileSize);
+
+    // RenderFunc вызывается из рабочих потоков и не должен менять общие данные,
+    // DoneFunc вызывается под блокировкой. Исключение из потока пробрасывается наружу
+    void Render(const std::vector<TRenderTile>& Tiles, const TRenderFunc& RenderFunc, const TDoneFunc& DoneFunc);
+};
+
+#endif
@@ -0,0 +1,536 @@
+#include "WireRouter.h"
+#include <algorithm>
+#include <climits>
+#include <set>
+
+#pragma package(smart_init)
+
+TWireRouter::TWireRouter()
+    : FRectangular(true), FShowBridges(true), FOptionsVersion(1) {
+}
+
+void TWireRouter::SetOptions(bool Rectangular, bool ShowBridges) {
+    if (Rectangular != FRectangular || ShowBridges != FShowBridges) {
+        FRectangular = Rectangular;
+        FShowBridges = ShowBridges;
+        FOptionsVersion++;
+    }
+}
+
+std::vector<TPoint> TWireRouter::CalculatePath(const TPoint& Start, const TPoint& End) const {
+    if (FRectangular) {
+        return CalculateRectangularPath(Start, End);
+    }
+
+    std::vector<TPoint> path;
+    path.push_back(Start);
+    path.push_back(End);
+    return path;
+}
+
+std::vector<TPoint> TWireRouter::CalculateSmartPath(const TPoint& Start, const TPoint& End) const {
+    std::vector<TPoint> path;
+
+    TPoint snappedStart = Start;
+    TPoint snappedEnd = End;
+
+    int gridSize = 20;
+
+    // Простой алгоритм с минимальным количеством изгибов
+    path.push_back(snappedStart);
+
+    // Первый сегмент - горизонтальный
+    int midX1 = snappedStart.X + (snappedEnd.X > snappedStart.X ? gridSize * 2 : -gridSize * 2);
+    path.push_back(TPoint(midX1, snappedStart.Y));
+
+    // Вертикальный сегмент к промежуточной высоте
+    int midY = (snappedStart.Y + snappedEnd.Y) / 2;
+    midY = ((midY + gridSize/2) / gridSize) * gridSize; // Привязка к сетке
+    path.push_back(TPoint(midX1, midY));
+
+    // Горизонтальный сегмент ко второй промежуточной точки
+    int midX2 = snappedEnd.X - (snappedEnd.X > snappedStart.X ? gridSize * 2 : -gridSize * 2);
+    path.push_back(TPoint(midX2, midY));
+
+    // Вертикальный сегмент к конечной высоте
+    path.push_back(TPoint(midX2, snappedEnd.Y));
+
+    // Финальный горизонтальный сегмент
+    path.push_back(snappedEnd);
+
+    return path;
+}
+
+std::vector<TPoint> TWireRouter::CalculateRectangularPath(const TPoint& Start, const TPoint& End) const {
+    if (FShowBridges) {
+        // Используем улучшенный алгоритм с мостиками
+        return CalculateSmartPath(Start, End);
+    } else {
+        // Используем простой алгоритм без мостиков
+        std::vector<TPoint> path;
+        path.push_back(Start);
+
+        int firstX = Start.X + (End.X > Start.X ? 40 : -40);
+        path.push_back(TPoint(firstX, Start.Y));
+        path.push_back(TPoint(firstX, End.Y));
+        path.push_back(End);
+
+        return path;
+    }
+}
+
+std::vector<TPoint> TWireRouter::ApplyBridges(const TWireRoute& Route, int BridgeSize) const {
+    if (Route.Bridges.empty()) {
+        return Route.Path;
+    }
+
+    // Мостики упорядочены по сегментам и вдоль направления сегмента
+    std::vector<TWireBridge> bridges = Route.Bridges;
+    const std::vector<TWireSegment>& segments = Route.Segments;
+    std::sort(bridges.begin(), bridges.end(), [&segments](const TWireBridge& a, const TWireBridge& b) {
+        if (a.Segment != b.Segment) return a.Segment < b.Segment;
+        const TWireSegment& segment = segments[a.Segment];
+        return segment.End.X >= segment.Start.X ? a.Point.X < b.Point.X : a.Point.X > b.Point.X;
+    });
+
+    std::vector<TPoint> path;
+    path.reserve(Route.Path.size() + bridges.size() * 4);
+
+    int half = BridgeSize / 2;
+    size_t b = 0;
+    for (size_t i = 0; i < Route.Path.size(); i++) {
+        path.push_back(Route.Path[i]);
+        if (i >= segments.size()) break;
+
+        const TWireSegment& segment = segments[i];
+        int dir = segment.End.X >= segment.Start.X ? 1 : -1;
+        int lastX = segment.Start.X;
+
+        for (; b < bridges.size() && bridges[b].Segment == (int)i; b++) {
+            int x = bridges[b].Point.X;
+            int y = bridges[b].Point.Y;
+            int enterX = x - dir * half;
+            int leaveX = x + dir * half;
+
+            // Мостик не должен налезать на соседний или выходить за концы сегмента
+            if ((enterX - lastX) * dir < 0 || (segment.End.X - leaveX) * dir < 0) continue;
+
+            path.push_back(TPoint(enterX, y));
+            path.push_back(TPoint(enterX, y - BridgeSize));
+            path.push_back(TPoint(leaveX, y - BridgeSize));
+            path.push_back(TPoint(leaveX, y));
+            lastX = leaveX;
+        }
+    }
+
+    return path;
+}
+
+TWireRouteCache::TWireRouteCache()
+    : FOptionsVersion(0), FVersion(0), FFrameActive(false), FFrameUnbounded(false), FPendingCount(0),
+      FHasBridges(false), FCrossingsEnabled(false) {
+}
+
+void TWireRouteCache::ForgetRoute(const TWireKey& Key) {
+    if (!FHasBridges) return;
+
+    auto it = FRoutes.find(Key);
+    if (it != FRoutes.end()) DetachBridges(Key, it->second);
+}
+
+// Снимает мостики маршрута и мостики других маршрутов через него - работа
+// пропорциональна числу его пересечений, а не всем маршрутам вкладки
+void TWireRouteCache::DetachBridges(const TWireKey& Key, TWireRoute& Route) {
+    for (const TWireKey& holderKey : Route.BridgeHolders) {
+        auto holder = FRoutes.find(holderKey);
+        if (holder == FRoutes.end()) continue;
+
+        std::vector<TWireBridge>& bridges = holder->second.Bridges;
+        bridges.erase(std::remove_if(bridges.begin(), bridges.end(),
+            [&Key](const TWireBridge& bridge) { return bridge.Partner == Key; }), bridges.end());
+    }
+    Route.BridgeHolders.clear();
+
+    for (const TWireBridge& bridge : Route.Bridges) {
+        auto partner = FRoutes.find(bridge.Partner);
+        if (partner == FRoutes.end()) continue;
+
+        std::vector<TWireKey>& holders = partner->second.BridgeHolders;
+        holders.erase(std::remove(holders.begin(), holders.end(), Key), holders.end());
+    }
+    Route.Bridges.clear();
+}
+
+void TWireRouteCache::CheckOptions(const TWireRouter& Router) {
+    if (FOptionsVersion != Router.GetOptionsVersion()) {
+        Clear();
+        FOptionsVersion = Router.GetOptionsVersion();
+    }
+}
+
+bool TWireRouteCache::HasRouteBudget() const {
+    return FFrameActive && (FFrameUnbounded || TClock::now() < FDeadline);
+}
+
+void TWireRouteCache::MarkPending(const std::vector<TRect>& Changed) {
+    // При массовых изменениях (загрузка, вставка) проще перепроложить все
+    const size_t maxChanged = 64;
+    bool all = Changed.size() > maxChanged;
+
+    for (auto& entry : FRoutes) {
+        TWireRoute& route = entry.second;
+        if (route.Pending) continue;
+
+        for (size_t i = 0; !all && i < Changed.size(); i++) {
+            const TRect& rect = Changed[i];
+            int margin = TGridRouter::GridSize;
+            if (route.Bounds.Left <= rect.Right + margin && route.Bounds.Right >= rect.Left - margin &&
+                route.Bounds.Top <= rect.Bottom + margin && route.Bounds.Bottom >= rect.Top - margin) {
+                route.Pending = true;
+                break;
+            }
+        }
+        if (all) route.Pending = true;
+    }
+}
+
+void TWireRouteCache::BeginFrame(const TWireRouter& Router,
+                                 const std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                                 unsigned BudgetMs) {
+    CheckOptions(Router);
+
+    FFrameActive = true;
+    FFrameUnbounded = (BudgetMs == 0);
+    FDeadline = TClock::now() + std::chrono::milliseconds(BudgetMs);
+    FPendingCount = 0;
+
+    // Прямые соединения элементы не обходят
+    if (!Router.IsRectangular()) return;
+
+    // Сверяем корпуса с прошлым кадром - O(N), сетка пересобирается только при изменениях
+    std::vector<TRect> changed;
+    size_t seen = 0;
+    for (const auto& element : Elements) {
+        TRect bounds = element->Bounds;
+        auto it = FObstacleBounds.find(element.get());
+        if (it == FObstacleBounds.end()) {
+            changed.push_back(bounds);
+        } else {
+            seen++;
+            if (!(it->second == bounds)) {
+                changed.push_back(it->second);
+                changed.push_back(bounds);
+            }
+        }
+    }
+
+    // Удаленные элементы освобождают занятое место
+    bool removed = seen != FObstacleBounds.size();
+    if (changed.empty() && !removed) return;
+
+    std::unordered_map<const TCircuitElement*, TRect> snapshot;
+    snapshot.reserve(Elements.size());
+    std::vector<TRect> obstacles;
+    obstacles.reserve(Elements.size());
+    for (const auto& element : Elements) {
+        snapshot[element.get()] = element->Bounds;
+        obstacles.push_back(element->Bounds);
+    }
+    if (removed) {
+        for (const auto& entry : FObstacleBounds) {
+            if (snapshot.find(entry.first) == snapshot.end()) changed.push_back(entry.second);
+        }
+    }
+
+    FObstacleBounds.swap(snapshot);
+    FGrid.SetObstacles(obstacles);
+    MarkPending(changed);
+}
+
+void TWireRouteCache::EndFrame() {
+    FFrameActive = false;
+}
+
+void TWireRouteCache::BuildRoute(const TWireRouter& Router, const TConnectionPoint* From,
+                                 const TConnectionPoint* To, TWireRoute& Route, bool Precise) {
+    Route.FromOwner = From->Owner;
+    Route.ToOwner = To->Owner;
+    Route.From = TPoint(From->X, From->Y);
+    Route.To = TPoint(To->X, To->Y);
+    Route.Path.clear();
+    Route.Pending = false;
+
+    if (Router.IsRectangular()) {
+        if (!Precise) {
+            // Бюджет кадра исчерпан - временный маршрут без обхода
+            Route.Pending = true;
+        } else {
+            TRect fromBody = From->Owner ? From->Owner->Bounds : TRect(0, 0, 0, 0);
+            TRect toBody = To->Owner ? To->Owner->Bounds : TRect(0, 0, 0, 0);
+            if (!FGrid.FindPath(Route.From, fromBody, Route.To, toBody, Route.Path)) {
+                Route.Path.clear();
+            }
+        }
+    }
+    if (Route.Path.empty()) {
+        Route.Path = Router.CalculatePath(Route.From, Route.To);
+    }
+
+    Route.Segments.clear();
+    Route.Segments.reserve(Route.Path.size());
+    Route.Bounds = TRect(Route.From.X, Route.From.Y, Route.From.X, Route.From.Y);
+
+    for (size_t i = 0; i < Route.Path.size(); i++) {
+        const TPoint& point = Route.Path[i];
+        Route.Bounds.Left = std::min(Route.Bounds.Left, point.X);
+        Route.Bounds.Top = std::min(Route.Bounds.Top, point.Y);
+        Route.Bounds.Right = std::max(Route.Bounds.Right, point.X);
+        Route.Bounds.Bottom = std::max(Route.Bounds.Bottom, point.Y);
+
+        if (i + 1 < Route.Path.size()) {
+            TWireSegment segment;
+            segment.Start = point;
+            segment.End = Route.Path[i + 1];
+            segment.IsHorizontal = (point.Y == segment.End.Y);
+            Route.Segments.push_back(segment);
+        }
+    }
+
+    // Следующие провода стараются не идти поверх этого и реже его пересекать
+    FGrid.AddWire(Route.Path);
+    Route.Version = ++FVersion;
+}
+
+const TWireRoute& TWireRouteCache::GetRoute(const TWireRouter& Router, const TConnectionPoint* From,
+                                            const TConnectionPoint* To) {
+    CheckOptions(Router);
+
+    TWireKey key(From, To);
+    TWireRoute* route;
+    auto it = FRoutes.find(key);
+    if (it != FRoutes.end()) {
+        route = &it->second;
+        // Концы на прежних местах - маршрут актуален или ждет своей очереди
+        if (route->From.X == From->X && route->From.Y == From->Y &&
+            route->To.X == To->X && route->To.Y == To->Y) {
+            if (!route->Pending) return *route;
+            if (!HasRouteBudget()) {
+                FPendingCount++;
+                return *route;
+            }
+        }
+        FGrid.RemoveWire(route->Path);
+        if (FHasBridges) DetachBridges(key, *route);
+    } else {
+        route = &FRoutes[key];
+    }
+
+    BuildRoute(Router, From, To, *route, !FFrameActive || HasRouteBudget());
+    if (route->Pending) FPendingCount++;
+    if (!route->CrossingsDirty) {
+        route->CrossingsDirty = true;
+        FDirtyCrossings.push_back(key);
+    }
+    return *route;
+}
+
+const TWireRoute* TWireRouteCache::FindRoute(const TConnectionPoint* From, const TConnectionPoint* To) const {
+    auto it = FRoutes.find(TWireKey(From, To));
+    return it != FRoutes.end() ? &it->second : nullptr;
+}
+
+void TWireRouteCache::InvalidateElement(const TCircuitElement* Element) {
+    for (auto it = FRoutes.begin(); it != FRoutes.end(); ) {
+        if (it->second.FromOwner == Element || it->second.ToOwner == Element) {
+            ForgetRoute(it->first);
+            FGrid.RemoveWire(it->second.Path);
+            it = FRoutes.erase(it);
+            FVersion++;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TWireRouteCache::Prune(const std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections) {
+    // Удаляем маршруты соединений, которых больше нет (в т.ч. удаленных элементов)
+    std::unordered_set<TWireKey, TWireKeyHash> alive;
+    alive.reserve(Connections.size());
+    for (const auto& connection : Connections) {
+        alive.insert(TWireKey(connection.first, connection.second));
+    }
+
+    for (auto it = FRoutes.begin(); it != FRoutes.end(); ) {
+        if (alive.find(it->first) == alive.end()) {
+            ForgetRoute(it->first);
+            FGrid.RemoveWire(it->second.Path);
+            it = FRoutes.erase(it);
+            FVersion++;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TWireRouteCache::Clear() {
+    FRoutes.clear();
+    FVersion++;
+    FGrid.ClearWires();
+    // Препятствия будут заново сверены в следующем кадре
+    FObstacleBounds.clear();
+    FDirtyCrossings.clear();
+    FHasBridges = false;
+}
+
+void TWireRouteCache::UpdateCrossings(bool Enabled) {
+    if (!Enabled) {
+        if (FCrossingsEnabled) {
+            // При повторном включении все пересечения считаются заново
+            FDirtyCrossings.clear();
+            for (auto& entry : FRoutes) {
+                entry.second.Bridges.clear();
+                entry.second.BridgeHolders.clear();
+                entry.second.CrossingsDirty = true;
+                FDirtyCrossings.push_back(entry.first);
+            }
+            FCrossingsEnabled = false;
+        }
+        FHasBridges = false;
+        return;
+    }
+
+    FCrossingsEnabled = true;
+
+    if (FDirtyCrossings.empty()) return;
+
+    // Мостики измененных маршрутов сняты при их перестроении, удаленных - в ForgetRoute.
+    // Ключ мог попасть в список повторно или принадлежать уже удаленному маршруту
+    std::sort(FDirtyCrossings.begin(), FDirtyCrossings.end());
+    FDirtyCrossings.erase(std::unique(FDirtyCrossings.begin(), FDirtyCrossings.end()), FDirtyCrossings.end());
+
+    struct TSweepSegment {
+        TWireRoute* Route;
+        const TWireKey* Key;
+        int Index;
+    };
+
+    std::vector<TSweepSegment> sweepRoutes;
+    std::vector<TRect> dirtyBounds;
+    TRect area;
+
+    for (const TWireKey& key : FDirtyCrossings) {
+        auto it = FRoutes.find(key);
+        if (it == FRoutes.end() || !it->second.CrossingsDirty) continue;
+
+        const TRect& bounds = it->second.Bounds;
+        if (dirtyBounds.empty()) {
+            area = bounds;
+        } else {
+            area.Left = std::min(area.Left, bounds.Left);
+            area.Top = std::min(area.Top, bounds.Top);
+            area.Right = std::max(area.Right, bounds.Right);
+            area.Bottom = std::max(area.Bottom, bounds.Bottom);
+        }
+        dirtyBounds.push_back(bounds);
+        TSweepSegment item = { &it->second, &it->first, 0 };
+        sweepRoutes.push_back(item);
+    }
+    FDirtyCrossings.clear();
+    if (sweepRoutes.empty()) return;
+
+    // Неизмененные маршруты нужны только те, что задевают границы измененных
+    auto overlaps = [](const TRect& A, const TRect& B) {
+        return A.Left <= B.Right && A.Right >= B.Left && A.Top <= B.Bottom && A.Bottom >= B.Top;
+    };
+    const size_t maxExactBounds = 64;
+    bool exact = dirtyBounds.size() <= maxExactBounds;
+
+    for (auto& entry : FRoutes) {
+        TWireRoute& route = entry.second;
+        if (route.CrossingsDirty || !overlaps(route.Bounds, area)) continue;
+
+        bool near = !exact;
+        for (size_t i = 0; !near && i < dirtyBounds.size(); i++) {
+            near = overlaps(route.Bounds, dirtyBounds[i]);
+        }
+        if (near) {
+            TSweepSegment item = { &route, &entry.first, 0 };
+            sweepRoutes.push_back(item);
+        }
+    }
+
+    // Горизонтальные сегменты - события входа/выхода по X, вертикальные - запросы
+    // к упорядоченному по Y множеству активных горизонталей
+    struct TSweepEvent {
+        int X;
+        int Kind; // 0 - выход горизонтали, 1 - вертикаль, 2 - вход горизонтали
+        int Segment;
+        bool operator<(const TSweepEvent& Other) const {
+            return X != Other.X ? X < Other.X : Kind < Other.Kind;
+        }
+    };
+
+    std::vector<TSweepSegment> sweepSegments;
+    std::vector<TSweepEvent> events;
+
+    for (const TSweepSegment& source : sweepRoutes) {
+        TWireRoute& route = *source.Route;
+        for (size_t i = 0; i < route.Segments.size(); i++) {
+            const TWireSegment& segment = route.Segments[i];
+            int id = (int)sweepSegments.size();
+
+            if (segment.Start.Y == segment.End.Y && segment.Start.X != segment.End.X) {
+                TSweepSegment item = { &route, source.Key, (int)i };
+                sweepSegments.push_back(item);
+                TSweepEvent enter = { std::min(segment.Start.X, segment.End.X), 2, id };
+                TSweepEvent leave = { std::max(segment.Start.X, segment.End.X), 0, id };
+                events.push_back(enter);
+                events.push_back(leave);
+            } else if (segment.Start.X == segment.End.X && segment.Start.Y != segment.End.Y) {
+                TSweepSegment item = { &route, source.Key, (int)i };
+                sweepSegments.push_back(item);
+                TSweepEvent query = { segment.Start.X, 1, id };
+                events.push_back(query);
+            }
+            // Наклонные сегменты (прямые соединения) мостиков не получают
+        }
+    }
+
+    std::sort(events.begin(), events.end());
+
+    // Выход раньше запроса, вход позже - касание концами не считается пересечением
+    std::set<std::pair<int, int>> active;
+    for (const TSweepEvent& event : events) {
+        const TSweepSegment& item = sweepSegments[event.Segment];
+        const TWireSegment& segment = item.Route->Segments[item.Index];
+
+        if (event.Kind == 2) {
+            active.insert(std::make_pair(segment.Start.Y, event.Segment));
+        } else if (event.Kind == 0) {
+            active.erase(std::make_pair(segment.Start.Y, event.Segment));
+        } else {
+            int top = std::min(segment.Start.Y, segment.End.Y);
+            int bottom = std::max(segment.Start.Y, segment.End.Y);
+            auto from = active.upper_bound(std::make_pair(top, INT_MAX));
+            auto to = active.lower_bound(std::make_pair(bottom, INT_MIN));
+
+            for (auto it = from; it != to; ++it) {
+                const TSweepSegment& horizontal = sweepSegments[it->second];
+                if (horizontal.Route == item.Route) continue;
+                if (!horizontal.Route->CrossingsDirty && !item.Route->CrossingsDirty) continue;
+
+                TWireBridge bridge;
+                bridge.Segment = horizontal.Index;
+                bridge.Point = TPoint(event.X, it->first);
+                bridge.Partner = *item.Key;
+                horizontal.Route->Bridges.push_back(bridge);
+                item.Route->BridgeHolders.push_back(*horizontal.Key);
+                FHasBridges = true;
+            }
+        }
+    }
+
+    for (const TSweepSegment& source : sweepRoutes) {
+        source.Route->CrossingsDirty = false;
+    }
+}
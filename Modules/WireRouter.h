@@ -0,0 +1,139 @@
+#ifndef WireRouterH
+#define WireRouterH
+
+#include "CircuitElement.h"
+#include "GridRouter.h"
+#include <System.Types.hpp>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+// Прямолинейный отрезок маршрута
+struct TWireSegment {
+    TPoint Start;
+    TPoint End;
+    bool IsHorizontal;
+};
+
+// Соединение однозначно задается парой своих точек
+typedef std::pair<const TConnectionPoint*, const TConnectionPoint*> TWireKey;
+
+struct TWireKeyHash {
+    size_t operator()(const TWireKey& Key) const {
+        return std::hash<const void*>()(Key.first) * 31 + std::hash<const void*>()(Key.second);
+    }
+};
+
+// Мостик: горизонтальный сегмент маршрута перепрыгивает вертикальный сегмент другого соединения
+struct TWireBridge {
+    int Segment;
+    TPoint Point;
+    TWireKey Partner;
+};
+
+// Рассчитанный маршрут соединения в логических координатах
+struct TWireRoute {
+    const TCircuitElement* FromOwner;
+    const TCircuitElement* ToOwner;
+    TPoint From;
+    TPoint To;
+    std::vector<TPoint> Path;
+    std::vector<TWireSegment> Segments;
+    TRect Bounds;
+    // Пересечения пересчитываются только для измененных маршрутов
+    std::vector<TWireBridge> Bridges;
+    // Маршруты, у которых есть мостики через этот - их снимают при его изменении
+    std::vector<TWireKey> BridgeHolders;
+    bool CrossingsDirty;
+    // Проложен упрощенно, обход элементов будет рассчитан в следующих кадрах
+    bool Pending;
+    // Номер перестроения: потребители замечают изменения, не сравнивая ломаные
+    unsigned Version;
+};
+
+// Построение маршрутов по текущим настройкам трассировки
+class TWireRouter {
+private:
+    bool FRectangular;
+    bool FShowBridges;
+    unsigned FOptionsVersion;
+
+public:
+    TWireRouter();
+
+    // Смена настроек делает недействительными все кэшированные маршруты
+    void SetOptions(bool Rectangular, bool ShowBridges);
+    unsigned GetOptionsVersion() const { return FOptionsVersion; }
+    bool IsRectangular() const { return FRectangular; }
+
+    std::vector<TPoint> CalculatePath(const TPoint& Start, const TPoint& End) const;
+    std::vector<TPoint> CalculateSmartPath(const TPoint& Start, const TPoint& End) const;
+    std::vector<TPoint> CalculateRectangularPath(const TPoint& Start, const TPoint& End) const;
+
+    // Ломаная с мостиками, построенная за один проход по маршруту
+    std::vector<TPoint> ApplyBridges(const TWireRoute& Route, int BridgeSize) const;
+};
+
+// Кэш маршрутов вкладки. Маршрут пересчитывается при смещении концов
+// соединения, смене настроек трассировки или перемещении элементов рядом с ним
+class TWireRouteCache {
+private:
+    typedef std::chrono::steady_clock TClock;
+
+    std::unordered_map<TWireKey, TWireRoute, TWireKeyHash> FRoutes;
+    unsigned FOptionsVersion;
+    // Растет при каждом перестроении или удалении маршрута
+    unsigned FVersion;
+
+    // Препятствия и занятость сетки для прямоугольной трассировки
+    TGridRouter FGrid;
+    std::unordered_map<const TCircuitElement*, TRect> FObstacleBounds;
+
+    // Бюджет времени кадра на трассировку в обход элементов
+    bool FFrameActive;
+    bool FFrameUnbounded;
+    TClock::time_point FDeadline;
+    unsigned FPendingCount;
+
+    // Маршруты, пересечения которых надо найти заново (возможны повторы)
+    std::vector<TWireKey> FDirtyCrossings;
+    bool FHasBridges;
+    bool FCrossingsEnabled;
+
+    void ForgetRoute(const TWireKey& Key);
+    void DetachBridges(const TWireKey& Key, TWireRoute& Route);
+    void CheckOptions(const TWireRouter& Router);
+    bool HasRouteBudget() const;
+    void MarkPending(const std::vector<TRect>& Changed);
+
+    void BuildRoute(const TWireRouter& Router, const TConnectionPoint* From,
+                    const TConnectionPoint* To, TWireRoute& Route, bool Precise);
+
+public:
+    TWireRouteCache();
+
+    // Кадр сверяет корпуса элементов с прошлым и ограничивает время трассировки.
+    // BudgetMs = 0 - без ограничения (экспорт). Вне кадра новые маршруты строятся
+    // полностью, а отложенные ждут следующего кадра
+    void BeginFrame(const TWireRouter& Router, const std::vector<std::unique_ptr<TCircuitElement>>& Elements,
+                    unsigned BudgetMs);
+    void EndFrame();
+    bool HasPendingRoutes() const { return FPendingCount > 0; }
+
+    const TWireRoute& GetRoute(const TWireRouter& Router, const TConnectionPoint* From, const TConnectionPoint* To);
+    // Уже рассчитанный маршрут без трассировки, nullptr - маршрута еще нет
+    const TWireRoute* FindRoute(const TConnectionPoint* From, const TConnectionPoint* To) const;
+    unsigned GetVersion() const { return FVersion; }
+
+    void InvalidateElement(const TCircuitElement* Element);
+    void Prune(const std::vector<std::pair<TConnectionPoint*, TConnectionPoint*>>& Connections);
+    void Clear();
+
+    // Поиск пересечений заметающей прямой только для измененных маршрутов:
+    // их сегменты сверяются с сегментами прочих маршрутов в пределах их границ
+    void UpdateCrossings(bool Enabled);
+};
+
+#endif
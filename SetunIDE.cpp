@@ -1,34 +1,75 @@
-#include <vcl.h>
-#pragma hdrstop
-#include <tchar.h>
-//---------------------------------------------------------------------------
-USEFORM("MainForm.cpp", MainForm);
-//---------------------------------------------------------------------------
-int WINAPI _tWinMain(HINSTANCE, HINSTANCE, LPTSTR, int)
-{
-	try
-	{
-		Application->Initialize();
-		Application->MainFormOnTaskBar = true;
-		Application->Title = "Setun IDE)";
-		Application->CreateForm(__classid(TMainForm), &MainForm);
-		Application->Run();
-	}
-	catch (Exception &exception)
-	{
-		Application->ShowException(&exception);
-	}
-	catch (...)
-	{
-		try
-		{
-			throw Exception("");
-		}
-		catch (Exception &exception)
-		{
-			Application->ShowException(&exception);
-		}
-	}
-	return 0;
-}
-//---------------------------------------------------------------------------
+#include <vcl.h>
+#pragma hdrstop
+#include <tchar.h>
+#include "Modules/SerializationManager.h"
+//---------------------------------------------------------------------------
+USEFORM("MainForm.cpp", MainForm);
+//---------------------------------------------------------------------------
+int WINAPI _tWinMain(HINSTANCE, HINSTANCE, LPTSTR, int)
+{
+	// Загрузка, экспорт и журнал работают в потоках std::thread, о которых RTL
+	// не знает; строки и менеджер памяти берут блокировки только при этом флаге
+	IsMultiThread = true;
+
+	// Преобразование схемы без окна: SetunIDE /convert <файл> <результат>,
+	// формат результата - по расширению (.setun, .ini, .net)
+	if (ParamCount() == 3 && SameText(ParamStr(1), "/convert"))
+	{
+		try
+		{
+			TSerializationManager(nullptr).ConvertSchemeFile(ParamStr(2), ParamStr(3));
+			return 0;
+		}
+		catch (Exception &exception)
+		{
+			return 1;
+		}
+	}
+
+	// Сравнение двух версий схемы: SetunIDE /diff <старая> <новая> <отчет> [/state].
+	// С /state учитываются и состояния элементов.
+	// Код возврата: 0 - схемы совпадают, 1 - есть отличия, 2 - ошибка
+	if ((ParamCount() == 4 || (ParamCount() == 5 && SameText(ParamStr(5), "/state"))) &&
+		SameText(ParamStr(1), "/diff"))
+	{
+		try
+		{
+			TSerializationManager manager(nullptr);
+			TSchemeDiff diff;
+			diff.SetCompareState(ParamCount() == 5);
+			manager.CompareSchemeFiles(ParamStr(2), ParamStr(3), diff);
+			manager.SaveDiffReport(ParamStr(4), diff);
+			return diff.IsEmpty() ? 0 : 1;
+		}
+		catch (Exception &exception)
+		{
+			return 2;
+		}
+	}
+
+	try
+	{
+		Application->Initialize();
+		Application->MainFormOnTaskBar = true;
+		Application->Title = "Setun IDE)";
+		Application->CreateForm(__classid(TMainForm), &MainForm);
+		Application->Run();
+	}
+	catch (Exception &exception)
+	{
+		Application->ShowException(&exception);
+	}
+	catch (...)
+	{
+		try
+		{
+			throw Exception("");
+		}
+		catch (Exception &exception)
+		{
+			Application->ShowException(&exception);
+		}
+	}
+	return 0;
+}
+//---------------------------------------------------------------------------
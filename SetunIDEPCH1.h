@@ -1,3 +1,3 @@
-#include <vcl.h>
-#include <tchar.h>
-
+#include <vcl.h>
+#include <tchar.h>
+
@@ -1,8 +1,8 @@
-#ifndef StandardLibraryH
-#define StandardLibraryH
-
-#include "ComponentLibrary.h"
-
-void RegisterStandardLibrary();
-
-#endif
+#ifndef StandardLibraryH
+#define StandardLibraryH
+
+#include "ComponentLibrary.h"
+
+void RegisterStandardLibrary();
+
+#endif
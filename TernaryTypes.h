@@ -1,38 +1,38 @@
-#ifndef TernaryTypesH
-#define TernaryTypesH
-
-#include <System.Types.hpp>
-#include <vector>
-#include <map>
-#include <System.Classes.hpp>
-
-class TCircuitElement;
-
-// �������� ��������
-enum class TTernary { NEG = -1, ZERO = 0, POS = 1 };
-
-// ����� ����� ����������
-enum class TLineStyle {
-    POSITIVE_CONTROL,
-    NEGATIVE_CONTROL,
-    OUTPUT_LINE,
-    INTERNAL_CONNECTION
-};
-
-// ����� ����������
-struct TConnectionPoint {
-    TCircuitElement* Owner;
-    int X, Y;
-    TTernary Value;
-    bool IsInput;
-    TLineStyle LineStyle;
-    double RelX, RelY;
-
-    TConnectionPoint(TCircuitElement* owner, int x, int y, TTernary val, bool isInput, TLineStyle style)
-        : Owner(owner), X(x), Y(y), Value(val), IsInput(isInput), LineStyle(style), RelX(0), RelY(0) {}
-
-    TConnectionPoint(int x, int y, TTernary val, bool isInput, TLineStyle style)
-        : Owner(nullptr), X(x), Y(y), Value(val), IsInput(isInput), LineStyle(style), RelX(0), RelY(0) {}
-};
-
-#endif
+#ifndef TernaryTypesH
+#define TernaryTypesH
+
+#include <System.Types.hpp>
+#include <vector>
+#include <map>
+#include <System.Classes.hpp>
+
+class TCircuitElement;
+
+// �������� ��������
+enum class TTernary { NEG = -1, ZERO = 0, POS = 1 };
+
+// ����� ����� ����������
+enum class TLineStyle {
+    POSITIVE_CONTROL,
+    NEGATIVE_CONTROL,
+    OUTPUT_LINE,
+    INTERNAL_CONNECTION
+};
+
+// ����� ����������
+struct TConnectionPoint {
+    TCircuitElement* Owner;
+    int X, Y;
+    TTernary Value;
+    bool IsInput;
+    TLineStyle LineStyle;
+    double RelX, RelY;
+
+    TConnectionPoint(TCircuitElement* owner, int x, int y, TTernary val, bool isInput, TLineStyle style)
+        : Owner(owner), X(x), Y(y), Value(val), IsInput(isInput), LineStyle(style), RelX(0), RelY(0) {}
+
+    TConnectionPoint(int x, int y, TTernary val, bool isInput, TLineStyle style)
+        : Owner(nullptr), X(x), Y(y), Value(val), IsInput(isInput), LineStyle(style), RelX(0), RelY(0) {}
+};
+
+#endif